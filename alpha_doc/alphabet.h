@@ -0,0 +1,142 @@
+#pragma once
+#include <cstddef>
+
+/**
+ * @file
+ * @author Ганьшин В.А.
+ * @version 1.0
+ * @date 17.12.2025
+ * @brief Алфавиты для шифра Гронсфельда
+ * @details Таблицы "символ-номер" и "номер-символ" строятся на этапе компиляции (constexpr),
+ * поэтому объекты шифра не тратят время и память на построение алфавита.
+ */
+
+/// Количество кодов символов, охватываемых плоской таблицей (символы до U+07FF)
+constexpr std::size_t alphabetCodeRange = 0x800;
+
+/// Максимальное количество символов в алфавите
+constexpr std::size_t alphabetMaxSize = 256;
+
+/**
+ * @brief Таблицы алфавита
+ * @details Строится функцией makeAlphabet() на этапе компиляции
+ */
+struct AlphabetTable {
+    int size = 0; ///< Мощность алфавита (модуль сдвига)
+    wchar_t symbols[alphabetMaxSize] = {}; ///< Таблица "номер-символ" (прописные буквы)
+    short index[alphabetCodeRange] = {}; ///< Таблица "код символа - номер" (-1 для символов вне алфавита)
+    int minUtf8Length = 0; ///< Наименьшая длина буквы алфавита в UTF-8 (байт)
+    int maxUtf8Length = 0; ///< Наибольшая длина буквы алфавита в UTF-8 (байт)
+};
+
+/**
+ * @brief Строчная пара прописной буквы
+ * @param c Прописная буква
+ * @return Строчная буква или сам символ, если пары нет
+ * @details Поддерживаются латиница, Latin-1, греческий алфавит и кириллица
+ */
+constexpr wchar_t alphabetLower(wchar_t c)
+{
+    if ((c >= L'A' && c <= L'Z') ||
+        (c >= 0xC0 && c <= 0xDE && c != 0xD7) ||
+        (c >= 0x391 && c <= 0x3AB && c != 0x3A2) ||
+        (c >= 0x410 && c <= 0x42F)) {
+        return static_cast<wchar_t>(c + 0x20);
+    }
+    if (c >= 0x400 && c <= 0x40F) {
+        return static_cast<wchar_t>(c + 0x50);
+    }
+    return c;
+}
+
+/**
+ * @brief Построение таблиц алфавита на этапе компиляции
+ * @param letters Прописные буквы алфавита по порядку
+ * @return Таблицы алфавита
+ * @details Буквы должны быть различными, с кодами до U+07FF, не более 256 штук.
+ * Нарушение этих условий в constexpr-контексте приводит к ошибке компиляции.
+ * Шифр и анализатор хранят ссылку на таблицы, поэтому таблицы объявляются
+ * переменной со статическим временем жизни; временный результат makeAlphabet()
+ * передать шифру нельзя (соответствующие конструкторы удалены).
+ *
+ * Пример пользовательского алфавита:
+ * @code
+ * inline constexpr AlphabetTable digitsAlphabet = makeAlphabet(L"0123456789");
+ * modAlphaCipher cipher(L"314", digitsAlphabet);
+ * @endcode
+ */
+template <std::size_t N>
+constexpr AlphabetTable makeAlphabet(const wchar_t (&letters)[N])
+{
+    static_assert(N - 1 <= alphabetMaxSize, "Алфавит не может содержать больше 256 символов");
+    AlphabetTable table{};
+    table.minUtf8Length = 2;
+    table.maxUtf8Length = 1;
+    for (std::size_t c = 0; c < alphabetCodeRange; c++) {
+        table.index[c] = -1;
+    }
+    for (std::size_t i = 0; i + 1 < N; i++) {
+        wchar_t upper = letters[i];
+        wchar_t lower = alphabetLower(upper);
+        if (static_cast<std::size_t>(upper) >= alphabetCodeRange || table.index[upper] != -1) {
+            throw "Недопустимый или повторяющийся символ алфавита";
+        }
+        table.symbols[i] = upper;
+        table.index[upper] = static_cast<short>(i);
+        table.index[lower] = static_cast<short>(i);
+        // Строчная и прописная формы имеют одинаковую длину в UTF-8
+        int width = (upper < 0x80) ? 1 : 2;
+        table.minUtf8Length = (width < table.minUtf8Length) ? width : table.minUtf8Length;
+        table.maxUtf8Length = (width > table.maxUtf8Length) ? width : table.maxUtf8Length;
+    }
+    table.size = static_cast<int>(N - 1);
+    return table;
+}
+
+/// Русский алфавит (33 буквы)
+inline constexpr AlphabetTable russianAlphabet = makeAlphabet(L"АБВГДЕЁЖЗИЙКЛМНОПРСТУФХЦЧШЩЪЫЬЭЮЯ");
+
+/// Русский алфавит без буквы Ё (32 буквы)
+inline constexpr AlphabetTable russianAlphabetNoYo = makeAlphabet(L"АБВГДЕЖЗИЙКЛМНОПРСТУФХЦЧШЩЪЫЬЭЮЯ");
+
+/// Латинский алфавит (26 букв)
+inline constexpr AlphabetTable latinAlphabet = makeAlphabet(L"ABCDEFGHIJKLMNOPQRSTUVWXYZ");
+
+/**
+ * @brief Таблица букв всех алфавитов среди символов до U+07FF
+ * @details Соответствует классу alpha локалей UTF-8 библиотеки glibc,
+ * но не зависит от установленной локали и не требует вызова std::iswalpha
+ * для каждого символа
+ */
+struct LetterTable {
+    bool letter[alphabetCodeRange] = {}; ///< true для буквы любого алфавита
+};
+
+/**
+ * @brief Построение таблицы букв на этапе компиляции
+ * @return Таблица букв
+ */
+constexpr LetterTable makeLetterTable()
+{
+    // Диапазоны кодов букв (включительно)
+    constexpr unsigned short ranges[][2] = {
+        {0x41, 0x5A}, {0x61, 0x7A}, {0xAA, 0xAA}, {0xB5, 0xB5}, {0xBA, 0xBA}, {0xC0, 0xD6},
+        {0xD8, 0xF6}, {0xF8, 0x2C1}, {0x2C6, 0x2D1}, {0x2E0, 0x2E4}, {0x2EC, 0x2EC}, {0x2EE, 0x2EE},
+        {0x345, 0x345}, {0x370, 0x374}, {0x376, 0x377}, {0x37A, 0x37D}, {0x37F, 0x37F}, {0x386, 0x386},
+        {0x388, 0x38A}, {0x38C, 0x38C}, {0x38E, 0x3A1}, {0x3A3, 0x3F5}, {0x3F7, 0x481}, {0x48A, 0x52F},
+        {0x531, 0x556}, {0x559, 0x559}, {0x560, 0x588}, {0x5B0, 0x5BD}, {0x5BF, 0x5BF}, {0x5C1, 0x5C2},
+        {0x5C4, 0x5C5}, {0x5C7, 0x5C7}, {0x5D0, 0x5EA}, {0x5EF, 0x5F2}, {0x610, 0x61A}, {0x620, 0x657},
+        {0x659, 0x669}, {0x66E, 0x6D3}, {0x6D5, 0x6DC}, {0x6E1, 0x6E8}, {0x6ED, 0x6FC}, {0x6FF, 0x6FF},
+        {0x710, 0x73F}, {0x74D, 0x7B1}, {0x7C0, 0x7EA}, {0x7F4, 0x7F5}, {0x7FA, 0x7FA}
+    };
+    LetterTable table{};
+    for (const auto& range : ranges) {
+        for (unsigned c = range[0]; c <= range[1]; c++) {
+            table.letter[c] = true;
+        }
+    }
+    return table;
+}
+
+/// Таблица букв всех алфавитов
+inline constexpr LetterTable letterTable = makeLetterTable();
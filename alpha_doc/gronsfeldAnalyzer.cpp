@@ -0,0 +1,542 @@
+#include "gronsfeldAnalyzer.h"
+#include "modAlphaCipher.h"
+#include "../common/mappedFile.h"
+#include "../common/utf8.h"
+#include "../common/threadPool.h"
+#include <algorithm>
+#include <cerrno>
+#include <cstdint>
+#include <numeric>
+#include <stdexcept>
+#include <unordered_map>
+#include <utility>
+
+/**
+ * @file gronsfeldAnalyzer.cpp
+ * @brief Реализация криптоанализа шифра Гронсфельда
+ */
+
+namespace {
+
+/// Наибольшая длина выборки для метода Казиски (букв)
+constexpr std::size_t kasiskiLetters = std::size_t(1) << 20;
+
+/// Наибольший размер плоской таблицы позиций триграмм (элементов)
+constexpr std::size_t trigramTableLimit = std::size_t(1) << 20;
+
+/**
+ * @brief Обход букв алфавита на участке широкой строки
+ * @param text Текст
+ * @param begin Начало участка
+ * @param end Конец участка
+ * @param alphabet Алфавит
+ * @param visit Вызывается с номером каждой буквы алфавита; false прекращает обход
+ * @return Ошибка (для широкой строки ошибок нет)
+ */
+template <class Visit>
+CipherError forEachLetter(const wchar_t* text, std::size_t begin, std::size_t end, const AlphabetTable& alphabet, Visit&& visit)
+{
+    for (std::size_t i = begin; i < end; i++) {
+        const unsigned long c = static_cast<unsigned long>(text[i]);
+        const int idx = (c < alphabetCodeRange) ? alphabet.index[c] : -1;
+        if (idx >= 0 && !visit(static_cast<unsigned char>(idx))) {
+            break;
+        }
+    }
+    return {};
+}
+
+/**
+ * @brief Обход букв алфавита на участке строки UTF-8
+ * @param text Текст
+ * @param begin Начало участка в байтах (начало символа)
+ * @param end Конец участка в байтах
+ * @param alphabet Алфавит
+ * @param visit Вызывается с номером каждой буквы алфавита; false прекращает обход
+ * @return CipherErrc::invalidSymbol с позицией некорректной последовательности в байтах
+ * @details Символы ASCII и двухбайтовые последовательности (кириллица, латиница
+ * с диакритикой, греческий алфавит) разбираются без общего декодера
+ */
+template <class Visit>
+CipherError forEachLetter(const char* text, std::size_t begin, std::size_t end, const AlphabetTable& alphabet, Visit&& visit)
+{
+    const char* p = text + begin;
+    const char* stop = text + end;
+    while (p < stop) {
+        const unsigned char b0 = static_cast<unsigned char>(*p);
+        char32_t c;
+        if (b0 < 0x80) {
+            c = b0;
+            ++p;
+        } else if (b0 >= 0xC2 && b0 <= 0xDF && p + 1 < stop && (static_cast<unsigned char>(p[1]) & 0xC0) == 0x80) {
+            c = (static_cast<char32_t>(b0 & 0x1F) << 6) | (static_cast<unsigned char>(p[1]) & 0x3F);
+            p += 2;
+        } else {
+            const char* at = p;
+            c = utf8Decode(p, stop);
+            if (c == utf8Invalid) {
+                return {CipherErrc::invalidSymbol, static_cast<std::size_t>(at - text)};
+            }
+        }
+        const int idx = (c < alphabetCodeRange) ? alphabet.index[c] : -1;
+        if (idx >= 0 && !visit(static_cast<unsigned char>(idx))) {
+            break;
+        }
+    }
+    return {};
+}
+
+/**
+ * @brief Граница части текста при делении на части
+ * @param text Текст
+ * @param length Длина текста
+ * @param part Номер части
+ * @param parts Количество частей
+ * @return Начало части; для UTF-8 сдвигается на начало символа
+ */
+std::size_t partStart(const wchar_t*, std::size_t length, std::size_t part, std::size_t parts)
+{
+    return length * part / parts;
+}
+
+/**
+ * @brief Граница части строки UTF-8 при делении на части
+ * @param text Текст
+ * @param length Длина текста в байтах
+ * @param part Номер части
+ * @param parts Количество частей
+ * @return Начало части, сдвинутое на начало ближайшего символа
+ */
+std::size_t partStart(const char* text, std::size_t length, std::size_t part, std::size_t parts)
+{
+    std::size_t bound = length * part / parts;
+    while (bound < length && (static_cast<unsigned char>(text[bound]) & 0xC0) == 0x80) {
+        ++bound;
+    }
+    return bound;
+}
+
+/**
+ * @brief Средний по остаткам индекс совпадений
+ * @param sample Номера букв
+ * @param period Длина ключа
+ * @param size Мощность алфавита
+ * @return Среднее по остаткам значение sum h(h - 1) / (N (N - 1))
+ */
+double coincidenceIndex(const std::vector<unsigned char>& sample, std::size_t period, std::size_t size)
+{
+    std::vector<std::uint32_t> counts(period * size, 0);
+    std::size_t residue = 0;
+    for (unsigned char idx : sample) {
+        counts[residue * size + idx]++;
+        if (++residue == period) {
+            residue = 0;
+        }
+    }
+    double total = 0;
+    std::size_t used = 0;
+    for (std::size_t r = 0; r < period; r++) {
+        const std::uint32_t* row = counts.data() + r * size;
+        double n = 0;
+        double pairs = 0;
+        for (std::size_t c = 0; c < size; c++) {
+            n += row[c];
+            pairs += static_cast<double>(row[c]) * (static_cast<double>(row[c]) - 1);
+        }
+        if (n > 1) {
+            total += pairs / (n * (n - 1));
+            used++;
+        }
+    }
+    return used > 0 ? total / used : 0;
+}
+
+/**
+ * @brief Голоса метода Казиски
+ * @param sample Номера букв
+ * @param size Мощность алфавита
+ * @param maxPeriod Наибольшая длина ключа
+ * @return votes[p - 1] - количество расстояний между соседними повторами триграмм, кратных p
+ * @details Расстояния сначала собираются в гистограмму, затем для каждой длины p
+ * суммируются кратные ей расстояния: length * (1 + 1/2 + ... + 1/maxPeriod)
+ * операций вместо maxPeriod делений на каждый повтор. Последние позиции триграмм
+ * хранятся в плоской таблице, если она не больше trigramTableLimit элементов
+ */
+std::vector<std::size_t> kasiskiVotes(const std::vector<unsigned char>& sample, std::size_t size, std::size_t maxPeriod)
+{
+    const std::size_t length = std::min(sample.size(), kasiskiLetters);
+    std::vector<std::uint32_t> distances(length, 0);
+    auto countRepeats = [&](auto& last) {
+        for (std::size_t i = 0; i + 2 < length; i++) {
+            const std::size_t trigram = (sample[i] * size + sample[i + 1]) * size + sample[i + 2];
+            std::uint32_t& previous = last[trigram];
+            if (previous != 0) {
+                distances[i + 1 - previous]++;
+            }
+            previous = static_cast<std::uint32_t>(i + 1);
+        }
+    };
+    if (size * size * size <= trigramTableLimit) {
+        std::vector<std::uint32_t> last(size * size * size, 0);
+        countRepeats(last);
+    } else {
+        std::unordered_map<std::size_t, std::uint32_t> last;
+        countRepeats(last);
+    }
+
+    std::vector<std::size_t> votes(maxPeriod, 0);
+    for (std::size_t p = 1; p <= maxPeriod; p++) {
+        for (std::size_t distance = p; distance < length; distance += p) {
+            votes[p - 1] += distances[distance];
+        }
+    }
+    return votes;
+}
+
+/**
+ * @brief Выбор длины ключа
+ * @param periods Статистика длин 1 .. maxPeriod
+ * @param threshold Порог индекса совпадений
+ * @return Наименьшая длина с индексом совпадений не ниже порога; если таких нет -
+ * длина с наибольшей долей голосов Казиски (голоса * длина, так как случайное
+ * расстояние делится на p с вероятностью 1/p), а без голосов - с наибольшим индексом
+ */
+std::size_t choosePeriod(const std::vector<PeriodStats>& periods, double threshold)
+{
+    for (const PeriodStats& stats : periods) {
+        if (stats.coincidence >= threshold) {
+            return stats.period;
+        }
+    }
+    std::size_t best = 1;
+    std::size_t bestVotes = 0;
+    for (const PeriodStats& stats : periods) {
+        if (stats.period > 1 && stats.kasiskiVotes * stats.period > bestVotes) {
+            bestVotes = stats.kasiskiVotes * stats.period;
+            best = stats.period;
+        }
+    }
+    if (bestVotes > 0) {
+        return best;
+    }
+    double bestIndex = -1;
+    for (const PeriodStats& stats : periods) {
+        if (stats.coincidence > bestIndex) {
+            bestIndex = stats.coincidence;
+            best = stats.period;
+        }
+    }
+    return best;
+}
+
+/**
+ * @brief Значение результата или исключение с его ошибкой
+ * @param result Результат операции
+ * @return Значение результата
+ * @throw cipher_error Если результат содержит ошибку
+ */
+KeyEstimate valueOrThrow(CipherResult<KeyEstimate>&& result)
+{
+    if (!result) {
+        throw modAlphaCipher::makeError(result.error(), false);
+    }
+    return std::move(*result);
+}
+
+} // namespace
+
+/**
+ * @brief Частоты букв русского языка для алфавита шифра
+ * @param alpha Алфавит шифра
+ * @return Частоты букв в порядке алфавита
+ * @details Частоты по национальному корпусу русского языка, буква Ё - отдельно от Е.
+ * Частота переносится на номер той же буквы в alpha, затем частоты нормируются
+ */
+std::vector<double> russianLetterFrequencies(const AlphabetTable& alpha)
+{
+    static const double percent[33] = {
+        8.01, 1.59, 4.54, 1.70, 2.98, 8.45, 0.04, 0.94, 1.65, 7.35, 1.21, // А .. Й
+        3.49, 4.40, 3.21, 6.70, 10.97, 2.81, 4.73, 5.47, 6.26, 2.62, 0.26, // К .. Ф
+        0.97, 0.48, 1.44, 0.73, 0.36, 0.04, 1.90, 1.74, 0.32, 0.64, 2.01 // Х .. Я
+    };
+    std::vector<double> result(static_cast<std::size_t>(alpha.size), 0.0);
+    double sum = 0;
+    for (std::size_t i = 0; i < 33; i++) {
+        const int idx = alpha.index[russianAlphabet.symbols[i]];
+        if (idx >= 0) {
+            result[static_cast<std::size_t>(idx)] = percent[i];
+            sum += percent[i];
+        }
+    }
+    if (sum > 0) {
+        for (double& p : result) {
+            p /= sum;
+        }
+    }
+    return result;
+}
+
+/**
+ * @brief Конструктор анализатора с частотами русского языка
+ * @param alpha Алфавит шифра
+ */
+GronsfeldAnalyzer::GronsfeldAnalyzer(const AlphabetTable& alpha)
+    : alphabet(&alpha), frequencies(russianLetterFrequencies(alpha))
+{
+}
+
+/**
+ * @brief Конструктор анализатора с частотами букв языка
+ * @param alpha Алфавит шифра
+ * @param letterFrequencies Частоты букв языка в порядке алфавита
+ * @throw std::invalid_argument Если количество частот не равно мощности алфавита
+ */
+GronsfeldAnalyzer::GronsfeldAnalyzer(const AlphabetTable& alpha, std::vector<double> letterFrequencies)
+    : alphabet(&alpha), frequencies(std::move(letterFrequencies))
+{
+    if (frequencies.size() != static_cast<std::size_t>(alpha.size)) {
+        throw std::invalid_argument("Количество частот букв не равно мощности алфавита");
+    }
+}
+
+/**
+ * @brief Включение параллельного режима
+ * @param workers Количество потоков; 0 или 1 - последовательный режим
+ * @param minChunkSize Наименьший фрагмент текста на один поток
+ */
+void GronsfeldAnalyzer::setParallelism(std::size_t workers, std::size_t minChunkSize)
+{
+    pool = (workers > 1) ? std::make_shared<ThreadPool>(workers) : nullptr;
+    parallelMinChunk = (minChunkSize > 0) ? minChunkSize : 1;
+}
+
+/**
+ * @brief Количество частей для параллельной обработки текста
+ * @param length Длина текста (символов или байт UTF-8)
+ * @return Количество частей; 1 означает последовательную обработку
+ */
+std::size_t GronsfeldAnalyzer::parallelParts(std::size_t length) const
+{
+    if (!pool) {
+        return 1;
+    }
+    std::size_t parts = length / parallelMinChunk;
+    if (parts > pool->size()) {
+        parts = pool->size();
+    }
+    return parts > 1 ? parts : 1;
+}
+
+/**
+ * @brief Анализ текста
+ * @param text Шифротекст
+ * @return Результат анализа или ошибка
+ * @details Этапы анализа:
+ * 1. **Выборка**: первые sampleLetters букв переводятся в номера алфавита.
+ * 2. **Длина ключа**: для каждой длины p до maxPeriod считается средний по остаткам
+ *    индекс совпадений (в параллельном режиме длины распределяются между потоками)
+ *    и голоса Казиски. Выбирается наименьшая длина, индекс которой прошел не меньше
+ *    трех четвертей пути от индекса случайного текста (1 / мощность) к индексу
+ *    языка (сумма квадратов частот).
+ * 3. **Гистограммы**: весь текст делится на части по границам символов; каждая часть
+ *    строит гистограммы букв по остаткам, начиная с остатка 0, а при объединении
+ *    остатки части поворачиваются на количество букв перед ней.
+ * 4. **Ключ**: для остатка r выбирается сдвиг k с наибольшей суммой
+ *    h_r[c] * f[(c - k) mod n], так как зашифрованная буква c = (p + k) mod n.
+ */
+template <class Char>
+CipherResult<KeyEstimate> GronsfeldAnalyzer::analyzeText(std::basic_string_view<Char> text) const
+{
+    if (text.empty()) {
+        return CipherErrc::emptyText;
+    }
+    const std::size_t size = static_cast<std::size_t>(alphabet->size);
+    const std::size_t parts = parallelParts(text.size());
+
+    // Выборка для оценки длины ключа
+    std::vector<unsigned char> sample;
+    sample.reserve(std::min(sampleLetters, text.size()));
+    CipherError error = forEachLetter(text.data(), 0, text.size(), *alphabet, [&](unsigned char idx) {
+        sample.push_back(idx);
+        return sample.size() < sampleLetters;
+    });
+    if (error) {
+        return error;
+    }
+
+    KeyEstimate estimate;
+    const std::size_t periods = std::max<std::size_t>(1, std::min(maxPeriod, sample.size() / 2));
+    estimate.periods.resize(periods);
+    auto measurePeriod = [&](std::size_t i) {
+        estimate.periods[i].period = i + 1;
+        estimate.periods[i].coincidence = coincidenceIndex(sample, i + 1, size);
+    };
+    if (parts > 1) {
+        pool->run(periods, measurePeriod);
+    } else {
+        for (std::size_t i = 0; i < periods; i++) {
+            measurePeriod(i);
+        }
+    }
+    const std::vector<std::size_t> votes = kasiskiVotes(sample, size, periods);
+    double language = 0;
+    for (double f : frequencies) {
+        language += f * f;
+    }
+    for (std::size_t i = 0; i < periods; i++) {
+        estimate.periods[i].kasiskiVotes = votes[i];
+    }
+    // Смесь двух сдвигов на одном остатке (кратная длина ключа) дает индекс около
+    // середины между индексами языка и случайного текста, поэтому порог выше середины
+    const std::size_t period = choosePeriod(estimate.periods, (3 * language + 1.0 / size) / 4);
+    sample = std::vector<unsigned char>();
+
+    // Гистограммы букв по остаткам
+    std::vector<std::size_t> bounds(parts + 1);
+    for (std::size_t i = 0; i <= parts; i++) {
+        bounds[i] = (i == parts) ? text.size() : partStart(text.data(), text.size(), i, parts);
+    }
+    std::vector<std::vector<std::uint64_t>> local(parts);
+    std::vector<std::size_t> found(parts, 0);
+    std::vector<CipherError> errors(parts);
+    auto countPart = [&](std::size_t i) {
+        std::vector<std::uint64_t>& counts = local[i];
+        counts.assign(period * size, 0);
+        std::size_t residue = 0;
+        std::uint64_t* row = counts.data();
+        errors[i] = forEachLetter(text.data(), bounds[i], bounds[i + 1], *alphabet, [&](unsigned char idx) {
+            row[idx]++;
+            if (++residue == period) {
+                residue = 0;
+                row = counts.data();
+            } else {
+                row += size;
+            }
+            return true;
+        });
+        found[i] = static_cast<std::size_t>(std::accumulate(counts.begin(), counts.end(), std::uint64_t(0)));
+    };
+    if (parts > 1) {
+        pool->run(parts, countPart);
+    } else {
+        countPart(0);
+    }
+
+    std::vector<std::uint64_t> counts(period * size, 0);
+    std::size_t letters = 0;
+    for (std::size_t i = 0; i < parts; i++) {
+        if (errors[i]) {
+            return errors[i];
+        }
+        const std::size_t shift = letters % period;
+        for (std::size_t r = 0; r < period; r++) {
+            const std::uint64_t* from = local[i].data() + r * size;
+            std::uint64_t* to = counts.data() + ((r + shift) % period) * size;
+            for (std::size_t c = 0; c < size; c++) {
+                to[c] += from[c];
+            }
+        }
+        letters += found[i];
+    }
+    if (letters == 0) {
+        return CipherErrc::noLetters;
+    }
+
+    // Подбор букв ключа по частотам языка
+    estimate.letters = letters;
+    estimate.period = period;
+    for (std::size_t r = 0; r < period; r++) {
+        const std::uint64_t* row = counts.data() + r * size;
+        double best = -1;
+        double second = -1;
+        std::size_t bestShift = 0;
+        for (std::size_t k = 0; k < size; k++) {
+            double score = 0;
+            for (std::size_t c = 0; c < size; c++) {
+                score += static_cast<double>(row[c]) * frequencies[(c + size - k) % size];
+            }
+            if (score > best) {
+                second = best;
+                best = score;
+                bestShift = k;
+            } else if (score > second) {
+                second = score;
+            }
+        }
+        estimate.numericKey.push_back(static_cast<int>(bestShift));
+        estimate.key.push_back(alphabet->symbols[bestShift]);
+        estimate.keyMargins.push_back((best > 0 && second >= 0) ? (best - second) / best : 0);
+    }
+    return estimate;
+}
+
+/**
+ * @brief Анализ шифротекста
+ * @param cipher_text Шифротекст
+ * @return Оценка длины ключа и ключ
+ * @throw cipher_error При некорректном тексте
+ */
+KeyEstimate GronsfeldAnalyzer::analyze(const std::wstring& cipher_text) const
+{
+    return valueOrThrow(tryAnalyze(cipher_text));
+}
+
+/**
+ * @brief Анализ шифротекста в кодировке UTF-8
+ * @param cipher_text Шифротекст в кодировке UTF-8
+ * @return Оценка длины ключа и ключ
+ * @throw cipher_error При некорректном тексте
+ */
+KeyEstimate GronsfeldAnalyzer::analyze(std::string_view cipher_text) const
+{
+    return valueOrThrow(tryAnalyze(cipher_text));
+}
+
+/**
+ * @brief Анализ файла с шифротекстом
+ * @param path Путь к файлу
+ * @return Оценка длины ключа и ключ
+ * @throw cipher_error При некорректном содержимом файла или ошибке чтения
+ */
+KeyEstimate GronsfeldAnalyzer::analyzeFile(const std::string& path) const
+{
+    return valueOrThrow(tryAnalyzeFile(path));
+}
+
+/**
+ * @brief Анализ шифротекста без исключений
+ * @param cipher_text Шифротекст
+ * @return Результат анализа или ошибка
+ */
+CipherResult<KeyEstimate> GronsfeldAnalyzer::tryAnalyze(const std::wstring& cipher_text) const
+{
+    return analyzeText(std::wstring_view(cipher_text));
+}
+
+/**
+ * @brief Анализ шифротекста UTF-8 без исключений
+ * @param cipher_text Шифротекст в кодировке UTF-8
+ * @return Результат анализа или ошибка
+ */
+CipherResult<KeyEstimate> GronsfeldAnalyzer::tryAnalyze(std::string_view cipher_text) const
+{
+    return analyzeText(cipher_text);
+}
+
+/**
+ * @brief Анализ файла без исключений
+ * @param path Путь к файлу
+ * @return Результат анализа или ошибка
+ */
+CipherResult<KeyEstimate> GronsfeldAnalyzer::tryAnalyzeFile(const std::string& path) const
+{
+    MappedFile file;
+    struct stat info;
+    if (!file.openForReading(path.c_str(), info)) {
+        return CipherError{CipherErrc::ioError, static_cast<std::size_t>(errno)};
+    }
+    if (file.size == 0) {
+        return CipherErrc::emptyText;
+    }
+    return analyzeText(std::string_view(file.data, file.size));
+}
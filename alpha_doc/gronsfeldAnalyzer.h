@@ -0,0 +1,204 @@
+#pragma once
+#include <cstddef>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+#include "alphabet.h"
+#include "../common/cipherResult.h"
+
+class ThreadPool;
+
+/**
+ * @file
+ * @author Ганьшин В.А.
+ * @version 1.0
+ * @date 17.12.2025
+ * @brief Криптоанализ шифра Гронсфельда: длина ключа и ключ по шифротексту
+ * @details Длина ключа оценивается по индексу совпадений букв, стоящих на одном
+ * остатке от деления позиции на длину ключа, и по методу Казиски (расстояния между
+ * повторами триграмм). Обе статистики считаются по начальной выборке шифротекста.
+ * Затем за один проход по всему шифротексту строятся гистограммы букв по остаткам,
+ * и каждая буква ключа находится как сдвиг, при котором гистограмма остатка лучше
+ * всего совпадает с частотами букв языка.
+ */
+
+/**
+ * @brief Частоты букв русского языка для алфавита шифра
+ * @param alpha Алфавит шифра
+ * @return Частоты alpha.size букв в порядке алфавита (сумма равна 1); частоты
+ * сопоставляются по буквам, поэтому для russianAlphabetNoYo частота Ё
+ * отбрасывается, а буквы не из русского алфавита получают нулевую частоту
+ */
+std::vector<double> russianLetterFrequencies(const AlphabetTable& alpha = russianAlphabet);
+
+/**
+ * @brief Статистика одной длины ключа
+ */
+struct PeriodStats {
+    std::size_t period = 0; ///< Длина ключа
+    double coincidence = 0; ///< Средний по остаткам индекс совпадений
+    std::size_t kasiskiVotes = 0; ///< Количество расстояний между повторами триграмм, кратных длине
+};
+
+/**
+ * @brief Результат анализа шифротекста
+ */
+struct KeyEstimate {
+    std::size_t letters = 0; ///< Количество букв алфавита в шифротексте
+    std::size_t period = 0; ///< Оценка длины ключа
+    std::vector<PeriodStats> periods; ///< Статистика длин 1 .. maxPeriod (periods[i].period == i + 1)
+    std::vector<int> numericKey; ///< Ключ в числовом виде (сдвиги 0 .. мощность алфавита - 1)
+    std::wstring key; ///< Ключ буквами алфавита (годится для конструктора modAlphaCipher)
+    std::vector<double> keyMargins; ///< Для каждой буквы ключа - отрыв лучшего сдвига от второго (0 .. 1)
+};
+
+/**
+ * @brief Анализатор шифротекста Гронсфельда
+ * @details Предполагается, что позиция в ключе идет через весь шифротекст
+ * непрерывно (одно сообщение или поток modAlphaStream), а символы вне алфавита
+ * перенесены без сдвига ключа или удалены: они пропускаются при анализе.
+ * Гистограммы по остаткам строятся параллельно по частям текста; части
+ * объединяются с поворотом остатков на количество букв перед частью.
+ *
+ * Пример использования:
+ * @code
+ * GronsfeldAnalyzer analyzer;
+ * analyzer.setParallelism(8);
+ * KeyEstimate estimate = analyzer.analyzeFile("corpus.txt");
+ * modAlphaCipher cipher(estimate.key);
+ * @endcode
+ */
+class GronsfeldAnalyzer
+{
+private:
+    const AlphabetTable* alphabet; ///< Алфавит шифра (не принадлежит анализатору)
+    std::vector<double> frequencies; ///< Частоты букв языка в порядке алфавита
+    std::size_t maxPeriod = defaultMaxPeriod; ///< Наибольшая проверяемая длина ключа
+    std::size_t sampleLetters = defaultSampleLetters; ///< Длина выборки для оценки длины ключа, букв
+    std::shared_ptr<ThreadPool> pool; ///< Пул потоков параллельного режима (пустой - последовательный режим)
+    std::size_t parallelMinChunk = defaultParallelChunk; ///< Наименьший фрагмент текста на один поток
+
+    /**
+     * @brief Анализ текста
+     * @tparam Char wchar_t или char (UTF-8)
+     * @param text Шифротекст
+     * @return Результат анализа или ошибка
+     */
+    template <class Char>
+    CipherResult<KeyEstimate> analyzeText(std::basic_string_view<Char> text) const;
+
+    /**
+     * @brief Количество частей для параллельной обработки текста
+     * @param length Длина текста (символов или байт UTF-8)
+     * @return Количество частей; 1 означает последовательную обработку
+     */
+    std::size_t parallelParts(std::size_t length) const;
+
+public:
+    /// Наибольшая проверяемая длина ключа по умолчанию
+    static constexpr std::size_t defaultMaxPeriod = 64;
+
+    /// Длина выборки для оценки длины ключа по умолчанию (букв)
+    static constexpr std::size_t defaultSampleLetters = std::size_t(1) << 22;
+
+    /// Наименьший фрагмент текста на один поток по умолчанию (символов или байт UTF-8)
+    static constexpr std::size_t defaultParallelChunk = std::size_t(1) << 20;
+
+    /**
+     * @brief Конструктор анализатора с частотами русского языка
+     * @param alpha Алфавит шифра; анализатор хранит ссылку на таблицы, поэтому они
+     * должны существовать, пока существует анализатор
+     */
+    explicit GronsfeldAnalyzer(const AlphabetTable& alpha = russianAlphabet);
+
+    /**
+     * @brief Конструктор анализатора с частотами букв языка открытого текста
+     * @param alpha Алфавит шифра (должен существовать, пока существует анализатор)
+     * @param letterFrequencies Частоты букв языка в порядке алфавита (alpha.size значений)
+     * @throw std::invalid_argument Если количество частот не равно мощности алфавита
+     */
+    GronsfeldAnalyzer(const AlphabetTable& alpha, std::vector<double> letterFrequencies);
+
+    /**
+     * @brief Запрещенный конструктор с временным алфавитом
+     */
+    explicit GronsfeldAnalyzer(const AlphabetTable&& alpha) = delete;
+
+    /**
+     * @brief Запрещенный конструктор с временным алфавитом
+     */
+    GronsfeldAnalyzer(const AlphabetTable&& alpha, std::vector<double> letterFrequencies) = delete;
+
+    /**
+     * @brief Включение параллельного режима
+     * @param workers Количество потоков; 0 или 1 - последовательный режим
+     * @param minChunkSize Наименьший фрагмент текста (символов или байт UTF-8) на один поток
+     */
+    void setParallelism(std::size_t workers, std::size_t minChunkSize = defaultParallelChunk);
+
+    /**
+     * @brief Установка наибольшей проверяемой длины ключа
+     * @param period Наибольшая длина ключа (не меньше 1)
+     */
+    void setMaxPeriod(std::size_t period) {
+        maxPeriod = (period > 0) ? period : 1;
+    }
+
+    /**
+     * @brief Установка длины выборки для оценки длины ключа
+     * @details Индекс совпадений и повторы триграмм считаются по первым letters буквам;
+     * буквы ключа находятся по всему тексту
+     * @param letters Длина выборки в буквах (не меньше 2)
+     */
+    void setSampleLetters(std::size_t letters) {
+        sampleLetters = (letters > 2) ? letters : 2;
+    }
+
+    /**
+     * @brief Анализ шифротекста
+     * @param cipher_text Шифротекст
+     * @return Оценка длины ключа и ключ
+     * @throw cipher_error Если текст пустой или не содержит букв алфавита
+     */
+    KeyEstimate analyze(const std::wstring& cipher_text) const;
+
+    /**
+     * @brief Анализ шифротекста в кодировке UTF-8
+     * @param cipher_text Шифротекст в кодировке UTF-8
+     * @return Оценка длины ключа и ключ
+     * @throw cipher_error Если текст пустой, не содержит букв алфавита
+     * или содержит некорректные последовательности UTF-8
+     */
+    KeyEstimate analyze(std::string_view cipher_text) const;
+
+    /**
+     * @brief Анализ файла с шифротекстом в кодировке UTF-8
+     * @details Файл отображается в память и читается без копирования
+     * @param path Путь к файлу
+     * @return Оценка длины ключа и ключ
+     * @throw cipher_error При некорректном содержимом файла или ошибке чтения
+     */
+    KeyEstimate analyzeFile(const std::string& path) const;
+
+    /**
+     * @brief Анализ шифротекста без исключений
+     * @param cipher_text Шифротекст
+     * @return Результат анализа или ошибка
+     */
+    CipherResult<KeyEstimate> tryAnalyze(const std::wstring& cipher_text) const;
+
+    /**
+     * @brief Анализ шифротекста UTF-8 без исключений
+     * @param cipher_text Шифротекст в кодировке UTF-8
+     * @return Результат анализа или ошибка с позицией некорректной последовательности в байтах
+     */
+    CipherResult<KeyEstimate> tryAnalyze(std::string_view cipher_text) const;
+
+    /**
+     * @brief Анализ файла без исключений
+     * @param path Путь к файлу
+     * @return Результат анализа или ошибка (для CipherErrc::ioError в offset - errno)
+     */
+    CipherResult<KeyEstimate> tryAnalyzeFile(const std::string& path) const;
+};
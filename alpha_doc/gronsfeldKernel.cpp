@@ -0,0 +1,273 @@
+#include "gronsfeldKernel.h"
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define GRONSFELD_X86_KERNELS
+#include <immintrin.h>
+#endif
+#include <cstdint>
+
+/**
+ * @file gronsfeldKernel.cpp
+ * @brief Реализация векторного ядра сдвига для шифра Гронсфельда
+ * @details Векторные варианты используют беззнаковое сравнение через max_epu8:
+ * если a >= b, то max(a, b) == a, иначе к разности a - b прибавляется модуль.
+ * Классификация ASCII приводит байт к нижнему регистру (c | 0x20) и сравнивает
+ * его с диапазоном 'a'..'z' знаковым сравнением: байты от 0x80 при этом отрицательны
+ * и в диапазон не попадают.
+ */
+
+namespace {
+
+/// Тип указателя на реализацию ядра
+using ShiftKernel = void (*)(unsigned char*, const unsigned char*, std::size_t, unsigned char);
+
+/// Тип указателя на реализацию классификации ASCII
+using ScanKernel = std::size_t (*)(const unsigned char*, std::size_t, std::size_t&);
+
+/// Признак "байт, не являющийся буквой или пробелом, еще не найден"
+constexpr std::size_t notFound = static_cast<std::size_t>(-1);
+
+/**
+ * @brief Скалярная реализация ядра
+ * @param data Номера символов
+ * @param shift Сдвиги
+ * @param length Количество символов
+ * @param modulus Мощность алфавита (256 передается как 0)
+ */
+void shiftScalar(unsigned char* data, const unsigned char* shift, std::size_t length, unsigned char modulus)
+{
+    for (std::size_t i = 0; i < length; i++) {
+        unsigned char a = data[i];
+        unsigned char b = shift[i];
+        unsigned char r = static_cast<unsigned char>(a - b);
+        if (a < b) {
+            r = static_cast<unsigned char>(r + modulus);
+        }
+        data[i] = r;
+    }
+}
+
+/**
+ * @brief Продолжение классификации ASCII по одному байту
+ * @param data Текст
+ * @param i Номер первого непроверенного байта
+ * @param length Длина текста
+ * @param firstOther Найденный байт, не являющийся буквой или пробелом, или notFound;
+ * на выходе - окончательное значение
+ * @return Длина начального отрезка байт ASCII
+ */
+std::size_t scanTail(const unsigned char* data, std::size_t i, std::size_t length, std::size_t& firstOther)
+{
+    for (; i < length && data[i] < 0x80; i++) {
+        const unsigned char lower = static_cast<unsigned char>(data[i] | 0x20);
+        if (firstOther == notFound && data[i] != ' ' && (lower < 'a' || lower > 'z')) {
+            firstOther = i;
+        }
+    }
+    if (firstOther == notFound || firstOther > i) {
+        firstOther = i;
+    }
+    return i;
+}
+
+/**
+ * @brief Скалярная классификация отрезка ASCII
+ * @param data Текст
+ * @param length Длина текста
+ * @param firstOther Первый байт отрезка, не являющийся буквой или пробелом
+ * @return Длина начального отрезка байт ASCII
+ */
+std::size_t scanScalar(const unsigned char* data, std::size_t length, std::size_t& firstOther)
+{
+    firstOther = notFound;
+    return scanTail(data, 0, length, firstOther);
+}
+
+#ifdef GRONSFELD_X86_KERNELS
+
+/**
+ * @brief Реализация ядра на SSE2 (16 символов за итерацию)
+ * @param data Номера символов
+ * @param shift Сдвиги
+ * @param length Количество символов
+ * @param modulus Мощность алфавита (256 передается как 0)
+ */
+__attribute__((target("sse2")))
+void shiftSse2(unsigned char* data, const unsigned char* shift, std::size_t length, unsigned char modulus)
+{
+    const __m128i m = _mm_set1_epi8(static_cast<char>(modulus));
+    std::size_t i = 0;
+    for (; i + 16 <= length; i += 16) {
+        __m128i a = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + i));
+        __m128i b = _mm_loadu_si128(reinterpret_cast<const __m128i*>(shift + i));
+        __m128i noBorrow = _mm_cmpeq_epi8(_mm_max_epu8(a, b), a);
+        __m128i r = _mm_add_epi8(_mm_sub_epi8(a, b), _mm_andnot_si128(noBorrow, m));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(data + i), r);
+    }
+    shiftScalar(data + i, shift + i, length - i, modulus);
+}
+
+/**
+ * @brief Реализация ядра на AVX2 (32 символа за итерацию)
+ * @param data Номера символов
+ * @param shift Сдвиги
+ * @param length Количество символов
+ * @param modulus Мощность алфавита (256 передается как 0)
+ */
+__attribute__((target("avx2")))
+void shiftAvx2(unsigned char* data, const unsigned char* shift, std::size_t length, unsigned char modulus)
+{
+    const __m256i m = _mm256_set1_epi8(static_cast<char>(modulus));
+    std::size_t i = 0;
+    for (; i + 32 <= length; i += 32) {
+        __m256i a = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data + i));
+        __m256i b = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(shift + i));
+        __m256i noBorrow = _mm256_cmpeq_epi8(_mm256_max_epu8(a, b), a);
+        __m256i r = _mm256_add_epi8(_mm256_sub_epi8(a, b), _mm256_andnot_si256(noBorrow, m));
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(data + i), r);
+    }
+    shiftScalar(data + i, shift + i, length - i, modulus);
+}
+
+/**
+ * @brief Классификация отрезка ASCII на SSE2 (16 байт за итерацию)
+ * @param data Текст
+ * @param length Длина текста
+ * @param firstOther Первый байт отрезка, не являющийся буквой или пробелом
+ * @return Длина начального отрезка байт ASCII
+ */
+__attribute__((target("sse2")))
+std::size_t scanSse2(const unsigned char* data, std::size_t length, std::size_t& firstOther)
+{
+    const __m128i caseBit = _mm_set1_epi8(0x20);
+    const __m128i beforeA = _mm_set1_epi8('a' - 1);
+    const __m128i afterZ = _mm_set1_epi8('z' + 1);
+    const __m128i space = _mm_set1_epi8(' ');
+    firstOther = notFound;
+    std::size_t i = 0;
+    for (; i + 16 <= length; i += 16) {
+        __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + i));
+        __m128i lower = _mm_or_si128(v, caseBit);
+        __m128i alpha = _mm_and_si128(_mm_cmpgt_epi8(lower, beforeA), _mm_cmplt_epi8(lower, afterZ));
+        __m128i word = _mm_or_si128(alpha, _mm_cmpeq_epi8(v, space));
+        const unsigned other = ~static_cast<unsigned>(_mm_movemask_epi8(word)) & 0xFFFFu;
+        const unsigned nonAscii = static_cast<unsigned>(_mm_movemask_epi8(v));
+        if (firstOther == notFound && other != 0) {
+            firstOther = i + static_cast<std::size_t>(__builtin_ctz(other));
+        }
+        if (nonAscii != 0) {
+            const std::size_t run = i + static_cast<std::size_t>(__builtin_ctz(nonAscii));
+            return scanTail(data, run, run, firstOther);
+        }
+    }
+    return scanTail(data, i, length, firstOther);
+}
+
+/**
+ * @brief Классификация отрезка ASCII на AVX2 (32 байта за итерацию)
+ * @param data Текст
+ * @param length Длина текста
+ * @param firstOther Первый байт отрезка, не являющийся буквой или пробелом
+ * @return Длина начального отрезка байт ASCII
+ */
+__attribute__((target("avx2")))
+std::size_t scanAvx2(const unsigned char* data, std::size_t length, std::size_t& firstOther)
+{
+    const __m256i caseBit = _mm256_set1_epi8(0x20);
+    const __m256i beforeA = _mm256_set1_epi8('a' - 1);
+    const __m256i afterZ = _mm256_set1_epi8('z' + 1);
+    const __m256i space = _mm256_set1_epi8(' ');
+    firstOther = notFound;
+    std::size_t i = 0;
+    for (; i + 32 <= length; i += 32) {
+        __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data + i));
+        __m256i lower = _mm256_or_si256(v, caseBit);
+        __m256i alpha = _mm256_and_si256(_mm256_cmpgt_epi8(lower, beforeA), _mm256_cmpgt_epi8(afterZ, lower));
+        __m256i word = _mm256_or_si256(alpha, _mm256_cmpeq_epi8(v, space));
+        const std::uint32_t other = ~static_cast<std::uint32_t>(_mm256_movemask_epi8(word));
+        const std::uint32_t nonAscii = static_cast<std::uint32_t>(_mm256_movemask_epi8(v));
+        if (firstOther == notFound && other != 0) {
+            firstOther = i + static_cast<std::size_t>(__builtin_ctz(other));
+        }
+        if (nonAscii != 0) {
+            const std::size_t run = i + static_cast<std::size_t>(__builtin_ctz(nonAscii));
+            return scanTail(data, run, run, firstOther);
+        }
+    }
+    return scanTail(data, i, length, firstOther);
+}
+
+#endif
+
+/**
+ * @brief Выбранная реализация ядра
+ */
+struct KernelChoice {
+    ShiftKernel function; ///< Указатель на реализацию
+    ScanKernel scan; ///< Указатель на реализацию классификации ASCII
+    const char* name; ///< Название реализации
+};
+
+/**
+ * @brief Выбор реализации ядра по возможностям процессора
+ * @return Выбранная реализация
+ */
+KernelChoice selectKernel()
+{
+#ifdef GRONSFELD_X86_KERNELS
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2")) {
+        return {shiftAvx2, scanAvx2, "avx2"};
+    }
+    if (__builtin_cpu_supports("sse2")) {
+        return {shiftSse2, scanSse2, "sse2"};
+    }
+#endif
+    return {shiftScalar, scanScalar, "scalar"};
+}
+
+/**
+ * @brief Реализация ядра для текущего процессора
+ * @return Выбранная реализация (определяется один раз при первом обращении)
+ */
+const KernelChoice& kernelChoice()
+{
+    static const KernelChoice choice = selectKernel();
+    return choice;
+}
+
+} // namespace
+
+/**
+ * @brief Вычитание сдвигов по модулю мощности алфавита
+ * @param data Номера символов, результат записывается на место
+ * @param shift Сдвиги, по одному на каждый символ
+ * @param length Количество символов
+ * @param modulus Мощность алфавита; значение 256 передается как 0
+ */
+void shiftIndices(unsigned char* data, const unsigned char* shift, std::size_t length, unsigned char modulus)
+{
+    kernelChoice().function(data, shift, length, modulus);
+}
+
+/**
+ * @brief Классификация отрезка символов ASCII
+ * @param data Текст
+ * @param length Длина текста в байтах
+ * @param firstOther Номер первого байта отрезка, не являющегося латинской буквой
+ * или пробелом; длина отрезка, если таких нет
+ * @return Длина начального отрезка байт ASCII
+ */
+std::size_t scanAscii(const unsigned char* data, std::size_t length, std::size_t& firstOther)
+{
+    return kernelChoice().scan(data, length, firstOther);
+}
+
+/**
+ * @brief Название реализации ядра, выбранной для текущего процессора
+ * @return "avx2", "sse2" или "scalar"
+ */
+const char* shiftKernelName()
+{
+    return kernelChoice().name;
+}
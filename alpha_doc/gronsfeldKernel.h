@@ -0,0 +1,49 @@
+#pragma once
+#include <cstddef>
+
+/**
+ * @file
+ * @author Ганьшин В.А.
+ * @version 1.0
+ * @date 17.12.2025
+ * @brief Векторное ядро сдвига для шифра Гронсфельда
+ * @details Ядро работает с однобайтовыми номерами символов алфавита.
+ * Реализация (AVX2, SSE2 или скалярная) выбирается один раз во время выполнения
+ * по возможностям процессора. Все реализации дают одинаковый результат.
+ */
+
+/// Количество номеров символов, обрабатываемых за один вызов ядра
+constexpr std::size_t kernelBlockSize = 4096;
+
+/**
+ * @brief Вычитание сдвигов по модулю мощности алфавита
+ * @details Для каждого i: data[i] = (data[i] - shift[i]) mod modulus.
+ * Зашифровывание сводится к вычитанию дополнения ключа (modulus - k),
+ * поэтому одно ядро обслуживает оба направления без переполнения байта.
+ * Вместо деления используется сравнение и вычитание.
+ * @param data Номера символов (0 .. modulus-1), результат записывается на место
+ * @param shift Сдвиги (0 .. modulus-1), по одному на каждый символ
+ * @param length Количество символов
+ * @param modulus Мощность алфавита; значение 256 передается как 0
+ */
+void shiftIndices(unsigned char* data, const unsigned char* shift, std::size_t length, unsigned char modulus);
+
+/**
+ * @brief Классификация отрезка символов ASCII
+ * @details Находит длину начального отрезка байт ASCII (меньше 0x80)
+ * и первый байт этого отрезка, не являющийся латинской буквой или пробелом.
+ * Позволяет пропускать, проверять или копировать пробелы, знаки препинания
+ * и цифры между словами целыми отрезками вместо посимвольной проверки
+ * @param data Текст
+ * @param length Длина текста в байтах
+ * @param firstOther Номер первого байта отрезка, не являющегося латинской буквой
+ * или пробелом; длина отрезка, если таких нет
+ * @return Длина начального отрезка байт ASCII
+ */
+std::size_t scanAscii(const unsigned char* data, std::size_t length, std::size_t& firstOther);
+
+/**
+ * @brief Название реализации ядра, выбранной для текущего процессора
+ * @return "avx2", "sse2" или "scalar"
+ */
+const char* shiftKernelName();
@@ -1,7 +1,24 @@
 #include "modAlphaCipher.h"
+#include "modAlphaStream.h"
+#include "gronsfeldKernel.h"
+#include "gronsfeldAnalyzer.h"
+#include "../common/mappedFile.h"
+#include "../common/utf8Transcode.h"
 #include <iostream>
 #include <locale>
-#include <codecvt>
+#include <chrono>
+#include <cstring>
+#include <cerrno>
+#include <cstdio>
+#include <cstdlib>
+#include <algorithm>
+#include <stdexcept>
+#include <random>
+#include <string>
+#include <vector>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
 
 /**
  * @file
@@ -10,6 +27,7 @@
  * @date 17.12.2025
  * @brief Главный модуль программы шифрования методом Гронсфельда
  * @details Содержит функции для тестирования модуля шифрования
+ * и режим пакетного шифрования файлов
  */
 
 /**
@@ -24,9 +42,9 @@ void exception_handling(const std::wstring& Text, const std::wstring& key, const
         std::wstring cipherText;
         std::wstring decryptedText;
         
-        std::wcout << L" ТЕСТ: " << testName.c_str() << std::endl;
-        std::wcout << L" Ключ: '" << key << L"'" << std::endl;
-        std::wcout << L" Текст: '" << Text << L"'" << std::endl;
+        std::cout << " ТЕСТ: " << testName << std::endl;
+        std::cout << " Ключ: '" << wideToUtf8(key) << "'" << std::endl;
+        std::cout << " Текст: '" << wideToUtf8(Text) << "'" << std::endl;
         
         // Создаем объект шифра
         modAlphaCipher cipher(key);
@@ -38,41 +56,49 @@ void exception_handling(const std::wstring& Text, const std::wstring& key, const
         decryptedText = cipher.decrypt(cipherText);
         
         // Выводим результаты
-        std::wcout << L"   РЕЗУЛЬТАТ: УСПЕХ" << std::endl;
-        std::wcout << L"   Зашифрованный текст: " << cipherText << std::endl;
-        std::wcout << L"   Расшифрованный текст: " << decryptedText << std::endl;
+        std::cout << "   РЕЗУЛЬТАТ: УСПЕХ" << std::endl;
+        std::cout << "   Зашифрованный текст: " << wideToUtf8(cipherText) << std::endl;
+        std::cout << "   Расшифрованный текст: " << wideToUtf8(decryptedText) << std::endl;
         
         // Проверяем корректность
         if(Text == decryptedText) {
-            std::wcout << L"   Проверка: расшифровка корректна" << std::endl;
+            std::cout << "   Проверка: расшифровка корректна" << std::endl;
         } else {
-            std::wcout << L"   Проверка: расшифровка некорректна" << std::endl;
+            std::cout << "   Проверка: расшифровка некорректна" << std::endl;
         }
         
     } catch (const cipher_error& e) {
         // Обрабатываем исключения шифрования
-        std::wcout << L"    ОШИБКА ШИФРОВАНИЯ: " << e.what() << std::endl;
+        std::cout << "    ОШИБКА ШИФРОВАНИЯ: " << e.what() << std::endl;
         
-        // Детализируем тип ошибки
-        std::string error_msg = e.what();
-        if (error_msg.find("Пустой ключ") != std::string::npos) {
-            std::wcout << L"       ТИП ОШИБКИ: Пустой ключ" << std::endl;
-        } else if (error_msg.find("Недопустимый символ в ключе") != std::string::npos) {
-            std::wcout << L"       ТИП ОШИБКИ: Недопустимые символы в ключе" << std::endl;
-        } else if (error_msg.find("Пустой текст") != std::string::npos) {
-            std::wcout << L"       ТИП ОШИБКИ: Пустой текст" << std::endl;
-        } else if (error_msg.find("недопустимые символы") != std::string::npos) {
-            std::wcout << L"       ТИП ОШИБКИ: Недопустимые символы в тексте" << std::endl;
-        } else if (error_msg.find("не содержит символов русского алфавита") != std::string::npos) {
-            std::wcout << L"       ТИП ОШИБКИ: Отсутствуют русские буквы" << std::endl;
-        } else if (error_msg.find("индекс символа") != std::string::npos) {
-            std::wcout << L"       ТИП ОШИБКИ: Ошибка индексации символов" << std::endl;
-        } else {
-            std::wcout << L"       ТИП ОШИБКИ: Неизвестная ошибка шифрования" << std::endl;
+        // Детализируем тип ошибки по коду
+        switch (e.code()) {
+            case CipherErrc::emptyKey:
+                std::cout << "       ТИП ОШИБКИ: Пустой ключ" << std::endl;
+                break;
+            case CipherErrc::invalidKeySymbol:
+                std::cout << "       ТИП ОШИБКИ: Недопустимые символы в ключе" << std::endl;
+                break;
+            case CipherErrc::noKeyLetters:
+                std::cout << "       ТИП ОШИБКИ: Отсутствуют буквы в ключе" << std::endl;
+                break;
+            case CipherErrc::emptyText:
+                std::cout << "       ТИП ОШИБКИ: Пустой текст" << std::endl;
+                break;
+            case CipherErrc::invalidSymbol:
+                std::cout << "       ТИП ОШИБКИ: Недопустимые символы в тексте (позиция "
+                          << e.error().offset << ")" << std::endl;
+                break;
+            case CipherErrc::noLetters:
+                std::cout << "       ТИП ОШИБКИ: Отсутствуют русские буквы" << std::endl;
+                break;
+            default:
+                std::cout << "       ТИП ОШИБКИ: Неизвестная ошибка шифрования" << std::endl;
+                break;
         }
         
     } 
-    std::wcout << std::endl;
+    std::cout << std::endl;
 }
 
 /**
@@ -80,7 +106,7 @@ void exception_handling(const std::wstring& Text, const std::wstring& key, const
  */
 void testCorrectCases()
 {
-    std::wcout << L"ТЕСТИРОВАНИЕ КОРРЕКТНЫХ ДАННЫХ" << std::endl;
+    std::cout << "ТЕСТИРОВАНИЕ КОРРЕКТНЫХ ДАННЫХ" << std::endl;
     
     exception_handling(L"ТИМПЛБДВА", L"ДОЖДИ", "Корректные данные 1");
     exception_handling(L"ШИФРГРОНСФЕЛЬДА", L"СЕВЕР", "Корректные данные 2");
@@ -94,7 +120,7 @@ void testCorrectCases()
  */
 void testErrorCases()
 {
-    std::wcout << L"ТЕСТИРОВАНИЕ ОШИБОЧНЫХ СЛУЧАЕВ" << std::endl;
+    std::cout << "ТЕСТИРОВАНИЕ ОШИБОЧНЫХ СЛУЧАЕВ" << std::endl;
     
     // Тест с пустым ключом
     exception_handling(L"ТЕКСТ", L"", "Пустой ключ");
@@ -118,38 +144,644 @@ void testErrorCases()
     exception_handling(L"ТЕКСТ", L"КЛЮЧ!?!", "Ключ со спецсимволами");
 }
 
+/// Количество непройденных проверок самотестирования
+int failedChecks = 0;
+
+/**
+ * @brief Вывод результата проверки самотестирования
+ * @param what Что проверялось
+ * @param passed true, если проверка пройдена
+ */
+void reportCheck(const std::string& what, bool passed)
+{
+    std::cout << "   Проверка: " << what << (passed ? " - корректно" : " - НЕКОРРЕКТНО") << std::endl;
+    if (!passed) {
+        failedChecks++;
+    }
+}
+
+/**
+ * @brief Сравнение векторного ядра сдвига со скалярной формулой
+ * @details Длины от 0 до 70 и несколько длин, не кратных 16 и 32, проверяют
+ * обработку хвостов; модуль 0 соответствует алфавиту из 256 символов
+ */
+void testShiftKernel()
+{
+    std::cout << "ТЕСТИРОВАНИЕ ЯДРА СДВИГА (" << shiftKernelName() << ")" << std::endl;
+    
+    std::mt19937 random(2025);
+    std::vector<std::size_t> lengths;
+    for (std::size_t n = 0; n <= 70; n++) {
+        lengths.push_back(n);
+    }
+    lengths.insert(lengths.end(), {255, 1000, 4097});
+    
+    for (unsigned modulus : {33u, 26u, 256u}) {
+        bool passed = true;
+        for (std::size_t n : lengths) {
+            std::vector<unsigned char> data(n);
+            std::vector<unsigned char> shift(n);
+            for (std::size_t i = 0; i < n; i++) {
+                data[i] = static_cast<unsigned char>(random() % modulus);
+                shift[i] = static_cast<unsigned char>(random() % modulus);
+            }
+            std::vector<unsigned char> expected(n);
+            for (std::size_t i = 0; i < n; i++) {
+                expected[i] = static_cast<unsigned char>((data[i] + modulus - shift[i]) % modulus);
+            }
+            shiftIndices(data.data(), shift.data(), n, static_cast<unsigned char>(modulus));
+            passed = passed && data == expected;
+        }
+        reportCheck("сдвиг по модулю " + std::to_string(modulus) + " совпадает со скалярным", passed);
+    }
+    
+    bool passed = true;
+    const char alphabet[] = "abcdefghijklmnopqrstuvwxyzABCDEFGHIJKLMNOPQRSTUVWXYZ      ";
+    for (std::size_t n : lengths) {
+        for (int trial = 0; trial < 4; trial++) {
+            std::vector<unsigned char> data(n);
+            for (std::size_t i = 0; i < n; i++) {
+                data[i] = static_cast<unsigned char>(alphabet[random() % (sizeof(alphabet) - 1)]);
+            }
+            if (n > 0 && (trial & 1) != 0) {
+                data[random() % n] = static_cast<unsigned char>("1,.!?@"[random() % 6]);
+            }
+            if (n > 0 && (trial & 2) != 0) {
+                data[random() % n] = 0xD0;
+            }
+            std::size_t expectedRun = 0;
+            while (expectedRun < n && data[expectedRun] < 0x80) {
+                expectedRun++;
+            }
+            std::size_t expectedOther = expectedRun;
+            for (std::size_t i = 0; i < expectedRun; i++) {
+                const unsigned char lower = static_cast<unsigned char>(data[i] | 0x20);
+                if (data[i] != ' ' && (lower < 'a' || lower > 'z')) {
+                    expectedOther = i;
+                    break;
+                }
+            }
+            std::size_t firstOther = 0;
+            const std::size_t run = scanAscii(data.data(), n, firstOther);
+            passed = passed && run == expectedRun && firstOther == expectedOther;
+        }
+    }
+    reportCheck("классификация ASCII совпадает со скалярной", passed);
+    std::cout << std::endl;
+}
+
+/**
+ * @brief Построение тестового текста UTF-8 из русских слов через пробел
+ * @param words Количество слов
+ * @return Текст
+ */
+std::string sampleText(std::size_t words)
+{
+    const char* vocabulary[] = {"ШИФР", "гронсфельда", "Ёж", "ПРИВЕТ", "мир", "ключ", "текст", "Я"};
+    std::mt19937 random(7);
+    std::string text;
+    for (std::size_t i = 0; i < words; i++) {
+        if (i > 0) {
+            text += ' ';
+        }
+        text += vocabulary[random() % 8];
+    }
+    return text;
+}
+
+/**
+ * @brief Сравнение потоковой обработки с обработкой всего текста сразу
+ * @details Текст делится на фрагменты разной длины, в том числе по одному байту,
+ * так что границы фрагментов проходят внутри символов UTF-8
+ */
+void testStreamChunks()
+{
+    std::cout << "ТЕСТИРОВАНИЕ ПОТОКОВОЙ ОБРАБОТКИ" << std::endl;
+    
+    modAlphaCipher cipher(L"ШИФР");
+    const std::string text = sampleText(300);
+    const std::string encrypted = cipher.encrypt(std::string_view(text));
+    
+    std::mt19937 random(11);
+    for (bool encrypting : {true, false}) {
+        const std::string& source = encrypting ? text : encrypted;
+        const std::string expected = encrypting ? encrypted : cipher.decrypt(std::string_view(encrypted));
+        bool passed = true;
+        for (std::size_t step : {1, 2, 3, 5, 7, 16, 100, 0}) {
+            modAlphaStream stream(cipher, encrypting);
+            std::string out;
+            for (std::size_t pos = 0; pos < source.size(); ) {
+                // step 0 - фрагменты случайной длины
+                const std::size_t length = std::min(step > 0 ? step : 1 + random() % 40, source.size() - pos);
+                stream.update(std::string_view(source).substr(pos, length), out);
+                pos += length;
+            }
+            stream.finish();
+            passed = passed && out == expected;
+        }
+        reportCheck(std::string(encrypting ? "зашифровывание" : "расшифровывание")
+                    + " фрагментами совпадает с обработкой целиком", passed);
+    }
+    
+    // Позиция ошибки отсчитывается от начала потока, а не фрагмента
+    const std::string invalid = text.substr(0, 501) + "7" + text.substr(501);
+    const CipherResult<std::string> whole = cipher.tryEncrypt(std::string_view(invalid));
+    std::size_t streamOffset = 0;
+    try {
+        modAlphaStream stream(cipher, true);
+        std::string out;
+        for (std::size_t pos = 0; pos < invalid.size(); pos += 64) {
+            stream.update(std::string_view(invalid).substr(pos, 64), out);
+        }
+        stream.finish();
+    } catch (const cipher_error& e) {
+        streamOffset = e.error().offset;
+    }
+    reportCheck("позиция недопустимого символа совпадает", !whole && whole.error().offset == 501 && streamOffset == 501);
+    std::cout << std::endl;
+}
+
+/**
+ * @brief Сравнение параллельной обработки с последовательной
+ * @details Маленький фрагмент на поток заставляет делить даже короткий текст
+ * на много частей; недопустимый символ ставится в последнюю часть, чтобы
+ * проверить, что сообщается позиция первой ошибки во всем тексте
+ */
+void testParallel()
+{
+    std::cout << "ТЕСТИРОВАНИЕ ПАРАЛЛЕЛЬНОЙ ОБРАБОТКИ" << std::endl;
+    
+    modAlphaCipher serial(L"ПАРАЛЛЕЛЬ");
+    modAlphaCipher parallel(L"ПАРАЛЛЕЛЬ");
+    parallel.setParallelism(4, 1000);
+    
+    const std::string text = sampleText(5000);
+    const std::wstring wideText = utf8ToWide(text);
+    const std::string encrypted = serial.encrypt(std::string_view(text));
+    const std::wstring wideEncrypted = serial.encrypt(wideText);
+    
+    reportCheck("зашифровывание UTF-8 совпадает с последовательным",
+                parallel.encrypt(std::string_view(text)) == encrypted);
+    reportCheck("расшифровывание UTF-8 совпадает с последовательным",
+                parallel.decrypt(std::string_view(encrypted)) == serial.decrypt(std::string_view(encrypted)));
+    reportCheck("зашифровывание широкой строки совпадает с последовательным",
+                parallel.encrypt(wideText) == wideEncrypted);
+    reportCheck("расшифровывание широкой строки совпадает с последовательным",
+                parallel.decrypt(wideEncrypted) == serial.decrypt(wideEncrypted));
+    
+    // Две ошибки в разных частях: сообщается первая
+    // (вставка перед пробелом не разрезает символы UTF-8)
+    const std::size_t firstInvalid = text.find(' ', text.size() / 2);
+    std::string invalid = text;
+    invalid.insert(text.find(' ', text.size() - 200), "!");
+    invalid.insert(firstInvalid, "5");
+    const CipherResult<std::string> serialError = serial.tryEncrypt(std::string_view(invalid));
+    const CipherResult<std::string> parallelError = parallel.tryEncrypt(std::string_view(invalid));
+    reportCheck("позиция первого недопустимого символа UTF-8 совпадает",
+                !serialError && !parallelError && serialError.error().offset == parallelError.error().offset
+                && parallelError.error().offset == firstInvalid);
+    
+    std::wstring wideInvalid = wideText;
+    wideInvalid[wideInvalid.size() - 10] = L'!';
+    wideInvalid[wideInvalid.size() / 3] = L'5';
+    const CipherResult<std::wstring> wideSerialError = serial.tryEncrypt(wideInvalid);
+    const CipherResult<std::wstring> wideParallelError = parallel.tryEncrypt(wideInvalid);
+    reportCheck("позиция первого недопустимого символа широкой строки совпадает",
+                !wideSerialError && !wideParallelError
+                && wideSerialError.error().offset == wideParallelError.error().offset
+                && wideParallelError.error().offset == wideInvalid.size() / 3);
+    std::cout << std::endl;
+}
+
+/**
+ * @brief Совпадение пакетной обработки с обработкой по одному сообщению
+ * @tparam Char wchar_t или char (UTF-8)
+ * @param cipher Шифр
+ * @param messages Сообщения пакета
+ * @param encrypting true - зашифровывание, false - расшифровывание
+ * @return true, если результат, границы и ошибка каждого сообщения совпадают с tryEncrypt()/tryDecrypt()
+ */
+template <class Char>
+bool batchMatchesSingle(const modAlphaCipher& cipher, const std::vector<std::basic_string<Char>>& messages, bool encrypting)
+{
+    std::basic_string<Char> arena;
+    std::vector<std::size_t> offsets{0};
+    for (const std::basic_string<Char>& message : messages) {
+        arena += message;
+        offsets.push_back(arena.size());
+    }
+    const std::basic_string_view<Char> view(arena);
+    const BatchResult<Char> batch = encrypting ? cipher.encryptBatch(view, offsets) : cipher.decryptBatch(view, offsets);
+    if (batch.size() != messages.size() || batch.offsets.size() != messages.size() + 1
+        || batch.offsets.back() != batch.data.size()) {
+        return false;
+    }
+    std::size_t failed = 0;
+    for (std::size_t i = 0; i < messages.size(); i++) {
+        const CipherResult<std::basic_string<Char>> single = encrypting ? cipher.tryEncrypt(messages[i])
+                                                                        : cipher.tryDecrypt(messages[i]);
+        if (single) {
+            if (!batch.ok(i) || batch.message(i) != *single) {
+                return false;
+            }
+        } else {
+            failed++;
+            if (batch.ok(i) || batch.errors[i].code != single.error().code
+                || batch.errors[i].offset != single.error().offset || !batch.message(i).empty()) {
+                return false;
+            }
+        }
+    }
+    return batch.failed == failed;
+}
+
+/**
+ * @brief Сравнение пакетной обработки с обработкой по одному сообщению
+ * @details Пакет содержит корректные сообщения, сообщения с недопустимыми символами
+ * в разных позициях, пустое сообщение и сообщения без русских букв; ошибка
+ * одного сообщения не должна влиять на соседние
+ */
+void testBatch()
+{
+    std::cout << "ТЕСТИРОВАНИЕ ПАКЕТНОЙ ОБРАБОТКИ" << std::endl;
+    
+    modAlphaCipher cipher(L"ПАКЕТ");
+    const std::vector<std::string> messages = {
+        "ПРИВЕТМИР",
+        "ПРИВЕТ 5 МИР",
+        "",
+        "Ёж",
+        "   ",
+        sampleText(50),
+        "МИР!",
+        "hello",
+        "Я"
+    };
+    std::vector<std::wstring> wideMessages;
+    for (const std::string& message : messages) {
+        wideMessages.push_back(utf8ToWide(message));
+    }
+    
+    reportCheck("зашифровывание пакета UTF-8 совпадает с tryEncrypt()", batchMatchesSingle(cipher, messages, true));
+    reportCheck("расшифровывание пакета UTF-8 совпадает с tryDecrypt()", batchMatchesSingle(cipher, messages, false));
+    reportCheck("зашифровывание пакета широких строк совпадает с tryEncrypt()", batchMatchesSingle(cipher, wideMessages, true));
+    reportCheck("расшифровывание пакета широких строк совпадает с tryDecrypt()", batchMatchesSingle(cipher, wideMessages, false));
+    
+    bool rejected = false;
+    try {
+        cipher.encryptBatch(std::string_view("ПРИВЕТ"), {0, 4, 2});
+    } catch (const cipher_error& e) {
+        rejected = e.error().code == CipherErrc::invalidBatchOffsets;
+    }
+    reportCheck("убывающие смещения пакета отклоняются", rejected);
+    std::cout << std::endl;
+}
+
+/**
+ * @brief Проверка криптоанализа шифра Гронсфельда
+ * @details Текст из предложений обычной русской прозы зашифровывается известным
+ * ключом в алфавитах с буквой Ё и без нее; анализатор должен найти длину
+ * ключа и ключ как последовательно, так и по частям в нескольких потоках
+ */
+void testAnalyzer()
+{
+    std::cout << "ТЕСТИРОВАНИЕ КРИПТОАНАЛИЗА" << std::endl;
+    
+    const char* sentences[] = {
+        "Утром над рекой поднялся густой туман и скрыл дальний берег",
+        "Старый мельник долго стоял у окна и смотрел на дорогу",
+        "В деревне говорили что зима в этом году будет ранней и снежной",
+        "Мальчик взял удочку и побежал к пруду за околицей",
+        "Вечером вся семья собиралась за столом и пила чай с вареньем",
+        "Письмо пришло только через месяц когда все уже перестали ждать",
+        "На площади перед собором торговали хлебом рыбой и яблоками",
+        "Она открыла книгу на середине и начала читать вслух",
+        "Ветер гнал по небу тяжелые облака и качал верхушки сосен",
+        "Доктор сказал что больному нужен покой и свежий воздух"
+    };
+    std::mt19937 random(17);
+    std::string text;
+    while (text.size() < 60000) {
+        text += sentences[random() % 10];
+        text += ' ';
+    }
+    const std::wstring key = L"КЛЮЧИК";
+    
+    for (const AlphabetTable* alpha : {&russianAlphabet, &russianAlphabetNoYo}) {
+        const std::string name = (alpha == &russianAlphabet) ? "с Ё" : "без Ё";
+        modAlphaCipher cipher(key, *alpha);
+        const std::string encrypted = cipher.encrypt(std::string_view(text));
+        const std::wstring wideEncrypted = utf8ToWide(encrypted);
+        GronsfeldAnalyzer serial(*alpha);
+        GronsfeldAnalyzer parallel(*alpha);
+        parallel.setParallelism(4, 1000);
+        bool passed = true;
+        for (const GronsfeldAnalyzer* analyzer : {&serial, &parallel}) {
+            const KeyEstimate utf8 = analyzer->analyze(std::string_view(encrypted));
+            const KeyEstimate wide = analyzer->analyze(wideEncrypted);
+            passed = passed && utf8.period == key.size() && utf8.key == key
+                     && wide.period == key.size() && wide.key == key;
+        }
+        reportCheck("длина ключа и ключ найдены (алфавит " + name + ")", passed);
+    }
+    std::cout << std::endl;
+}
+
+/**
+ * @brief Проверка перекодирования UTF-8 и широких строк
+ * @details Строки разной длины проходят через блоки по 16 байт со смесью ASCII,
+ * двух-, трех- и четырехбайтовых символов; некорректные последовательности
+ * вставляются после такого префикса и должны отвергаться с его длиной в качестве позиции
+ */
+void testTranscoding()
+{
+    std::cout << "ТЕСТИРОВАНИЕ ПЕРЕКОДИРОВАНИЯ UTF-8 (" << utf8TranscodeKernelName() << ")" << std::endl;
+    
+    const std::string pieces[] = {"a", " ", "Я", "ё", "é", "€", "😀", "шифр ", "ABCDEFGHIJKLMNOP"};
+    std::mt19937 random(3);
+    bool passed = true;
+    std::wstring wide;
+    std::string back;
+    for (int trial = 0; trial < 2000; trial++) {
+        std::string text;
+        const int count = trial % 60;
+        for (int i = 0; i < count; i++) {
+            text += pieces[random() % 9];
+        }
+        passed = passed && !utf8ToWide(text, wide) && !wideToUtf8(wide, back) && back == text;
+    }
+    reportCheck("UTF-8 -> широкая строка -> UTF-8 без изменений", passed);
+    
+    const std::string prefix = "ПРИВЕТ hello МИР";
+    const std::string malformed[] = {
+        "\x80",             // продолжение без начала
+        "\xC0\xAF",         // избыточная запись '/'
+        "\xC1\xBF",         // избыточная запись
+        "\xE0\x80\xAF",     // избыточная трехбайтовая запись
+        "\xED\xA0\x80",     // суррогат U+D800
+        "\xF4\x90\x80\x80", // код больше U+10FFFF
+        "\xF5\x80\x80\x80", // недопустимый первый байт
+        "\xD0",             // оборванная последовательность
+        "\xD0 "             // нет байта продолжения
+    };
+    passed = true;
+    for (const std::string& bad : malformed) {
+        for (const std::string& tail : {std::string(), std::string(40, 'x')}) {
+            const CipherError error = utf8ToWide(prefix + bad + tail, wide);
+            passed = passed && error.code == CipherErrc::invalidSymbol && error.offset == prefix.size();
+        }
+    }
+    reportCheck("некорректный UTF-8 отвергается с верной позицией", passed);
+    
+    passed = true;
+    for (wchar_t bad : {static_cast<wchar_t>(0xD800), static_cast<wchar_t>(0xDFFF), static_cast<wchar_t>(0x110000)}) {
+        std::wstring text = utf8ToWide(prefix + prefix);
+        const std::size_t position = text.size();
+        text += bad;
+        text += L"ЖЖЖЖЖЖЖЖЖЖЖЖ";
+        const CipherError error = wideToUtf8(text, back);
+        passed = passed && error.code == CipherErrc::invalidSymbol && error.offset == position;
+    }
+    reportCheck("недопустимый код символа отвергается с верной позицией", passed);
+    std::cout << std::endl;
+}
+
 /**
  * @brief Демонстрация возможных типов ошибок
  */
 void demonstrateErrorTypes()
 {
-    std::wcout << L"ДЕМОНСТРАЦИЯ ТИПОВ ОШИБОК" << std::endl;
+    std::cout << "ДЕМОНСТРАЦИЯ ТИПОВ ОШИБОК" << std::endl;
+    
+    std::cout << "Возможные типы ошибок:" << std::endl;
+    std::cout << "1.  Пустой ключ" << std::endl;
+    std::cout << "2.  Недопустимые символы в ключе" << std::endl; 
+    std::cout << "3.  Пустой текст" << std::endl;
+    std::cout << "4.  Недопустимые символы в тексте" << std::endl;
+    std::cout << "5.  Отсутствуют русские буквы" << std::endl;
+    std::cout << "6.  Ошибка индексации символов" << std::endl;
+    std::cout << std::endl;
+}
+
+/// Размер фрагмента файла, обрабатываемого за один шаг (кратен размеру страницы)
+const std::size_t fileChunkSize = 4 << 20;
+
+/**
+ * @brief Временный файл результата
+ * @details Создается в каталоге выходного файла и заменяет его только после
+ * успешной записи (rename). Если запись не завершена, временный файл удаляется
+ * в деструкторе, а файл, уже существовавший по выходному пути, остается нетронутым
+ */
+struct TemporaryOutput {
+    std::string path; ///< Путь к временному файлу (пустой, если файл не создан)
+    bool committed = false; ///< Признак переименования в выходной файл
+    
+    /**
+     * @brief Создание временного файла рядом с выходным
+     * @param target Путь к выходному файлу
+     * @return Дескриптор файла или -1 при ошибке
+     */
+    int create(const char* target) {
+        path = std::string(target) + ".XXXXXX";
+        const int fd = mkstemp(path.data());
+        if (fd < 0) {
+            path.clear();
+            return -1;
+        }
+        // mkstemp создает файл с правами 0600; права обычного файла - 0644 с учетом umask
+        const mode_t mask = umask(0);
+        umask(mask);
+        fchmod(fd, 0644 & ~mask);
+        return fd;
+    }
+    
+    /**
+     * @brief Замена выходного файла временным
+     * @param target Путь к выходному файлу
+     * @return true при успехе
+     */
+    bool commit(const char* target) {
+        committed = rename(path.c_str(), target) == 0;
+        return committed;
+    }
+    
+    /**
+     * @brief Деструктор: удаление незавершенного временного файла
+     */
+    ~TemporaryOutput() {
+        if (!path.empty() && !committed) {
+            unlink(path.c_str());
+        }
+    }
+};
+
+/**
+ * @brief Вывод справки по режиму шифрования файлов
+ * @param program Имя программы
+ */
+void printUsage(const char* program)
+{
+    std::cerr << "Использование: " << program << " --encrypt|--decrypt --key КЛЮЧ [--strip|--pass-through] вход выход" << std::endl;
+    std::cerr << "  --strip         удалять все символы вне алфавита" << std::endl;
+    std::cerr << "  --pass-through  оставлять символы вне алфавита без изменений" << std::endl;
+    std::cerr << "Без аргументов выполняется самотестирование." << std::endl;
+}
+
+/**
+ * @brief Преобразование ключа из аргумента командной строки (UTF-8)
+ * @param arg Аргумент командной строки
+ * @return Ключ в виде широкой строки
+ * @throw cipher_error Если аргумент не является корректной строкой UTF-8
+ * (позиция ошибки - номер символа ключа)
+ */
+std::wstring keyFromArgument(const char* arg)
+{
+    std::wstring key;
+    if (utf8ToWide(arg, key)) {
+        throw modAlphaCipher::makeError({CipherErrc::invalidKeySymbol, key.size()}, true);
+    }
+    return key;
+}
+
+/**
+ * @brief Шифрование файла в файл через отображение в память
+ * @param argc Количество аргументов командной строки
+ * @param argv Массив аргументов командной строки
+ * @return Код завершения программы: 0 - успех, 1 - ошибка шифрования или ввода-вывода,
+ * 2 - неверные аргументы
+ * @details Входной файл отображается в память и обрабатывается фрагментами
+ * по fileChunkSize байт. Результат пишется прямо в отображение временного файла
+ * (см. TemporaryOutput), размер которого заранее установлен с запасом и после
+ * обработки уменьшается до фактической длины; затем временный файл заменяет
+ * выходной. Входной и выходной пути не должны указывать на один файл.
+ * В конце выводится скорость обработки.
+ */
+int runFileMode(int argc, char** argv)
+{
+    int mode = 0; // 1 - зашифровывание, -1 - расшифровывание
+    const char* keyArg = nullptr;
+    InputPolicy policy = InputPolicy::strict;
+    const char* paths[2] = {nullptr, nullptr};
+    int pathCount = 0;
+    
+    for (int i = 1; i < argc; i++) {
+        if (std::strcmp(argv[i], "--encrypt") == 0) {
+            mode = 1;
+        } else if (std::strcmp(argv[i], "--decrypt") == 0) {
+            mode = -1;
+        } else if (std::strcmp(argv[i], "--key") == 0 && i + 1 < argc) {
+            keyArg = argv[++i];
+        } else if (std::strcmp(argv[i], "--strip") == 0) {
+            policy = InputPolicy::strip;
+        } else if (std::strcmp(argv[i], "--pass-through") == 0) {
+            policy = InputPolicy::passThrough;
+        } else if (argv[i][0] != '-' && pathCount < 2) {
+            paths[pathCount++] = argv[i];
+        } else {
+            printUsage(argv[0]);
+            return 2;
+        }
+    }
+    if (mode == 0 || keyArg == nullptr || pathCount != 2) {
+        printUsage(argv[0]);
+        return 2;
+    }
+    
+    auto started = std::chrono::steady_clock::now();
+    TemporaryOutput temporary;
+    MappedFile input;
+    MappedFile output;
+    std::size_t written = 0;
+    
+    try {
+        modAlphaCipher cipher(keyFromArgument(keyArg));
+        cipher.setInputPolicy(policy);
+        modAlphaStream stream(cipher, mode > 0);
+        
+        // Отображение входного файла
+        struct stat info;
+        if (!input.openForReading(paths[0], info)) {
+            std::cerr << "ОШИБКА: не удалось открыть входной файл " << paths[0]
+                      << ": " << std::strerror(errno) << std::endl;
+            return 1;
+        }
+        if (input.size == 0) {
+            throw modAlphaCipher::makeError({CipherErrc::emptyText, 0}, mode > 0);
+        }
+        
+        // Запись поверх отображенного входного файла испортила бы еще не прочитанные данные
+        struct stat outputInfo;
+        if (stat(paths[1], &outputInfo) == 0 &&
+            outputInfo.st_dev == info.st_dev && outputInfo.st_ino == info.st_ino) {
+            throw cipher_error("Входной и выходной файлы совпадают.", {CipherErrc::inPlaceUnsupported, 0});
+        }
+        
+        // Отображение временного файла с размером, заведомо достаточным для результата
+        const std::size_t capacity = stream.maxOutputSize(input.size);
+        output.fd = temporary.create(paths[1]);
+        if (output.fd < 0 || ftruncate(output.fd, static_cast<off_t>(capacity)) != 0 ||
+            !output.map(capacity, PROT_READ | PROT_WRITE)) {
+            std::cerr << "ОШИБКА: не удалось создать выходной файл " << paths[1]
+                      << ": " << std::strerror(errno) << std::endl;
+            return 1;
+        }
+        
+        // Обработка фрагментами, кратными размеру страницы
+        char* out = output.data;
+        for (std::size_t pos = 0; pos < input.size; pos += fileChunkSize) {
+            const std::size_t length = std::min(fileChunkSize, input.size - pos);
+            out = stream.update(std::string_view(input.data + pos, length), out);
+        }
+        stream.finish();
+        written = static_cast<std::size_t>(out - output.data);
+    } catch (const cipher_error& e) {
+        std::cerr << "ОШИБКА ШИФРОВАНИЯ: " << e.what() << std::endl;
+        return 1;
+    }
     
-    std::wcout << L"Возможные типы ошибок:" << std::endl;
-    std::wcout << L"1.  Пустой ключ" << std::endl;
-    std::wcout << L"2.  Недопустимые символы в ключе" << std::endl; 
-    std::wcout << L"3.  Пустой текст" << std::endl;
-    std::wcout << L"4.  Недопустимые символы в тексте" << std::endl;
-    std::wcout << L"5.  Отсутствуют русские буквы" << std::endl;
-    std::wcout << L"6.  Ошибка индексации символов" << std::endl;
-    std::wcout << std::endl;
+    // Уменьшение выходного файла до фактической длины результата
+    output.unmap();
+    if (ftruncate(output.fd, static_cast<off_t>(written)) != 0 || !temporary.commit(paths[1])) {
+        std::cerr << "ОШИБКА: не удалось записать выходной файл " << paths[1]
+                  << ": " << std::strerror(errno) << std::endl;
+        return 1;
+    }
+    
+    const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - started).count();
+    const double megabytes = static_cast<double>(input.size) / (1024.0 * 1024.0);
+    std::cerr << "Обработано " << megabytes << " МБ за " << seconds << " с ("
+              << (seconds > 0 ? megabytes / seconds : 0.0) << " МБ/с)" << std::endl;
+    return 0;
 }
 
 /**
  * @brief Главная функция программы
  * @param argc Количество аргументов командной строки
  * @param argv Массив аргументов командной строки
- * @return Код завершения программы
+ * @return Код завершения программы: в режиме самотестирования 0 - все проверки пройдены, 1 - есть непройденные проверки
  */
 int main(int argc, char** argv)
 {
-    // Установка локали для поддержки русского языка
-    std::locale::global(std::locale("ru_RU.UTF-8"));
-    std::wcout.imbue(std::locale("ru_RU.UTF-8"));
-    std::wcerr.imbue(std::locale("ru_RU.UTF-8"));
+    // Классы символов нужны шифру; на машинах без русской локали годится любая
+    // локаль UTF-8. Вывод идет в UTF-8 без преобразования потоком
+    try {
+        std::locale::global(std::locale("ru_RU.UTF-8"));
+    } catch (const std::runtime_error&) {
+        try {
+            std::locale::global(std::locale("C.UTF-8"));
+        } catch (const std::runtime_error&) {
+            std::cerr << "ОШИБКА: не найдена локаль ru_RU.UTF-8 или C.UTF-8" << std::endl;
+            return 1;
+        }
+    }
     
-    std::wcout << L" ПРОГРАММА ШИФРОВАНИЯ МЕТОДОМ ГРОНСФЕЛЬДА" << std::endl;
-    std::wcout << std::endl;
+    // Режим шифрования файлов
+    if (argc > 1) {
+        return runFileMode(argc, argv);
+    }
+    
+    std::cout << " ПРОГРАММА ШИФРОВАНИЯ МЕТОДОМ ГРОНСФЕЛЬДА" << std::endl;
+    std::cout << std::endl;
     
     // Демонстрация типов ошибок
     demonstrateErrorTypes();
@@ -160,7 +792,20 @@ int main(int argc, char** argv)
     // Тестируем корректные случаи
     testCorrectCases();
     
-    std::wcout << L"Все тесты завершены." << std::endl;
+    // Сравниваем оптимизированные реализации с эталонными
+    testShiftKernel();
+    testStreamChunks();
+    testParallel();
+    testBatch();
+    testAnalyzer();
+    testTranscoding();
+    
+    std::cout << "Все тесты завершены";
+    if (failedChecks > 0) {
+        std::cout << ", непройденных проверок: " << failedChecks << std::endl;
+        return 1;
+    }
+    std::cout << "." << std::endl;
     
     return 0;
 }
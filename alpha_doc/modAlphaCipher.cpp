@@ -1,8 +1,11 @@
 #include "modAlphaCipher.h"
 #include <locale>
-#include <codecvt>
 #include <iostream>
 #include <cwctype>
+#include <cstring>
+#include <type_traits>
+#include "../common/utf8.h"
+#include "../common/threadPool.h"
 
 /**
  * @file modAlphaCipher.cpp
@@ -10,35 +13,349 @@
  * @details Содержит реализацию всех методов класса modAlphaCipher
  */
 
+namespace {
+
+/**
+ * @brief Источник символов из широкой строки
+ */
+struct WideSource {
+    using Char = wchar_t; ///< Тип символа текста
+    
+    const wchar_t* p; ///< Текущая позиция
+    const wchar_t* end; ///< Конец текста
+    
+    /**
+     * @brief Чтение очередного символа
+     * @param c Прочитанный символ
+     * @return false, если текст закончился
+     */
+    bool next(char32_t& c) {
+        if (p == end) {
+            return false;
+        }
+        c = static_cast<char32_t>(*p++);
+        return true;
+    }
+    
+    /**
+     * @brief Возврат на начало только что прочитанного символа
+     */
+    void unread(char32_t) {
+        --p;
+    }
+};
+
+/**
+ * @brief Источник символов из строки UTF-8
+ * @details Некорректные последовательности возвращаются как utf8Invalid
+ */
+struct Utf8Source {
+    using Char = char; ///< Тип символа текста
+    
+    const char* p; ///< Текущая позиция
+    const char* end; ///< Конец текста
+    
+    /**
+     * @brief Чтение очередного символа
+     * @param c Прочитанный символ
+     * @return false, если текст закончился
+     */
+    bool next(char32_t& c) {
+        if (p == end) {
+            return false;
+        }
+        c = utf8Decode(p, end);
+        return true;
+    }
+    
+    /**
+     * @brief Возврат на начало только что прочитанного символа
+     * @param c Прочитанный символ (для некорректной последовательности был пропущен один байт)
+     */
+    void unread(char32_t c) {
+        p -= (c == utf8Invalid) ? 1 : utf8Length(c);
+    }
+};
+
+/**
+ * @brief Приемник символов в широкую строку
+ */
+struct WideSink {
+    wchar_t* out; ///< Позиция записи
+    
+    /**
+     * @brief Запись символа
+     * @param c Символ алфавита
+     */
+    void put(wchar_t c) {
+        *out++ = c;
+    }
+    
+    /**
+     * @brief Запись символов текста без изменений
+     * @param from Начало символов (может перекрываться с буфером результата)
+     * @param length Количество символов
+     */
+    void copy(const wchar_t* from, std::size_t length) {
+        std::memmove(out, from, length * sizeof(wchar_t));
+        out += length;
+    }
+};
+
+/**
+ * @brief Приемник символов в строку UTF-8
+ */
+struct Utf8Sink {
+    char* out; ///< Позиция записи
+    
+    /**
+     * @brief Запись символа
+     * @param c Символ алфавита
+     */
+    void put(wchar_t c) {
+        out = utf8Encode(static_cast<char32_t>(c), out);
+    }
+    
+    /**
+     * @brief Запись байт текста без изменений
+     * @param from Начало байт (может перекрываться с буфером результата)
+     * @param length Количество байт
+     */
+    void copy(const char* from, std::size_t length) {
+        std::memmove(out, from, length);
+        out += length;
+    }
+};
+
+/// Наибольшее количество отрезков переносимых символов в одном блоке transform()
+constexpr std::size_t maxBlockGaps = 512;
+
+/**
+ * @brief Отрезок символов вне алфавита, переносимых в результат без изменений
+ * @tparam Char Тип символа текста
+ */
+template <class Char>
+struct Gap {
+    std::size_t before; ///< Количество букв блока перед отрезком
+    const Char* from; ///< Начало отрезка в тексте
+    std::size_t length; ///< Длина отрезка
+};
+
+/**
+ * @brief Действие над символом вне алфавита
+ */
+enum class SymbolAction {
+    skip, ///< Символ удаляется
+    keep, ///< Символ переносится в результат без изменений
+    reject ///< Символ недопустим
+};
+
+/**
+ * @brief Проверка, является ли символ буквой какого-либо алфавита
+ * @details Символы до U+07FF проверяются по таблице letterTable без обращения
+ * к локали, остальные - функцией std::iswalpha
+ * @param c Символ
+ * @return true для буквы
+ */
+bool isLetter(char32_t c)
+{
+    return (c < alphabetCodeRange) ? letterTable.letter[c] : (c != utf8Invalid && std::iswalpha(static_cast<wint_t>(c)));
+}
+
+/**
+ * @brief Действие над символом, не входящим в алфавит
+ * @param c Символ
+ * @param policy Режим обработки символов вне алфавита
+ * @return Действие; некорректная последовательность UTF-8 недопустима в любом режиме
+ */
+SymbolAction classify(char32_t c, InputPolicy policy)
+{
+    if (c == utf8Invalid) {
+        return SymbolAction::reject;
+    }
+    switch (policy) {
+        case InputPolicy::strip:
+            return SymbolAction::skip;
+        case InputPolicy::passThrough:
+            return SymbolAction::keep;
+        default:
+            // Пробелы и буквы других алфавитов пропускаются, остальное - ошибка
+            return (c == U' ' || isLetter(c)) ? SymbolAction::skip : SymbolAction::reject;
+    }
+}
+
+/**
+ * @brief Признак ускоренной обработки отрезков ASCII
+ * @tparam Source Источник символов
+ * @param alphabet Алфавит шифра
+ * @return true, если источник - текст UTF-8, а алфавит не содержит символов ASCII:
+ * тогда отрезок ASCII целиком состоит из символов вне алфавита
+ */
+template <class Source>
+bool asciiRuns(const AlphabetTable& alphabet)
+{
+    return std::is_same_v<Source, Utf8Source> && alphabet.minUtf8Length > 1;
+}
+
+/**
+ * @brief Значение результата или исключение с его ошибкой
+ * @param result Результат операции
+ * @param encrypting true - зашифровывание, false - расшифровывание
+ * @return Значение результата
+ * @throw cipher_error Если результат содержит ошибку
+ */
+template <class T>
+T valueOrThrow(CipherResult<T>&& result, bool encrypting)
+{
+    if (!result) {
+        throw modAlphaCipher::makeError(result.error(), encrypting);
+    }
+    return std::move(*result);
+}
+
+} // namespace
+
+/**
+ * @brief Текст сообщения об ошибке
+ * @param code Код ошибки
+ * @param encrypting true - зашифровывание, false - расшифровывание
+ * @return Сообщение об ошибке
+ */
+const char* modAlphaCipher::errorMessage(CipherErrc code, bool encrypting)
+{
+    switch (code) {
+        case CipherErrc::ok:
+            return "";
+        case CipherErrc::emptyKey:
+            return "Пустой ключ! Ключ не может быть пустой строкой.";
+        case CipherErrc::invalidKeySymbol:
+            return "Недопустимый символ в ключе! Ключ должен содержать только буквы.";
+        case CipherErrc::noKeyLetters:
+            return "Ключ не содержит символов алфавита шифра.";
+        case CipherErrc::emptyText:
+            return encrypting ? "Пустой текст для шифрования!"
+                              : "Пустой текст для расшифровки!";
+        case CipherErrc::invalidSymbol:
+            return encrypting ? "Текст содержит недопустимые символы! Разрешены только буквы и пробелы."
+                              : "Зашифрованный текст содержит недопустимые символы!";
+        case CipherErrc::noLetters:
+            return encrypting ? "Текст не содержит символов алфавита шифра после обработки."
+                              : "Зашифрованный текст не содержит символов алфавита шифра.";
+        case CipherErrc::bufferTooSmall:
+            return "Недостаточный размер буфера для результата.";
+        case CipherErrc::inPlaceUnsupported:
+            return encrypting ? "Шифрование на месте невозможно: буквы алфавита имеют разную длину в UTF-8."
+                              : "Расшифровывание на месте невозможно: буквы алфавита имеют разную длину в UTF-8.";
+        case CipherErrc::invalidBatchOffsets:
+            return "Некорректные смещения сообщений пакета.";
+        case CipherErrc::ioError:
+            return "Ошибка чтения файла.";
+        default:
+            return "Неизвестная ошибка шифрования.";
+    }
+}
+
+/**
+ * @brief Исключение для ошибки
+ * @param error Описание ошибки
+ * @param encrypting true - зашифровывание, false - расшифровывание
+ * @return Исключение с сообщением и кодом ошибки
+ */
+cipher_error modAlphaCipher::makeError(CipherError error, bool encrypting)
+{
+    return cipher_error(errorMessage(error.code, encrypting), error);
+}
+
 /**
  * @brief Конструктор для установки ключа
  * @param skey Ключ шифрования
+ * @param alpha Алфавит шифра
  * @throw cipher_error Если ключ пустой или содержит недопустимые символы
  */
-modAlphaCipher::modAlphaCipher(const std::wstring& skey)
+modAlphaCipher::modAlphaCipher(const std::wstring& skey, const AlphabetTable& alpha)
+    : alphabet(&alpha)
+{
+    CipherError error = parseKey(skey, alpha, key);
+    if (error) {
+        throw makeError(error, true);
+    }
+    expandKey();
+}
+
+/**
+ * @brief Конструктор по проверенному ключу
+ * @param numericKey Ключ в числовом виде (не пустой)
+ * @param alpha Алфавит шифра
+ */
+modAlphaCipher::modAlphaCipher(std::vector<int> numericKey, const AlphabetTable& alpha)
+    : alphabet(&alpha), key(std::move(numericKey))
+{
+    expandKey();
+}
+
+/**
+ * @brief Создание шифра без исключений
+ * @param skey Ключ шифрования
+ * @param alpha Алфавит шифра
+ * @return Шифр или ошибка ключа с позицией недопустимого символа
+ */
+CipherResult<modAlphaCipher> modAlphaCipher::create(const std::wstring& skey, const AlphabetTable& alpha)
+{
+    std::vector<int> numericKey;
+    CipherError error = parseKey(skey, alpha, numericKey);
+    if (error) {
+        return error;
+    }
+    return modAlphaCipher(std::move(numericKey), alpha);
+}
+
+/**
+ * @brief Проверка ключа и перевод его в числовой вид
+ * @param skey Ключ шифрования
+ * @param alpha Алфавит шифра
+ * @param numericKey Ключ в числовом виде
+ * @return Ошибка ключа (код CipherErrc::ok, если ключ корректен)
+ * @details Буквы алфавита переводятся в номера, буквы других алфавитов пропускаются
+ */
+CipherError modAlphaCipher::parseKey(const std::wstring& skey, const AlphabetTable& alpha, std::vector<int>& numericKey)
 {
     // Проверка ключа на пустоту
     if (skey.empty()) {
-        throw cipher_error("Пустой ключ! Ключ не может быть пустой строкой.");
+        return {CipherErrc::emptyKey, 0};
     }
     
-    // Проверка ключа на допустимые символы
-    for (wchar_t c : skey) {
-        if (!std::iswalpha(c)) {
-            throw cipher_error("Недопустимый символ в ключе! Ключ должен содержать только буквы.");
+    // Проверка ключа на допустимые символы и перевод в числовой вид за один проход
+    numericKey.reserve(skey.size());
+    for (std::size_t i = 0; i < skey.size(); i++) {
+        const wchar_t c = skey[i];
+        int idx = (static_cast<unsigned long>(c) < alphabetCodeRange) ? alpha.index[c] : -1;
+        if (idx >= 0) {
+            numericKey.push_back(idx);
+        } else if (!isLetter(static_cast<char32_t>(c))) {
+            return {CipherErrc::invalidKeySymbol, i};
         }
     }
     
-    // Инициализация алфавита
-    for(unsigned i = 0; i < numAlpha.size(); i++) {
-        alphaNum[numAlpha[i]] = i;
-    }
-    
-    key = convert(toUpper(skey));
-    
     // Проверка результата конвертации ключа
-    if (key.empty()) {
-        throw cipher_error("Ключ не содержит допустимых символов русского алфавита.");
+    if (numericKey.empty()) {
+        return {CipherErrc::noKeyLetters, 0};
+    }
+    return {};
+}
+
+/**
+ * @brief Развертывание ключа в таблицы сдвигов
+ */
+void modAlphaCipher::expandKey()
+{
+    // Развертывание ключа: сдвиг для любого блока начинается с позиции k < key.size()
+    const std::size_t streamLength = key.size() + kernelBlockSize;
+    encryptShift.resize(streamLength);
+    decryptShift.resize(streamLength);
+    for (std::size_t i = 0; i < streamLength; i++) {
+        int k = key[i % key.size()];
+        decryptShift[i] = static_cast<unsigned char>(k);
+        encryptShift[i] = static_cast<unsigned char>((alphabet->size - k) % alphabet->size);
     }
 }
 
@@ -50,125 +367,778 @@ modAlphaCipher::modAlphaCipher(const std::wstring& skey)
  */
 std::wstring modAlphaCipher::encrypt(const std::wstring& open_text)
 {
-    // Проверка входного текста
-    if (open_text.empty()) {
-        throw cipher_error("Пустой текст для шифрования!");
+    return valueOrThrow(transformWide(open_text, true), true);
+}
+
+/**
+ * @brief Расшифровывание текста
+ * @param cipher_text Зашифрованный текст
+ * @return Расшифрованная строка
+ * @throw cipher_error Если текст пустой или содержит недопустимые символы
+ */
+std::wstring modAlphaCipher::decrypt(const std::wstring& cipher_text)
+{
+    return valueOrThrow(transformWide(cipher_text, false), false);
+}
+
+/**
+ * @brief Зашифровывание текста в кодировке UTF-8
+ * @param open_text Открытый текст в кодировке UTF-8
+ * @return Зашифрованная строка в кодировке UTF-8
+ * @throw cipher_error Если текст пустой или содержит недопустимые символы
+ */
+std::string modAlphaCipher::encrypt(std::string_view open_text)
+{
+    return valueOrThrow(transformUtf8(open_text, true), true);
+}
+
+/**
+ * @brief Расшифровывание текста в кодировке UTF-8
+ * @param cipher_text Зашифрованный текст в кодировке UTF-8
+ * @return Расшифрованная строка в кодировке UTF-8
+ * @throw cipher_error Если текст пустой или содержит недопустимые символы
+ */
+std::string modAlphaCipher::decrypt(std::string_view cipher_text)
+{
+    return valueOrThrow(transformUtf8(cipher_text, false), false);
+}
+
+/**
+ * @brief Зашифровывание текста без исключений
+ * @param open_text Открытый текст
+ * @return Зашифрованная строка или ошибка
+ */
+CipherResult<std::wstring> modAlphaCipher::tryEncrypt(const std::wstring& open_text) const
+{
+    return transformWide(open_text, true);
+}
+
+/**
+ * @brief Расшифровывание текста без исключений
+ * @param cipher_text Зашифрованный текст
+ * @return Расшифрованная строка или ошибка
+ */
+CipherResult<std::wstring> modAlphaCipher::tryDecrypt(const std::wstring& cipher_text) const
+{
+    return transformWide(cipher_text, false);
+}
+
+/**
+ * @brief Зашифровывание текста UTF-8 без исключений
+ * @param open_text Открытый текст в кодировке UTF-8
+ * @return Зашифрованная строка или ошибка
+ */
+CipherResult<std::string> modAlphaCipher::tryEncrypt(std::string_view open_text) const
+{
+    return transformUtf8(open_text, true);
+}
+
+/**
+ * @brief Расшифровывание текста UTF-8 без исключений
+ * @param cipher_text Зашифрованный текст в кодировке UTF-8
+ * @return Расшифрованная строка или ошибка
+ */
+CipherResult<std::string> modAlphaCipher::tryDecrypt(std::string_view cipher_text) const
+{
+    return transformUtf8(cipher_text, false);
+}
+
+/**
+ * @brief Однопроходное зашифровывание или расшифровывание текста
+ * @param source Источник символов
+ * @param sink Приемник символов
+ * @param encrypting true - зашифровывание, false - расшифровывание
+ * @param keyPos Позиция в ключе для первого символа; на выходе - для следующего
+ * @return Количество записанных букв алфавита или ошибка CipherErrc::invalidSymbol
+ * с позицией символа относительно начала источника
+ * @details Символы алфавита (в любом регистре) сдвигаются на очередную цифру ключа,
+ * остальные символы удаляются, переносятся без изменений или прекращают обработку
+ * согласно policy; ключ на них не сдвигается.
+ * Сдвиг выполняется векторным ядром shiftIndices() блоками по kernelBlockSize символов,
+ * поэтому промежуточные номера символов не выходят за пределы кэша.
+ * Переносимые символы запоминаются отрезками исходного текста и вставляются
+ * между буквами блока при записи результата.
+ * Если алфавит не содержит символов ASCII, отрезки ASCII в тексте UTF-8
+ * (пробелы, знаки препинания, цифры) проверяются целиком ядром scanAscii().
+ */
+template <class Source, class Sink>
+CipherResult<std::size_t> modAlphaCipher::transform(Source source, Sink& sink, bool encrypting, std::size_t& keyPos) const
+{
+    using Char = typename Source::Char;
+    const Char* start = source.p;
+    const unsigned char* shift = encrypting ? encryptShift.data() : decryptShift.data();
+    const unsigned char modulus = static_cast<unsigned char>(alphabet->size); // 256 -> 0
+    const std::size_t keyLength = key.size();
+    const bool runs = asciiRuns<Source>(*alphabet);
+    unsigned char block[kernelBlockSize];
+    Gap<Char> gaps[maxBlockGaps];
+    std::size_t count = 0;
+    std::size_t k = keyPos;
+    
+    while (source.p != source.end) {
+        // Проверка символов и перевод в номера алфавита
+        std::size_t filled = 0;
+        std::size_t gapCount = 0;
+        auto keep = [&](const Char* from, std::size_t length) {
+            if (gapCount > 0 && gaps[gapCount - 1].before == filled &&
+                gaps[gapCount - 1].from + gaps[gapCount - 1].length == from) {
+                gaps[gapCount - 1].length += length;
+            } else {
+                gaps[gapCount++] = Gap<Char>{filled, from, length};
+            }
+        };
+        while (filled < kernelBlockSize && gapCount < maxBlockGaps && source.p != source.end) {
+            const Char* at = source.p;
+            if (runs && static_cast<unsigned char>(*at) < 0x80) {
+                std::size_t other;
+                const std::size_t run = scanAscii(reinterpret_cast<const unsigned char*>(at),
+                                                  static_cast<std::size_t>(source.end - at), other);
+                if (policy == InputPolicy::strict && other < run) {
+                    return CipherResult<std::size_t>(CipherErrc::invalidSymbol, static_cast<std::size_t>(at - start) + other);
+                }
+                if (policy == InputPolicy::passThrough) {
+                    keep(at, run);
+                }
+                source.p += run;
+                continue;
+            }
+            char32_t c;
+            source.next(c);
+            int idx = (c < alphabetCodeRange) ? alphabet->index[c] : -1;
+            if (idx >= 0) {
+                block[filled++] = static_cast<unsigned char>(idx);
+                continue;
+            }
+            switch (classify(c, policy)) {
+                case SymbolAction::reject:
+                    source.unread(c);
+                    return CipherResult<std::size_t>(CipherErrc::invalidSymbol, static_cast<std::size_t>(source.p - start));
+                case SymbolAction::keep:
+                    keep(at, static_cast<std::size_t>(source.p - at));
+                    break;
+                case SymbolAction::skip:
+                    break;
+            }
+        }
+        
+        // Сдвиг блока и запись результата
+        shiftIndices(block, shift + k, filled, modulus);
+        std::size_t i = 0;
+        for (std::size_t g = 0; g < gapCount; g++) {
+            for (; i < gaps[g].before; i++) {
+                sink.put(alphabet->symbols[block[i]]);
+            }
+            sink.copy(gaps[g].from, gaps[g].length);
+        }
+        for (; i < filled; i++) {
+            sink.put(alphabet->symbols[block[i]]);
+        }
+        count += filled;
+        k = (k + filled) % keyLength;
     }
     
-    // Проверка символов текста
-    for (wchar_t c : open_text) {
-        if (!std::iswalpha(c) && c != L' ') {
-            throw cipher_error("Текст содержит недопустимые символы! Разрешены только буквы и пробелы.");
+    keyPos = k;
+    return count;
+}
+
+/**
+ * @brief Проверка текста и подсчет букв алфавита
+ * @param source Источник символов
+ * @return Количество букв алфавита или ошибка CipherErrc::invalidSymbol
+ * с позицией символа относительно начала источника
+ */
+template <class Source>
+CipherResult<std::size_t> modAlphaCipher::countLetters(Source source) const
+{
+    const auto* start = source.p;
+    const bool runs = asciiRuns<Source>(*alphabet);
+    std::size_t count = 0;
+    while (source.p != source.end) {
+        if (runs && static_cast<unsigned char>(*source.p) < 0x80) {
+            std::size_t other;
+            const std::size_t run = scanAscii(reinterpret_cast<const unsigned char*>(source.p),
+                                              static_cast<std::size_t>(source.end - source.p), other);
+            if (policy == InputPolicy::strict && other < run) {
+                return CipherResult<std::size_t>(CipherErrc::invalidSymbol, static_cast<std::size_t>(source.p - start) + other);
+            }
+            source.p += run;
+            continue;
+        }
+        char32_t c;
+        source.next(c);
+        if (c < alphabetCodeRange && alphabet->index[c] >= 0) {
+            count++;
+        } else if (classify(c, policy) == SymbolAction::reject) {
+            source.unread(c);
+            return CipherResult<std::size_t>(CipherErrc::invalidSymbol, static_cast<std::size_t>(source.p - start));
         }
     }
+    return count;
+}
+
+/**
+ * @brief Параллельный подсчет букв в частях текста
+ * @param parts Части текста, идущие подряд
+ * @param offsets Количество букв перед началом каждой части; последний элемент - общее количество
+ * @return Первая по тексту ошибка (позиция отсчитывается от начала первой части)
+ */
+template <class Source>
+CipherError modAlphaCipher::letterOffsets(const std::vector<Source>& parts, std::vector<std::size_t>& offsets) const
+{
+    offsets.assign(parts.size() + 1, 0);
+    std::vector<CipherError> errors(parts.size());
+    pool->run(parts.size(), [&](std::size_t i) {
+        CipherResult<std::size_t> count = countLetters(parts[i]);
+        if (count) {
+            offsets[i + 1] = *count;
+        } else {
+            errors[i] = count.error();
+        }
+    });
+    for (std::size_t i = 0; i < parts.size(); i++) {
+        if (errors[i]) {
+            errors[i].offset += static_cast<std::size_t>(parts[i].p - parts[0].p);
+            return errors[i];
+        }
+        offsets[i + 1] += offsets[i];
+    }
+    return {};
+}
+
+/**
+ * @brief Количество частей для параллельной обработки текста
+ * @param length Длина текста (символов или байт)
+ * @return Количество частей; 1 означает последовательную обработку
+ */
+std::size_t modAlphaCipher::parallelParts(std::size_t length) const
+{
+    if (!pool) {
+        return 1;
+    }
+    std::size_t parts = length / parallelMinChunk;
+    if (parts > pool->size()) {
+        parts = pool->size();
+    }
+    return parts > 1 ? parts : 1;
+}
+
+/**
+ * @brief Включение параллельного режима
+ * @param workers Количество потоков; 0 или 1 - последовательный режим
+ * @param minChunkSize Наименьший фрагмент текста (символов или байт UTF-8) на один поток
+ */
+void modAlphaCipher::setParallelism(std::size_t workers, std::size_t minChunkSize)
+{
+    pool = (workers > 1) ? std::make_shared<ThreadPool>(workers) : nullptr;
+    parallelMinChunk = (minChunkSize > 0) ? minChunkSize : 1;
+}
+
+/**
+ * @brief Зашифровывание или расшифровывание широкой строки
+ * @param text Исходный текст
+ * @param encrypting true - зашифровывание, false - расшифровывание
+ * @return Результирующая строка или ошибка
+ * @details Результат не длиннее исходного текста, поэтому записывается
+ * в строку, выделенную один раз
+ */
+CipherResult<std::wstring> modAlphaCipher::transformWide(const std::wstring& text, bool encrypting) const
+{
+    if (text.empty()) {
+        return CipherErrc::emptyText;
+    }
     
-    std::wstring text = toUpper(open_text);
-    std::vector<int> work = convert(text);
+    const std::size_t parts = parallelParts(text.size());
+    if (parts > 1) {
+        return transformWideParallel(text, encrypting, parts);
+    }
     
-    // Проверка результата конвертации
-    if (work.empty()) {
-        throw cipher_error("Текст не содержит символов русского алфавита после обработки.");
+    std::wstring result(requiredOutputSize(text.size()), L'\0');
+    CipherResult<std::size_t> written = wideInto(text.data(), text.size(), &result[0], result.size(), encrypting);
+    if (!written) {
+        return written.error();
+    }
+    result.resize(*written);
+    return result;
+}
+
+/**
+ * @brief Параллельное зашифровывание или расшифровывание широкой строки
+ * @param text Исходный текст
+ * @param encrypting true - зашифровывание, false - расшифровывание
+ * @param parts Количество частей
+ * @return Результирующая строка или ошибка
+ * @details Ключ сдвигается только на буквах алфавита, поэтому сначала параллельно
+ * подсчитываются буквы в каждой части. Часть, перед которой стоят n букв,
+ * начинается с позиции ключа n % key.size() и пишет результат с позиции n.
+ * В режиме InputPolicy::passThrough результат совпадает с текстом по длине,
+ * и часть пишет результат с позиции своего начала в тексте.
+ */
+CipherResult<std::wstring> modAlphaCipher::transformWideParallel(const std::wstring& text, bool encrypting, std::size_t parts) const
+{
+    std::vector<WideSource> sources(parts);
+    for (std::size_t i = 0; i < parts; i++) {
+        sources[i] = WideSource{text.data() + text.size() * i / parts,
+                                text.data() + text.size() * (i + 1) / parts};
     }
     
-    // Шифрование
-    for(unsigned i = 0; i < work.size(); i++) {
-        work[i] = (work[i] + key[i % key.size()]) % alphaNum.size();
-        // Дополнительная проверка на корректность индекса
-        if (work[i] < 0 || work[i] >= static_cast<int>(alphaNum.size())) {
-            throw cipher_error("Ошибка при шифровании: некорректный индекс символа.");
-        }
+    std::vector<std::size_t> offsets;
+    CipherError error = letterOffsets(sources, offsets);
+    if (error) {
+        return error;
+    }
+    const bool passThrough = (policy == InputPolicy::passThrough);
+    if (offsets.back() == 0 && !passThrough) {
+        return CipherErrc::noLetters;
     }
     
-    return convert(work);
+    std::wstring result(passThrough ? text.size() : offsets.back(), L'\0');
+    wchar_t* out = &result[0];
+    pool->run(parts, [&](std::size_t i) {
+        WideSink sink{out + (passThrough ? static_cast<std::size_t>(sources[i].p - text.data()) : offsets[i])};
+        std::size_t keyPos = offsets[i] % key.size();
+        transform(sources[i], sink, encrypting, keyPos);
+    });
+    return result;
 }
 
 /**
- * @brief Расшифровывание текста
- * @param cipher_text Зашифрованный текст
- * @return Расшифрованная строка
- * @throw cipher_error Если текст пустой или содержит недопустимые символы
+ * @brief Зашифровывание или расшифровывание строки UTF-8
+ * @param text Исходный текст в кодировке UTF-8
+ * @param encrypting true - зашифровывание, false - расшифровывание
+ * @return Результирующая строка в кодировке UTF-8 или ошибка
  */
-std::wstring modAlphaCipher::decrypt(const std::wstring& cipher_text)
+CipherResult<std::string> modAlphaCipher::transformUtf8(std::string_view text, bool encrypting) const
 {
-    // Проверка зашифрованного текста
-    if (cipher_text.empty()) {
-        throw cipher_error("Пустой текст для расшифровки!");
+    if (text.empty()) {
+        return CipherErrc::emptyText;
+    }
+    
+    const std::size_t parts = parallelParts(text.size());
+    if (parts > 1) {
+        return transformUtf8Parallel(text, encrypting, parts);
     }
     
-    // Проверка символов зашифрованного текста
-    for (wchar_t c : cipher_text) {
-        if (!std::iswalpha(c) && c != L' ') {
-            throw cipher_error("Зашифрованный текст содержит недопустимые символы!");
+    std::string result(requiredUtf8OutputSize(text.size()), '\0');
+    CipherResult<std::size_t> written = utf8Into(text, &result[0], result.size(), encrypting);
+    if (!written) {
+        return written.error();
+    }
+    result.resize(*written);
+    return result;
+}
+
+/**
+ * @brief Параллельное зашифровывание или расшифровывание строки UTF-8
+ * @param text Исходный текст в кодировке UTF-8
+ * @param encrypting true - зашифровывание, false - расшифровывание
+ * @param parts Количество частей
+ * @return Результирующая строка в кодировке UTF-8 или ошибка
+ * @details Границы частей сдвигаются на начало ближайшего символа UTF-8.
+ * Если все буквы алфавита имеют одинаковую длину в UTF-8, части пишут результат
+ * прямо на свои места (в режиме InputPolicy::passThrough - с позиции своего начала
+ * в тексте), иначе результаты частей склеиваются после обработки.
+ */
+CipherResult<std::string> modAlphaCipher::transformUtf8Parallel(std::string_view text, bool encrypting, std::size_t parts) const
+{
+    std::vector<Utf8Source> sources(parts);
+    const char* begin = text.data();
+    const char* end = begin + text.size();
+    const char* from = begin;
+    for (std::size_t i = 0; i < parts; i++) {
+        const char* to = begin + text.size() * (i + 1) / parts;
+        while (to < end && (static_cast<unsigned char>(*to) & 0xC0) == 0x80) {
+            ++to;
         }
+        sources[i] = Utf8Source{from, to};
+        from = to;
     }
     
-    std::wstring text = toUpper(cipher_text);
-    std::vector<int> work = convert(text);
+    std::vector<std::size_t> offsets;
+    CipherError error = letterOffsets(sources, offsets);
+    if (error) {
+        return error;
+    }
+    const bool passThrough = (policy == InputPolicy::passThrough);
+    if (offsets.back() == 0 && !passThrough) {
+        return CipherErrc::noLetters;
+    }
     
-    // Проверка результата конвертации
-    if (work.empty()) {
-        throw cipher_error("Зашифрованный текст не содержит символов русского алфавита.");
+    if (alphabet->minUtf8Length == alphabet->maxUtf8Length) {
+        const std::size_t width = alphabet->maxUtf8Length;
+        std::string result(passThrough ? text.size() : offsets.back() * width, '\0');
+        char* out = &result[0];
+        pool->run(parts, [&](std::size_t i) {
+            Utf8Sink sink{out + (passThrough ? static_cast<std::size_t>(sources[i].p - begin) : offsets[i] * width)};
+            std::size_t keyPos = offsets[i] % key.size();
+            transform(sources[i], sink, encrypting, keyPos);
+        });
+        return result;
     }
     
-    // Расшифрование
-    for(unsigned i = 0; i < work.size(); i++) {
-        work[i] = (work[i] + alphaNum.size() - key[i % key.size()]) % alphaNum.size();
-        // Дополнительная проверка на корректность индекса
-        if (work[i] < 0 || work[i] >= static_cast<int>(alphaNum.size())) {
-            throw cipher_error("Ошибка при расшифровке: некорректный индекс символа.");
-        }
+    std::vector<std::string> pieces(parts);
+    pool->run(parts, [&](std::size_t i) {
+        std::size_t keyPos = offsets[i] % key.size();
+        appendUtf8(std::string_view(sources[i].p, static_cast<std::size_t>(sources[i].end - sources[i].p)),
+                   pieces[i], encrypting, keyPos);
+    });
+    std::string result;
+    result.reserve(text.size() * alphabet->maxUtf8Length / alphabet->minUtf8Length);
+    for (const std::string& piece : pieces) {
+        result += piece;
+    }
+    return result;
+}
+
+/**
+ * @brief Зашифровывание или расшифровывание фрагмента UTF-8 с дописыванием в конец строки
+ * @param text Фрагмент текста в кодировке UTF-8
+ * @param out Строка, в конец которой дописывается результат
+ * @param encrypting true - зашифровывание, false - расшифровывание
+ * @param keyPos Позиция в ключе для первого символа; на выходе - для следующего
+ * @return Количество записанных букв алфавита или ошибка
+ */
+CipherResult<std::size_t> modAlphaCipher::appendUtf8(std::string_view text, std::string& out, bool encrypting, std::size_t& keyPos) const
+{
+    const std::size_t start = out.size();
+    out.resize(start + requiredUtf8OutputSize(text.size()));
+    char* end = &out[0] + start;
+    CipherResult<std::size_t> count = writeUtf8(text, end, encrypting, keyPos);
+    out.resize(static_cast<std::size_t>(end - out.data()));
+    return count;
+}
+
+/**
+ * @brief Зашифровывание или расшифровывание фрагмента UTF-8 в буфер вызывающей стороны
+ * @param text Фрагмент текста в кодировке UTF-8
+ * @param out Позиция записи; на выходе - позиция сразу после записанного результата
+ * @param encrypting true - зашифровывание, false - расшифровывание
+ * @param keyPos Позиция в ключе для первого символа; на выходе - для следующего
+ * @return Количество записанных букв алфавита или ошибка
+ */
+CipherResult<std::size_t> modAlphaCipher::writeUtf8(std::string_view text, char*& out, bool encrypting, std::size_t& keyPos) const
+{
+    Utf8Sink sink{out};
+    CipherResult<std::size_t> count = transform(Utf8Source{text.data(), text.data() + text.size()}, sink, encrypting, keyPos);
+    out = sink.out;
+    return count;
+}
+
+/**
+ * @brief Зашифровывание или расшифровывание широкой строки в буфер вызывающей стороны
+ * @param text Исходный текст
+ * @param length Длина текста
+ * @param out Буфер результата (может совпадать с text)
+ * @param capacity Размер буфера результата
+ * @param encrypting true - зашифровывание, false - расшифровывание
+ * @return Количество записанных символов или ошибка
+ * @details Запись на месте безопасна: transform() пишет символ результата
+ * только после чтения соответствующего символа текста
+ */
+CipherResult<std::size_t> modAlphaCipher::wideInto(const wchar_t* text, std::size_t length, wchar_t* out, std::size_t capacity, bool encrypting) const
+{
+    if (length == 0) {
+        return CipherErrc::emptyText;
+    }
+    if (capacity < requiredOutputSize(length)) {
+        return CipherErrc::bufferTooSmall;
     }
     
-    return convert(work);
+    WideSink sink{out};
+    std::size_t keyPos = 0;
+    CipherResult<std::size_t> count = transform(WideSource{text, text + length}, sink, encrypting, keyPos);
+    if (!count) {
+        return count;
+    }
+    if (*count == 0 && policy != InputPolicy::passThrough) {
+        return CipherErrc::noLetters;
+    }
+    return static_cast<std::size_t>(sink.out - out);
 }
 
 /**
- * @brief Преобразование строки в числовой вектор
- * @param s Исходная строка
- * @return Вектор числовых представлений символов
+ * @brief Зашифровывание или расшифровывание строки UTF-8 в буфер вызывающей стороны
+ * @param text Исходный текст в кодировке UTF-8
+ * @param out Буфер результата
+ * @param capacity Размер буфера результата в байтах
+ * @param encrypting true - зашифровывание, false - расшифровывание
+ * @return Количество записанных байт или ошибка
  */
-std::vector<int> modAlphaCipher::convert(const std::wstring& s)
+CipherResult<std::size_t> modAlphaCipher::utf8Into(std::string_view text, char* out, std::size_t capacity, bool encrypting) const
 {
-    std::vector<int> result;
-    for(auto c : s) {
-        auto it = alphaNum.find(c);
-        if (it != alphaNum.end()) {
-            result.push_back(it->second);
-        }
+    if (text.empty()) {
+        return CipherErrc::emptyText;
     }
-    return result;
+    if (capacity < requiredUtf8OutputSize(text.size())) {
+        return CipherErrc::bufferTooSmall;
+    }
+    
+    char* end = out;
+    std::size_t keyPos = 0;
+    CipherResult<std::size_t> count = writeUtf8(text, end, encrypting, keyPos);
+    if (!count) {
+        return count;
+    }
+    if (*count == 0 && policy != InputPolicy::passThrough) {
+        return CipherErrc::noLetters;
+    }
+    return static_cast<std::size_t>(end - out);
 }
 
 /**
- * @brief Преобразование числового вектора в строку
- * @param v Вектор числовых представлений
- * @return Результирующая строка
- * @throw cipher_error Если индекс выходит за границы алфавита
+ * @brief Зашифровывание в буфер вызывающей стороны
+ * @param open_text Открытый текст
+ * @param length Длина текста в символах
+ * @param out Буфер результата
+ * @param capacity Размер буфера
+ * @return Количество записанных символов
+ * @throw cipher_error При некорректных данных или слишком малом буфере
  */
-std::wstring modAlphaCipher::convert(const std::vector<int>& v)
+std::size_t modAlphaCipher::encryptInto(const wchar_t* open_text, std::size_t length, wchar_t* out, std::size_t capacity) const
 {
-    std::wstring result;
-    for(auto i : v) {
-        if (i < 0 || i >= static_cast<int>(numAlpha.size())) {
-            throw cipher_error("Индекс символа выходит за границы алфавита.");
-        }
-        result.push_back(numAlpha[i]);
+    return valueOrThrow(wideInto(open_text, length, out, capacity, true), true);
+}
+
+/**
+ * @brief Расшифровывание в буфер вызывающей стороны
+ * @param cipher_text Зашифрованный текст
+ * @param length Длина текста в символах
+ * @param out Буфер результата
+ * @param capacity Размер буфера
+ * @return Количество записанных символов
+ * @throw cipher_error При некорректных данных или слишком малом буфере
+ */
+std::size_t modAlphaCipher::decryptInto(const wchar_t* cipher_text, std::size_t length, wchar_t* out, std::size_t capacity) const
+{
+    return valueOrThrow(wideInto(cipher_text, length, out, capacity, false), false);
+}
+
+/**
+ * @brief Зашифровывание текста UTF-8 в буфер вызывающей стороны
+ * @param open_text Открытый текст в кодировке UTF-8
+ * @param out Буфер результата
+ * @param capacity Размер буфера в байтах
+ * @return Количество записанных байт
+ * @throw cipher_error При некорректных данных или слишком малом буфере
+ */
+std::size_t modAlphaCipher::encryptInto(std::string_view open_text, char* out, std::size_t capacity) const
+{
+    return valueOrThrow(utf8Into(open_text, out, capacity, true), true);
+}
+
+/**
+ * @brief Расшифровывание текста UTF-8 в буфер вызывающей стороны
+ * @param cipher_text Зашифрованный текст в кодировке UTF-8
+ * @param out Буфер результата
+ * @param capacity Размер буфера в байтах
+ * @return Количество записанных байт
+ * @throw cipher_error При некорректных данных или слишком малом буфере
+ */
+std::size_t modAlphaCipher::decryptInto(std::string_view cipher_text, char* out, std::size_t capacity) const
+{
+    return valueOrThrow(utf8Into(cipher_text, out, capacity, false), false);
+}
+
+/**
+ * @brief Зашифровывание на месте
+ * @param text Текст; на выходе - зашифрованный текст
+ * @param length Длина текста в символах
+ * @return Длина зашифрованного текста
+ * @throw cipher_error При некорректных данных
+ */
+std::size_t modAlphaCipher::encryptInPlace(wchar_t* text, std::size_t length) const
+{
+    return valueOrThrow(wideInto(text, length, text, length, true), true);
+}
+
+/**
+ * @brief Расшифровывание на месте
+ * @param text Текст; на выходе - расшифрованный текст
+ * @param length Длина текста в символах
+ * @return Длина расшифрованного текста
+ * @throw cipher_error При некорректных данных
+ */
+std::size_t modAlphaCipher::decryptInPlace(wchar_t* text, std::size_t length) const
+{
+    return valueOrThrow(wideInto(text, length, text, length, false), false);
+}
+
+/**
+ * @brief Зашифровывание текста UTF-8 на месте
+ * @param text Текст в кодировке UTF-8; на выходе - зашифрованный текст
+ * @param size Длина текста в байтах
+ * @return Длина зашифрованного текста в байтах
+ * @throw cipher_error При некорректных данных или буквах алфавита разной длины
+ * @details При одинаковой длине букв каждая буква результата занимает столько же байт,
+ * сколько буква текста, поэтому запись не обгоняет чтение
+ */
+std::size_t modAlphaCipher::encryptInPlace(char* text, std::size_t size) const
+{
+    if (alphabet->minUtf8Length != alphabet->maxUtf8Length) {
+        throw makeError({CipherErrc::inPlaceUnsupported, 0}, true);
     }
-    return result;
+    return valueOrThrow(utf8Into(std::string_view(text, size), text, size, true), true);
+}
+
+/**
+ * @brief Расшифровывание текста UTF-8 на месте
+ * @param text Текст в кодировке UTF-8; на выходе - расшифрованный текст
+ * @param size Длина текста в байтах
+ * @return Длина расшифрованного текста в байтах
+ * @throw cipher_error При некорректных данных или буквах алфавита разной длины
+ */
+std::size_t modAlphaCipher::decryptInPlace(char* text, std::size_t size) const
+{
+    if (alphabet->minUtf8Length != alphabet->maxUtf8Length) {
+        throw makeError({CipherErrc::inPlaceUnsupported, 0}, false);
+    }
+    return valueOrThrow(utf8Into(std::string_view(text, size), text, size, false), false);
+}
+
+/**
+ * @brief Зашифровывание в буфер вызывающей стороны без исключений
+ * @param open_text Открытый текст
+ * @param length Длина текста в символах
+ * @param out Буфер результата
+ * @param capacity Размер буфера
+ * @return Количество записанных символов или ошибка
+ */
+CipherResult<std::size_t> modAlphaCipher::tryEncryptInto(const wchar_t* open_text, std::size_t length, wchar_t* out, std::size_t capacity) const
+{
+    return wideInto(open_text, length, out, capacity, true);
 }
 
 /**
- * @brief Приведение строки к верхнему регистру
- * @param s Исходная строка
- * @return Строка в верхнем регистре
+ * @brief Расшифровывание в буфер вызывающей стороны без исключений
+ * @param cipher_text Зашифрованный текст
+ * @param length Длина текста в символах
+ * @param out Буфер результата
+ * @param capacity Размер буфера
+ * @return Количество записанных символов или ошибка
+ */
+CipherResult<std::size_t> modAlphaCipher::tryDecryptInto(const wchar_t* cipher_text, std::size_t length, wchar_t* out, std::size_t capacity) const
+{
+    return wideInto(cipher_text, length, out, capacity, false);
+}
+
+/**
+ * @brief Зашифровывание текста UTF-8 в буфер вызывающей стороны без исключений
+ * @param open_text Открытый текст в кодировке UTF-8
+ * @param out Буфер результата
+ * @param capacity Размер буфера в байтах
+ * @return Количество записанных байт или ошибка
+ */
+CipherResult<std::size_t> modAlphaCipher::tryEncryptInto(std::string_view open_text, char* out, std::size_t capacity) const
+{
+    return utf8Into(open_text, out, capacity, true);
+}
+
+/**
+ * @brief Расшифровывание текста UTF-8 в буфер вызывающей стороны без исключений
+ * @param cipher_text Зашифрованный текст в кодировке UTF-8
+ * @param out Буфер результата
+ * @param capacity Размер буфера в байтах
+ * @return Количество записанных байт или ошибка
  */
-std::wstring modAlphaCipher::toUpper(const std::wstring& s)
+CipherResult<std::size_t> modAlphaCipher::tryDecryptInto(std::string_view cipher_text, char* out, std::size_t capacity) const
 {
-    std::wstring result;
-    std::locale loc("ru_RU.UTF-8");
+    return utf8Into(cipher_text, out, capacity, false);
+}
+
+/**
+ * @brief Пакетное зашифровывание или расшифровывание
+ * @param messages Арена сообщений
+ * @param offsets Смещения сообщений в арене
+ * @param encrypting true - зашифровывание, false - расшифровывание
+ * @return Результаты и ошибки по сообщениям
+ * @throw cipher_error Если смещения некорректны
+ * @details Арена результатов выделяется один раз по суммарной длине сообщений;
+ * результат каждого сообщения пишется сразу за предыдущим
+ */
+template <class Char>
+BatchResult<Char> modAlphaCipher::transformBatch(std::basic_string_view<Char> messages, const std::vector<std::size_t>& offsets, bool encrypting) const
+{
+    if (!batchOffsetsValid(offsets, messages.size())) {
+        throw makeError({CipherErrc::invalidBatchOffsets, 0}, encrypting);
+    }
     
-    for(auto c : s) {
-        result.push_back(std::toupper(c, loc));
+    const std::size_t count = offsets.size() - 1;
+    BatchResult<Char> result;
+    result.offsets.resize(count + 1);
+    result.errors.resize(count);
+    if constexpr (std::is_same_v<Char, wchar_t>) {
+        result.data.resize(requiredOutputSize(messages.size()));
+    } else {
+        result.data.resize(requiredUtf8OutputSize(messages.size()));
     }
+    
+    Char* out = &result.data[0];
+    std::size_t written = 0;
+    for (std::size_t i = 0; i < count; i++) {
+        result.offsets[i] = written;
+        std::basic_string_view<Char> text = messages.substr(offsets[i], offsets[i + 1] - offsets[i]);
+        CipherResult<std::size_t> produced = [&] {
+            if constexpr (std::is_same_v<Char, wchar_t>) {
+                return wideInto(text.data(), text.size(), out + written, result.data.size() - written, encrypting);
+            } else {
+                return utf8Into(text, out + written, result.data.size() - written, encrypting);
+            }
+        }();
+        if (produced) {
+            written += *produced;
+        } else {
+            result.errors[i] = produced.error();
+            result.failed++;
+        }
+    }
+    result.offsets[count] = written;
+    result.data.resize(written);
     return result;
-}
\ No newline at end of file
+}
+
+/**
+ * @brief Пакетное зашифровывание сообщений
+ * @param messages Сообщения, записанные подряд
+ * @param offsets Смещения сообщений
+ * @return Результаты и ошибки по сообщениям
+ * @throw cipher_error Если смещения некорректны
+ */
+BatchResult<wchar_t> modAlphaCipher::encryptBatch(std::wstring_view messages, const std::vector<std::size_t>& offsets) const
+{
+    return transformBatch(messages, offsets, true);
+}
+
+/**
+ * @brief Пакетное расшифровывание сообщений
+ * @param messages Сообщения, записанные подряд
+ * @param offsets Смещения сообщений
+ * @return Результаты и ошибки по сообщениям
+ * @throw cipher_error Если смещения некорректны
+ */
+BatchResult<wchar_t> modAlphaCipher::decryptBatch(std::wstring_view messages, const std::vector<std::size_t>& offsets) const
+{
+    return transformBatch(messages, offsets, false);
+}
+
+/**
+ * @brief Пакетное зашифровывание сообщений в кодировке UTF-8
+ * @param messages Сообщения в кодировке UTF-8, записанные подряд
+ * @param offsets Смещения сообщений в байтах
+ * @return Результаты и ошибки по сообщениям
+ * @throw cipher_error Если смещения некорректны
+ */
+BatchResult<char> modAlphaCipher::encryptBatch(std::string_view messages, const std::vector<std::size_t>& offsets) const
+{
+    return transformBatch(messages, offsets, true);
+}
+
+/**
+ * @brief Пакетное расшифровывание сообщений в кодировке UTF-8
+ * @param messages Сообщения в кодировке UTF-8, записанные подряд
+ * @param offsets Смещения сообщений в байтах
+ * @return Результаты и ошибки по сообщениям
+ * @throw cipher_error Если смещения некорректны
+ */
+BatchResult<char> modAlphaCipher::decryptBatch(std::string_view messages, const std::vector<std::size_t>& offsets) const
+{
+    return transformBatch(messages, offsets, false);
+}
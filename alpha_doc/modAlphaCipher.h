@@ -1,10 +1,16 @@
 #pragma once
 #include <vector>
 #include <string>
-#include <map>
+#include <string_view>
+#include <memory>
 #include <locale>
-#include <codecvt>
 #include <stdexcept>
+#include "alphabet.h"
+#include "gronsfeldKernel.h"
+#include "../common/cipherBatch.h"
+#include "../common/cipherResult.h"
+
+class ThreadPool;
 
 /**
  * @file
@@ -22,12 +28,30 @@
 class cipher_error : public std::exception {
 private:
     std::string message;
+    CipherError err; ///< Код ошибки и позиция ошибочного символа
 public:
     /**
      * @brief Конструктор исключения
      * @param msg Сообщение об ошибке
+     * @param error Код ошибки и позиция ошибочного символа
+     */
+    explicit cipher_error(const std::string& msg, CipherError error = {}) : message(msg), err(error) {}
+    
+    /**
+     * @brief Код ошибки
+     * @return Код ошибки (CipherErrc::ok, если код не задан)
+     */
+    CipherErrc code() const noexcept {
+        return err.code;
+    }
+    
+    /**
+     * @brief Описание ошибки
+     * @return Код ошибки и позиция ошибочного символа
      */
-    explicit cipher_error(const std::string& msg) : message(msg) {}
+    const CipherError& error() const noexcept {
+        return err;
+    }
     
     /**
      * @brief Получить сообщение об ошибке
@@ -39,41 +63,206 @@ public:
 };
 
 /**
- * @brief Шифрование методом Гронсфельда для русского языка
- * @details Ключ устанавливается в конструкторе.
+ * @brief Обработка символов текста, не входящих в алфавит шифра
+ * @details Буквы алфавита шифруются во всех режимах. Некорректные
+ * последовательности UTF-8 считаются ошибкой во всех режимах
+ */
+enum class InputPolicy {
+    strict, ///< Пробелы и буквы других алфавитов удаляются, остальные символы - ошибка (по умолчанию)
+    strip, ///< Все символы вне алфавита удаляются
+    passThrough ///< Символы вне алфавита переносятся в результат без изменений и без сдвига ключа
+};
+
+/**
+ * @brief Шифрование методом Гронсфельда
+ * @details Ключ и алфавит устанавливаются в конструкторе.
  * Для зашифровывания и расшифровывания предназначены методы encrypt и decrypt.
- * @warning Реализация только для русского языка
+ * По умолчанию используется русский алфавит, другие алфавиты задаются
+ * таблицами, построенными на этапе компиляции (см. alphabet.h).
  */
 class modAlphaCipher
 {
+    friend class modAlphaStream;
+    friend class CompositeCipher;
+    
 private:
-    std::wstring numAlpha = L"АБВГДЕЁЖЗИЙКЛМНОПРСТУФХЦЧШЩЪЫЬЭЮЯ"; ///< Алфавит русского языка
-    std::map <wchar_t,int> alphaNum; ///< Ассоциативный массив "символ-номер"
+    const AlphabetTable* alphabet; ///< Таблицы алфавита, построенные на этапе компиляции (не принадлежат шифру)
     std::vector <int> key; ///< Ключ шифрования в числовом виде
+    std::vector <unsigned char> encryptShift; ///< Сдвиги для зашифровывания (дополнения цифр ключа), ключ повторен до длины key.size() + kernelBlockSize
+    std::vector <unsigned char> decryptShift; ///< Сдвиги для расшифровывания (цифры ключа), ключ повторен до длины key.size() + kernelBlockSize
+    std::shared_ptr <ThreadPool> pool; ///< Пул потоков параллельного режима (пустой - последовательный режим)
+    std::size_t parallelMinChunk = defaultParallelChunk; ///< Наименьший фрагмент текста на один поток
+    InputPolicy policy = InputPolicy::strict; ///< Обработка символов вне алфавита
+    
+    /**
+     * @brief Номер символа в алфавите с учетом регистра
+     * @param c Символ
+     * @return Номер символа в алфавите или -1, если символ в алфавит не входит
+     */
+    int indexOf(wchar_t c) const {
+        return (static_cast<unsigned long>(c) < alphabetCodeRange) ? alphabet->index[c] : -1;
+    }
+    
+    /**
+     * @brief Конструктор по проверенному ключу
+     * @param numericKey Ключ в числовом виде (не пустой)
+     * @param alpha Алфавит шифра
+     */
+    modAlphaCipher(std::vector<int> numericKey, const AlphabetTable& alpha);
+    
+    /**
+     * @brief Проверка ключа и перевод его в числовой вид
+     * @param skey Ключ шифрования
+     * @param alpha Алфавит шифра
+     * @param numericKey Ключ в числовом виде
+     * @return Ошибка ключа (код CipherErrc::ok, если ключ корректен)
+     */
+    static CipherError parseKey(const std::wstring& skey, const AlphabetTable& alpha, std::vector<int>& numericKey);
+    
+    /**
+     * @brief Развертывание ключа в таблицы сдвигов
+     */
+    void expandKey();
+    
+    /**
+     * @brief Однопроходное зашифровывание или расшифровывание текста
+     * @details За один проход проверяет символы, приводит их к верхнему регистру,
+     * находит номер в алфавите по плоской таблице, выполняет сдвиг
+     * и записывает результат через приемник в заранее выделенный буфер.
+     * Символы вне алфавита обрабатываются согласно policy.
+     * Сдвиг выполняется векторным ядром блоками по kernelBlockSize символов
+     * @tparam Source Источник символов (широкая строка или UTF-8)
+     * @tparam Sink Приемник символов (широкая строка или UTF-8)
+     * @param source Источник символов
+     * @param sink Приемник символов
+     * @param encrypting true - зашифровывание, false - расшифровывание
+     * @param keyPos Позиция в ключе для первого символа; на выходе - для следующего
+     * @return Количество записанных букв алфавита или ошибка CipherErrc::invalidSymbol
+     * с позицией символа относительно начала источника
+     */
+    template <class Source, class Sink>
+    CipherResult<std::size_t> transform(Source source, Sink& sink, bool encrypting, std::size_t& keyPos) const;
+    
+    /**
+     * @brief Зашифровывание или расшифровывание широкой строки
+     * @param text Исходный текст
+     * @param encrypting true - зашифровывание, false - расшифровывание
+     * @return Результирующая строка или ошибка
+     */
+    CipherResult<std::wstring> transformWide(const std::wstring& text, bool encrypting) const;
+    
+    /**
+     * @brief Зашифровывание или расшифровывание строки UTF-8
+     * @param text Исходный текст в кодировке UTF-8
+     * @param encrypting true - зашифровывание, false - расшифровывание
+     * @return Результирующая строка в кодировке UTF-8 или ошибка
+     */
+    CipherResult<std::string> transformUtf8(std::string_view text, bool encrypting) const;
+    
+    /**
+     * @brief Зашифровывание или расшифровывание фрагмента UTF-8 с дописыванием в конец строки
+     * @param text Фрагмент текста в кодировке UTF-8 (может быть пустым)
+     * @param out Строка, в конец которой дописывается результат
+     * @param encrypting true - зашифровывание, false - расшифровывание
+     * @param keyPos Позиция в ключе для первого символа; на выходе - для следующего
+     * @return Количество записанных букв алфавита или ошибка
+     */
+    CipherResult<std::size_t> appendUtf8(std::string_view text, std::string& out, bool encrypting, std::size_t& keyPos) const;
     
     /**
-     * @brief Преобразование строки в числовой вектор
-     * @param s Исходная строка
-     * @return Вектор числовых представлений символов
+     * @brief Зашифровывание или расшифровывание фрагмента UTF-8 в буфер вызывающей стороны
+     * @param text Фрагмент текста в кодировке UTF-8 (может быть пустым)
+     * @param out Позиция записи; буфер не меньше requiredUtf8OutputSize(text.size()) байт.
+     * На выходе - позиция сразу после записанного результата
+     * @param encrypting true - зашифровывание, false - расшифровывание
+     * @param keyPos Позиция в ключе для первого символа; на выходе - для следующего
+     * @return Количество записанных букв алфавита или ошибка (позиция - в байтах от начала фрагмента)
      */
-    std::vector<int> convert(const std::wstring& s);
+    CipherResult<std::size_t> writeUtf8(std::string_view text, char*& out, bool encrypting, std::size_t& keyPos) const;
     
     /**
-     * @brief Преобразование числового вектора в строку
-     * @param v Вектор числовых представлений
-     * @return Результирующая строка
-     * @throw cipher_error Если индекс выходит за границы алфавита
+     * @brief Проверка текста и подсчет букв алфавита
+     * @tparam Source Источник символов
+     * @param source Источник символов
+     * @return Количество букв алфавита или ошибка CipherErrc::invalidSymbol
      */
-    std::wstring convert(const std::vector<int>& v);
+    template <class Source>
+    CipherResult<std::size_t> countLetters(Source source) const;
     
     /**
-     * @brief Приведение строки к верхнему регистру
-     * @param s Исходная строка
-     * @return Строка в верхнем регистре
+     * @brief Параллельный подсчет букв в частях текста
+     * @tparam Source Источник символов
+     * @param parts Части текста, идущие подряд
+     * @param offsets Количество букв перед началом каждой части; последний элемент - общее количество
+     * @return Первая по тексту ошибка (позиция отсчитывается от начала первой части)
      */
-    std::wstring toUpper(const std::wstring& s);
+    template <class Source>
+    CipherError letterOffsets(const std::vector<Source>& parts, std::vector<std::size_t>& offsets) const;
+    
+    /**
+     * @brief Количество частей для параллельной обработки текста
+     * @param length Длина текста (символов или байт)
+     * @return Количество частей; 1 означает последовательную обработку
+     */
+    std::size_t parallelParts(std::size_t length) const;
+    
+    /**
+     * @brief Параллельное зашифровывание или расшифровывание широкой строки
+     * @param text Исходный текст
+     * @param encrypting true - зашифровывание, false - расшифровывание
+     * @param parts Количество частей
+     * @return Результирующая строка или ошибка
+     */
+    CipherResult<std::wstring> transformWideParallel(const std::wstring& text, bool encrypting, std::size_t parts) const;
+    
+    /**
+     * @brief Параллельное зашифровывание или расшифровывание строки UTF-8
+     * @param text Исходный текст в кодировке UTF-8
+     * @param encrypting true - зашифровывание, false - расшифровывание
+     * @param parts Количество частей
+     * @return Результирующая строка в кодировке UTF-8 или ошибка
+     */
+    CipherResult<std::string> transformUtf8Parallel(std::string_view text, bool encrypting, std::size_t parts) const;
+    
+    /**
+     * @brief Зашифровывание или расшифровывание широкой строки в буфер вызывающей стороны
+     * @param text Исходный текст
+     * @param length Длина текста
+     * @param out Буфер результата (может совпадать с text)
+     * @param capacity Размер буфера результата
+     * @param encrypting true - зашифровывание, false - расшифровывание
+     * @return Количество записанных символов или ошибка: пустой текст, недопустимый символ,
+     * отсутствие букв алфавита или слишком малый буфер
+     */
+    CipherResult<std::size_t> wideInto(const wchar_t* text, std::size_t length, wchar_t* out, std::size_t capacity, bool encrypting) const;
+    
+    /**
+     * @brief Зашифровывание или расшифровывание строки UTF-8 в буфер вызывающей стороны
+     * @param text Исходный текст в кодировке UTF-8
+     * @param out Буфер результата (может совпадать с text.data() при равной длине букв алфавита)
+     * @param capacity Размер буфера результата в байтах
+     * @param encrypting true - зашифровывание, false - расшифровывание
+     * @return Количество записанных байт или ошибка: пустой текст, недопустимый символ,
+     * отсутствие букв алфавита или слишком малый буфер
+     */
+    CipherResult<std::size_t> utf8Into(std::string_view text, char* out, std::size_t capacity, bool encrypting) const;
+    
+    /**
+     * @brief Пакетное зашифровывание или расшифровывание
+     * @tparam Char wchar_t или char (UTF-8)
+     * @param messages Арена сообщений
+     * @param offsets Смещения сообщений в арене
+     * @param encrypting true - зашифровывание, false - расшифровывание
+     * @return Результаты и ошибки по сообщениям
+     * @throw cipher_error Если смещения некорректны
+     */
+    template <class Char>
+    BatchResult<Char> transformBatch(std::basic_string_view<Char> messages, const std::vector<std::size_t>& offsets, bool encrypting) const;
     
 public:
+    /// Наименьший фрагмент текста на один поток по умолчанию (символов или байт UTF-8)
+    static constexpr std::size_t defaultParallelChunk = 1 << 20;
+    
     /**
      * @brief Запрещенный конструктор без параметров
      */
@@ -82,15 +271,55 @@ public:
     /**
      * @brief Конструктор для установки ключа
      * @param skey Ключ шифрования
+     * @param alpha Алфавит шифра (по умолчанию русский). Шифр хранит ссылку на таблицы,
+     * поэтому они должны существовать, пока существует шифр (обычно это
+     * inline constexpr или static constexpr переменная, см. alphabet.h)
      * @throw cipher_error Если ключ пустой или содержит недопустимые символы
      */
-    modAlphaCipher(const std::wstring& skey);
+    modAlphaCipher(const std::wstring& skey, const AlphabetTable& alpha = russianAlphabet);
+    
+    /**
+     * @brief Запрещенный конструктор с временным алфавитом
+     * @details Шифр пережил бы таблицы алфавита, например при вызове
+     * modAlphaCipher(key, makeAlphabet(L"..."))
+     */
+    modAlphaCipher(const std::wstring& skey, const AlphabetTable&& alpha) = delete;
+    
+    /**
+     * @brief Создание шифра без исключений
+     * @param skey Ключ шифрования
+     * @param alpha Алфавит шифра (по умолчанию русский); должен существовать, пока
+     * существует шифр
+     * @return Шифр или ошибка ключа с позицией недопустимого символа в ключе
+     */
+    static CipherResult<modAlphaCipher> create(const std::wstring& skey, const AlphabetTable& alpha = russianAlphabet);
+    
+    /**
+     * @brief Запрещенное создание шифра с временным алфавитом
+     */
+    static CipherResult<modAlphaCipher> create(const std::wstring& skey, const AlphabetTable&& alpha) = delete;
+    
+    /**
+     * @brief Текст сообщения об ошибке
+     * @param code Код ошибки
+     * @param encrypting true - зашифровывание, false - расшифровывание
+     * @return Сообщение об ошибке, совпадающее с текстом исключения cipher_error
+     */
+    static const char* errorMessage(CipherErrc code, bool encrypting);
+    
+    /**
+     * @brief Исключение для ошибки
+     * @param error Описание ошибки
+     * @param encrypting true - зашифровывание, false - расшифровывание
+     * @return Исключение с сообщением и кодом ошибки
+     */
+    static cipher_error makeError(CipherError error, bool encrypting);
     
     /**
      * @brief Зашифровывание текста
      * @param open_text Открытый текст. Не должен быть пустой строкой.
      * Строчные символы автоматически преобразуются к прописным.
-     * Все не-буквы удаляются
+     * Символы вне алфавита обрабатываются согласно inputPolicy()
      * @return Зашифрованная строка
      * @throw cipher_error Если текст пустой или содержит недопустимые символы
      */
@@ -99,9 +328,280 @@ public:
     /**
      * @brief Расшифровывание текста
      * @param cipher_text Зашифрованный текст. Не должен быть пустой строкой.
-     * Должен содержать только буквы русского алфавита
+     * Должен содержать только буквы алфавита шифра
      * @return Расшифрованная строка
      * @throw cipher_error Если текст пустой или содержит недопустимые символы
      */
     std::wstring decrypt(const std::wstring& cipher_text);
+    
+    /**
+     * @brief Зашифровывание текста в кодировке UTF-8
+     * @details Текст обрабатывается без преобразования в широкую строку,
+     * двухбайтовые символы (кириллица) разбираются непосредственно
+     * @param open_text Открытый текст в кодировке UTF-8. Не должен быть пустой строкой.
+     * @return Зашифрованная строка в кодировке UTF-8
+     * @throw cipher_error Если текст пустой, содержит недопустимые символы
+     * или некорректные последовательности UTF-8
+     */
+    std::string encrypt(std::string_view open_text);
+    
+    /**
+     * @brief Расшифровывание текста в кодировке UTF-8
+     * @param cipher_text Зашифрованный текст в кодировке UTF-8. Не должен быть пустой строкой.
+     * @return Расшифрованная строка в кодировке UTF-8
+     * @throw cipher_error Если текст пустой, содержит недопустимые символы
+     * или некорректные последовательности UTF-8
+     */
+    std::string decrypt(std::string_view cipher_text);
+    
+    /**
+     * @brief Зашифровывание текста без исключений
+     * @details Ошибки входных данных возвращаются кодом вместо исключения,
+     * что дешевле при частых некорректных записях
+     * @param open_text Открытый текст
+     * @return Зашифрованная строка или ошибка с позицией недопустимого символа
+     */
+    CipherResult<std::wstring> tryEncrypt(const std::wstring& open_text) const;
+    
+    /**
+     * @brief Расшифровывание текста без исключений
+     * @param cipher_text Зашифрованный текст
+     * @return Расшифрованная строка или ошибка с позицией недопустимого символа
+     */
+    CipherResult<std::wstring> tryDecrypt(const std::wstring& cipher_text) const;
+    
+    /**
+     * @brief Зашифровывание текста UTF-8 без исключений
+     * @param open_text Открытый текст в кодировке UTF-8
+     * @return Зашифрованная строка или ошибка с позицией недопустимого символа в байтах
+     */
+    CipherResult<std::string> tryEncrypt(std::string_view open_text) const;
+    
+    /**
+     * @brief Расшифровывание текста UTF-8 без исключений
+     * @param cipher_text Зашифрованный текст в кодировке UTF-8
+     * @return Расшифрованная строка или ошибка с позицией недопустимого символа в байтах
+     */
+    CipherResult<std::string> tryDecrypt(std::string_view cipher_text) const;
+    
+    /**
+     * @brief Включение параллельного режима
+     * @details Тексты длиннее 2 * minChunkSize делятся на части, которые обрабатываются
+     * пулом потоков. Результат совпадает с последовательной обработкой.
+     * Копии объекта используют общий пул.
+     * @param workers Количество потоков; 0 или 1 - последовательный режим
+     * @param minChunkSize Наименьший фрагмент текста (символов или байт UTF-8) на один поток
+     */
+    void setParallelism(std::size_t workers, std::size_t minChunkSize = defaultParallelChunk);
+    
+    /**
+     * @brief Установка режима обработки символов вне алфавита
+     * @details В режиме InputPolicy::strict (по умолчанию) текст со знаками препинания
+     * или цифрами отвергается. Режимы InputPolicy::strip и InputPolicy::passThrough
+     * позволяют шифровать произвольный текст: в первом случае такие символы удаляются,
+     * во втором остаются на своих местах. Текст без букв алфавита в режиме
+     * InputPolicy::passThrough не считается ошибкой.
+     * Ключ проверяется одинаково во всех режимах
+     * @param inputPolicy Режим обработки
+     */
+    void setInputPolicy(InputPolicy inputPolicy) {
+        policy = inputPolicy;
+    }
+    
+    /**
+     * @brief Режим обработки символов вне алфавита
+     * @return Текущий режим
+     */
+    InputPolicy inputPolicy() const {
+        return policy;
+    }
+    
+    /**
+     * @brief Необходимый размер буфера результата для широкой строки
+     * @param length Длина текста в символах
+     * @return Количество символов, которого заведомо достаточно для результата
+     */
+    std::size_t requiredOutputSize(std::size_t length) const {
+        return length;
+    }
+    
+    /**
+     * @brief Необходимый размер буфера результата для текста UTF-8
+     * @param size Длина текста в байтах
+     * @return Количество байт, которого заведомо достаточно для результата
+     * @details Каждая буква алфавита занимает на входе не меньше minUtf8Length байт,
+     * а на выходе не больше maxUtf8Length байт; символы, переносимые без изменений,
+     * занимают столько же байт, сколько на входе
+     */
+    std::size_t requiredUtf8OutputSize(std::size_t size) const {
+        return size * alphabet->maxUtf8Length / alphabet->minUtf8Length;
+    }
+    
+    /**
+     * @brief Зашифровывание в буфер вызывающей стороны
+     * @details Не выделяет память в куче; предназначен для циклов обработки,
+     * повторно использующих буферы. Выполняется последовательно
+     * @param open_text Открытый текст
+     * @param length Длина текста в символах
+     * @param out Буфер результата
+     * @param capacity Размер буфера, не меньше requiredOutputSize(length)
+     * @return Количество записанных символов
+     * @throw cipher_error Если текст пустой, содержит недопустимые символы,
+     * не содержит букв алфавита или буфер слишком мал
+     */
+    std::size_t encryptInto(const wchar_t* open_text, std::size_t length, wchar_t* out, std::size_t capacity) const;
+    
+    /**
+     * @brief Расшифровывание в буфер вызывающей стороны
+     * @param cipher_text Зашифрованный текст
+     * @param length Длина текста в символах
+     * @param out Буфер результата
+     * @param capacity Размер буфера, не меньше requiredOutputSize(length)
+     * @return Количество записанных символов
+     * @throw cipher_error Если текст пустой, содержит недопустимые символы,
+     * не содержит букв алфавита или буфер слишком мал
+     */
+    std::size_t decryptInto(const wchar_t* cipher_text, std::size_t length, wchar_t* out, std::size_t capacity) const;
+    
+    /**
+     * @brief Зашифровывание текста UTF-8 в буфер вызывающей стороны
+     * @param open_text Открытый текст в кодировке UTF-8
+     * @param out Буфер результата
+     * @param capacity Размер буфера, не меньше requiredUtf8OutputSize(open_text.size())
+     * @return Количество записанных байт
+     * @throw cipher_error Если текст пустой, содержит недопустимые символы,
+     * не содержит букв алфавита или буфер слишком мал
+     */
+    std::size_t encryptInto(std::string_view open_text, char* out, std::size_t capacity) const;
+    
+    /**
+     * @brief Расшифровывание текста UTF-8 в буфер вызывающей стороны
+     * @param cipher_text Зашифрованный текст в кодировке UTF-8
+     * @param out Буфер результата
+     * @param capacity Размер буфера, не меньше requiredUtf8OutputSize(cipher_text.size())
+     * @return Количество записанных байт
+     * @throw cipher_error Если текст пустой, содержит недопустимые символы,
+     * не содержит букв алфавита или буфер слишком мал
+     */
+    std::size_t decryptInto(std::string_view cipher_text, char* out, std::size_t capacity) const;
+    
+    /**
+     * @brief Зашифровывание на месте
+     * @details Результат не длиннее текста и записывается в начало того же буфера
+     * @param text Текст; на выходе - зашифрованный текст
+     * @param length Длина текста в символах
+     * @return Длина зашифрованного текста
+     * @throw cipher_error Если текст пустой, содержит недопустимые символы
+     * или не содержит букв алфавита
+     */
+    std::size_t encryptInPlace(wchar_t* text, std::size_t length) const;
+    
+    /**
+     * @brief Расшифровывание на месте
+     * @param text Текст; на выходе - расшифрованный текст
+     * @param length Длина текста в символах
+     * @return Длина расшифрованного текста
+     * @throw cipher_error Если текст пустой, содержит недопустимые символы
+     * или не содержит букв алфавита
+     */
+    std::size_t decryptInPlace(wchar_t* text, std::size_t length) const;
+    
+    /**
+     * @brief Зашифровывание текста UTF-8 на месте
+     * @details Возможно, только если все буквы алфавита имеют одинаковую длину в UTF-8
+     * (например, русский или латинский алфавит)
+     * @param text Текст в кодировке UTF-8; на выходе - зашифрованный текст
+     * @param size Длина текста в байтах
+     * @return Длина зашифрованного текста в байтах
+     * @throw cipher_error Если текст пустой, содержит недопустимые символы,
+     * не содержит букв алфавита или длины букв алфавита различаются
+     */
+    std::size_t encryptInPlace(char* text, std::size_t size) const;
+    
+    /**
+     * @brief Расшифровывание текста UTF-8 на месте
+     * @param text Текст в кодировке UTF-8; на выходе - расшифрованный текст
+     * @param size Длина текста в байтах
+     * @return Длина расшифрованного текста в байтах
+     * @throw cipher_error Если текст пустой, содержит недопустимые символы,
+     * не содержит букв алфавита или длины букв алфавита различаются
+     */
+    std::size_t decryptInPlace(char* text, std::size_t size) const;
+    
+    /**
+     * @brief Зашифровывание в буфер вызывающей стороны без исключений
+     * @param open_text Открытый текст
+     * @param length Длина текста в символах
+     * @param out Буфер результата
+     * @param capacity Размер буфера, не меньше requiredOutputSize(length)
+     * @return Количество записанных символов или ошибка
+     */
+    CipherResult<std::size_t> tryEncryptInto(const wchar_t* open_text, std::size_t length, wchar_t* out, std::size_t capacity) const;
+    
+    /**
+     * @brief Расшифровывание в буфер вызывающей стороны без исключений
+     * @param cipher_text Зашифрованный текст
+     * @param length Длина текста в символах
+     * @param out Буфер результата
+     * @param capacity Размер буфера, не меньше requiredOutputSize(length)
+     * @return Количество записанных символов или ошибка
+     */
+    CipherResult<std::size_t> tryDecryptInto(const wchar_t* cipher_text, std::size_t length, wchar_t* out, std::size_t capacity) const;
+    
+    /**
+     * @brief Зашифровывание текста UTF-8 в буфер вызывающей стороны без исключений
+     * @param open_text Открытый текст в кодировке UTF-8
+     * @param out Буфер результата
+     * @param capacity Размер буфера, не меньше requiredUtf8OutputSize(open_text.size())
+     * @return Количество записанных байт или ошибка
+     */
+    CipherResult<std::size_t> tryEncryptInto(std::string_view open_text, char* out, std::size_t capacity) const;
+    
+    /**
+     * @brief Расшифровывание текста UTF-8 в буфер вызывающей стороны без исключений
+     * @param cipher_text Зашифрованный текст в кодировке UTF-8
+     * @param out Буфер результата
+     * @param capacity Размер буфера, не меньше requiredUtf8OutputSize(cipher_text.size())
+     * @return Количество записанных байт или ошибка
+     */
+    CipherResult<std::size_t> tryDecryptInto(std::string_view cipher_text, char* out, std::size_t capacity) const;
+    
+    /**
+     * @brief Пакетное зашифровывание сообщений
+     * @details Все сообщения обрабатываются одним ключом, результаты пишутся
+     * в одну заранее выделенную арену без выделения памяти на каждое сообщение.
+     * Ошибка в сообщении не прерывает пакет, ее код записывается в BatchResult::errors
+     * @param messages Сообщения, записанные подряд
+     * @param offsets Смещения сообщений: сообщение i занимает [offsets[i], offsets[i + 1])
+     * @return Результаты и ошибки по сообщениям
+     * @throw cipher_error Если смещения некорректны
+     */
+    BatchResult<wchar_t> encryptBatch(std::wstring_view messages, const std::vector<std::size_t>& offsets) const;
+    
+    /**
+     * @brief Пакетное расшифровывание сообщений
+     * @param messages Сообщения, записанные подряд
+     * @param offsets Смещения сообщений: сообщение i занимает [offsets[i], offsets[i + 1])
+     * @return Результаты и ошибки по сообщениям
+     * @throw cipher_error Если смещения некорректны
+     */
+    BatchResult<wchar_t> decryptBatch(std::wstring_view messages, const std::vector<std::size_t>& offsets) const;
+    
+    /**
+     * @brief Пакетное зашифровывание сообщений в кодировке UTF-8
+     * @param messages Сообщения в кодировке UTF-8, записанные подряд
+     * @param offsets Смещения сообщений в байтах
+     * @return Результаты и ошибки по сообщениям
+     * @throw cipher_error Если смещения некорректны
+     */
+    BatchResult<char> encryptBatch(std::string_view messages, const std::vector<std::size_t>& offsets) const;
+    
+    /**
+     * @brief Пакетное расшифровывание сообщений в кодировке UTF-8
+     * @param messages Сообщения в кодировке UTF-8, записанные подряд
+     * @param offsets Смещения сообщений в байтах
+     * @return Результаты и ошибки по сообщениям
+     * @throw cipher_error Если смещения некорректны
+     */
+    BatchResult<char> decryptBatch(std::string_view messages, const std::vector<std::size_t>& offsets) const;
 };
@@ -0,0 +1,110 @@
+#include "modAlphaStream.h"
+#include "../common/utf8.h"
+#include <algorithm>
+
+/**
+ * @file modAlphaStream.cpp
+ * @brief Реализация потокового шифрования методом Гронсфельда
+ */
+
+/**
+ * @brief Конструктор потока
+ * @param cipher Шифр с установленным ключом
+ * @param encrypting true - зашифровывание, false - расшифровывание
+ */
+modAlphaStream::modAlphaStream(const modAlphaCipher& cipher, bool encrypting)
+    : cipher(cipher), encrypting(encrypting)
+{
+}
+
+/**
+ * @brief Обработка очередного фрагмента
+ * @param chunk Фрагмент текста в кодировке UTF-8
+ * @param out Строка, в конец которой дописывается результат
+ * @return Количество букв, записанных в out
+ * @throw cipher_error Если фрагмент содержит недопустимые символы
+ */
+std::size_t modAlphaStream::update(std::string_view chunk, std::string& out)
+{
+    const std::size_t start = out.size();
+    const std::size_t before = letters;
+    out.resize(start + maxOutputSize(chunk.size()));
+    char* end = update(chunk, &out[0] + start);
+    out.resize(static_cast<std::size_t>(end - out.data()));
+    return letters - before;
+}
+
+/**
+ * @brief Обработка очередного фрагмента с записью в буфер вызывающей стороны
+ * @param chunk Фрагмент текста в кодировке UTF-8
+ * @param out Буфер не меньше maxOutputSize(chunk.size()) байт
+ * @return Позиция сразу после записанного результата
+ * @throw cipher_error Если фрагмент содержит недопустимые символы
+ * @details Сначала дополняется символ, отложенный с прошлого фрагмента,
+ * затем обрабатывается основная часть, а незавершенный хвост откладывается
+ */
+char* modAlphaStream::update(std::string_view chunk, char* out)
+{
+    const std::size_t chunkStart = consumed;
+    consumed += chunk.size();
+    
+    // Завершение символа, разрезанного границей предыдущего фрагмента
+    if (pendingSize > 0) {
+        const std::size_t pendingStart = chunkStart - pendingSize;
+        const std::size_t need = utf8SequenceLength(static_cast<unsigned char>(pending[0]));
+        const std::size_t take = std::min(need - pendingSize, chunk.size());
+        chunk.copy(pending + pendingSize, take);
+        pendingSize += take;
+        chunk.remove_prefix(take);
+        if (pendingSize < need) {
+            return out;
+        }
+        letters += count(cipher.writeUtf8(std::string_view(pending, pendingSize), out, encrypting, keyPos), pendingStart);
+        pendingSize = 0;
+    }
+    
+    // Незавершенный символ в конце фрагмента откладывается
+    const std::size_t bodyStart = consumed - chunk.size();
+    const std::size_t tail = utf8IncompleteTail(chunk.data(), chunk.data() + chunk.size());
+    letters += count(cipher.writeUtf8(chunk.substr(0, chunk.size() - tail), out, encrypting, keyPos), bodyStart);
+    chunk.copy(pending, tail, chunk.size() - tail);
+    pendingSize = tail;
+    return out;
+}
+
+/**
+ * @brief Завершение потока
+ * @throw cipher_error Если поток оборвался внутри символа UTF-8
+ * или за весь поток не встретилось ни одной буквы алфавита (кроме режима InputPolicy::passThrough)
+ */
+void modAlphaStream::finish()
+{
+    if (pendingSize > 0) {
+        // Оборванная последовательность будет отвергнута как недопустимый символ
+        char rest[8];
+        char* out = rest;
+        const std::size_t size = pendingSize;
+        pendingSize = 0;
+        count(cipher.writeUtf8(std::string_view(pending, size), out, encrypting, keyPos), consumed - size);
+    }
+    if (letters == 0 && cipher.policy != InputPolicy::passThrough) {
+        throw modAlphaCipher::makeError({CipherErrc::noLetters, 0}, encrypting);
+    }
+}
+
+/**
+ * @brief Количество букв обработанной части или исключение с ее ошибкой
+ * @param result Результат обработки части потока
+ * @param start Позиция начала части в потоке, байт
+ * @return Количество букв
+ * @throw cipher_error С позицией ошибочного символа от начала потока
+ */
+std::size_t modAlphaStream::count(CipherResult<std::size_t> result, std::size_t start) const
+{
+    if (!result) {
+        CipherError error = result.error();
+        error.offset += start;
+        throw modAlphaCipher::makeError(error, encrypting);
+    }
+    return *result;
+}
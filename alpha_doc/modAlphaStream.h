@@ -0,0 +1,115 @@
+#pragma once
+#include <string>
+#include <string_view>
+#include "modAlphaCipher.h"
+
+/**
+ * @file
+ * @author Ганьшин В.А.
+ * @version 1.0
+ * @date 17.12.2025
+ * @brief Потоковое шифрование методом Гронсфельда
+ */
+
+/**
+ * @brief Потоковый шифратор Гронсфельда для текста в кодировке UTF-8
+ * @details Принимает текст фрагментами произвольного размера и выдает результат
+ * по мере поступления данных. Позиция в ключе сохраняется между фрагментами,
+ * поэтому результат совпадает с обработкой всего текста одним вызовом
+ * modAlphaCipher::encrypt / modAlphaCipher::decrypt.
+ * Символ UTF-8, разрезанный границей фрагмента, откладывается до следующего фрагмента.
+ * Объем памяти не зависит от длины потока.
+ *
+ * Пример использования:
+ * @code
+ * modAlphaCipher cipher(L"КЛЮЧ");
+ * modAlphaStream stream(cipher, true);
+ * std::string out;
+ * while (readChunk(chunk)) {
+ *     out.clear();
+ *     stream.update(chunk, out);
+ *     write(out);
+ * }
+ * stream.finish();
+ * @endcode
+ * @warning Объект шифра должен существовать, пока используется поток.
+ * После исключения поток дальше использовать нельзя.
+ */
+class modAlphaStream
+{
+private:
+    const modAlphaCipher& cipher; ///< Шифр, задающий ключ и алфавит
+    bool encrypting; ///< true - зашифровывание, false - расшифровывание
+    std::size_t keyPos = 0; ///< Позиция в ключе для следующей буквы
+    std::size_t letters = 0; ///< Количество обработанных букв
+    char pending[4] = {}; ///< Начало символа, разрезанного границей фрагмента
+    std::size_t pendingSize = 0; ///< Количество байт в pending
+    std::size_t consumed = 0; ///< Количество байт потока, переданных в update()
+    
+    /**
+     * @brief Количество букв обработанной части или исключение с ее ошибкой
+     * @param result Результат обработки части потока
+     * @param start Позиция начала части в потоке, байт
+     * @return Количество букв
+     * @throw cipher_error С позицией ошибочного символа от начала потока
+     */
+    std::size_t count(CipherResult<std::size_t> result, std::size_t start) const;
+
+public:
+    /**
+     * @brief Запрещенный конструктор без параметров
+     */
+    modAlphaStream()=delete;
+
+    /**
+     * @brief Конструктор потока
+     * @param cipher Шифр с установленным ключом
+     * @param encrypting true - зашифровывание, false - расшифровывание
+     */
+    modAlphaStream(const modAlphaCipher& cipher, bool encrypting);
+
+    /**
+     * @brief Обработка очередного фрагмента
+     * @param chunk Фрагмент текста в кодировке UTF-8 (может быть пустым)
+     * @param out Строка, в конец которой дописывается результат
+     * @return Количество букв, записанных в out
+     * @throw cipher_error Если фрагмент содержит недопустимые символы;
+     * cipher_error::error().offset - позиция символа в байтах от начала потока
+     */
+    std::size_t update(std::string_view chunk, std::string& out);
+    
+    /**
+     * @brief Обработка очередного фрагмента с записью в буфер вызывающей стороны
+     * @details Позволяет писать результат прямо в отображенный в память файл
+     * или в повторно используемый буфер без промежуточных строк
+     * @param chunk Фрагмент текста в кодировке UTF-8 (может быть пустым)
+     * @param out Буфер не меньше maxOutputSize(chunk.size()) байт
+     * @return Позиция сразу после записанного результата
+     * @throw cipher_error Если фрагмент содержит недопустимые символы
+     */
+    char* update(std::string_view chunk, char* out);
+    
+    /**
+     * @brief Наибольшая длина результата обработки фрагмента
+     * @param chunkSize Длина фрагмента в байтах
+     * @return Длина результата в байтах с учетом отложенного символа
+     */
+    std::size_t maxOutputSize(std::size_t chunkSize) const {
+        return cipher.requiredUtf8OutputSize(chunkSize + pendingSize);
+    }
+
+    /**
+     * @brief Завершение потока
+     * @throw cipher_error Если поток оборвался внутри символа UTF-8
+     * или за весь поток не встретилось ни одной буквы алфавита (кроме режима InputPolicy::passThrough)
+     */
+    void finish();
+
+    /**
+     * @brief Позиция в ключе для следующей буквы
+     * @return Номер цифры ключа
+     */
+    std::size_t position() const {
+        return keyPos;
+    }
+};
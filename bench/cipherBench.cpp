@@ -0,0 +1,528 @@
+/**
+ * @file cipherBench.cpp
+ * @author Ганьшин В.А.
+ * @version 1.0
+ * @date 17.12.2025
+ * @brief Замеры производительности шифров modAlphaCipher, TableCipher и CompositeCipher
+ * @details Программа перебирает размер сообщения, длину ключа Гронсфельда,
+ * количество столбцов таблицы и количество потоков, для каждого сочетания
+ * многократно вызывает encrypt/decrypt (UTF-8) и выводит результаты в формате JSON:
+ * пропускную способность (МБ/с), время на символ (нс), количество выделений
+ * памяти на вызов и задержку вызова (медиана и 99-й процентиль).
+ *
+ * Сборка из корня репозитория:
+ * @code
+ * g++ -std=c++17 -O2 -pthread bench/cipherBench.cpp \
+ *     alpha_doc/modAlphaCipher.cpp alpha_doc/gronsfeldKernel.cpp alpha_doc/modAlphaStream.cpp \
+ *     route_doc/tableCipher.cpp route_doc/routeKernel.cpp route_doc/tablePlan.cpp route_doc/routeEngine.cpp route_doc/tableFile.cpp \
+ *     composite_doc/compositeCipher.cpp \
+ *     common/threadPool.cpp -o cipherBench
+ * @endcode
+ *
+ * Пример запуска (полный перебор до 1 ГБ, результат в файл):
+ * @code
+ * ./cipherBench --max-size 1G --output bench.json
+ * @endcode
+ */
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <cerrno>
+#include <iostream>
+#include <locale>
+#include <new>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+#include "../alpha_doc/modAlphaCipher.h"
+#include "../route_doc/tableCipher.h"
+#include "../composite_doc/compositeCipher.h"
+
+namespace {
+
+std::atomic<std::size_t> allocationCount{0}; ///< Количество выделений памяти с начала работы
+
+} // namespace
+
+/**
+ * @brief Глобальный оператор выделения памяти со счетчиком вызовов
+ * @param size Размер блока
+ * @return Указатель на выделенный блок
+ * @throw std::bad_alloc При нехватке памяти
+ */
+void* operator new(std::size_t size)
+{
+    allocationCount.fetch_add(1, std::memory_order_relaxed);
+    if (void* p = std::malloc(size ? size : 1)) {
+        return p;
+    }
+    throw std::bad_alloc();
+}
+
+/**
+ * @brief Глобальный оператор освобождения памяти
+ * @param p Указатель на блок
+ */
+void operator delete(void* p) noexcept
+{
+    std::free(p);
+}
+
+/**
+ * @brief Глобальный оператор освобождения памяти с размером
+ * @param p Указатель на блок
+ */
+void operator delete(void* p, std::size_t) noexcept
+{
+    std::free(p);
+}
+
+namespace {
+
+/**
+ * @brief Параметры перебора
+ */
+struct BenchOptions {
+    std::vector<std::size_t> sizes; ///< Размеры сообщений в байтах UTF-8
+    std::vector<std::size_t> keyLengths{1, 7, 64}; ///< Длины ключа Гронсфельда
+    std::vector<int> columns{1, 2, 3, 5, 8, 16, 64, 256, 1000}; ///< Количества столбцов таблицы
+    std::vector<std::size_t> threads{1, 2, 4}; ///< Количества потоков
+    std::size_t minSize = 16; ///< Наименьший размер сообщения
+    std::size_t maxSize = 64u << 20; ///< Наибольший размер сообщения
+    double minTime = 0.2; ///< Наименьшее время замера одного сочетания, с
+    std::size_t minIterations = 3; ///< Наименьшее количество вызовов в замере
+    std::size_t maxIterations = 1000000; ///< Наибольшее количество вызовов в замере
+    bool gronsfeld = true; ///< Замерять modAlphaCipher
+    bool table = true; ///< Замерять TableCipher
+    bool composite = true; ///< Замерять CompositeCipher и последовательное применение шифров
+    std::string output; ///< Файл для результата (пусто - стандартный вывод)
+};
+
+/**
+ * @brief Результат замера одного сочетания параметров
+ */
+struct BenchResult {
+    std::size_t iterations = 0; ///< Количество вызовов
+    double seconds = 0; ///< Суммарное время вызовов, с
+    double p50 = 0; ///< Медиана задержки вызова, нс
+    double p99 = 0; ///< 99-й процентиль задержки вызова, нс
+    double allocations = 0; ///< Выделений памяти на вызов
+};
+
+/**
+ * @brief Разбор размера с необязательным суффиксом K, M или G
+ * @param text Строка вида "4096", "64K", "1G"
+ * @return Размер в байтах
+ * @throw std::invalid_argument При некорректной записи
+ */
+std::size_t parseSize(const std::string& text)
+{
+    std::size_t pos = 0;
+    unsigned long long value = std::stoull(text, &pos);
+    if (pos < text.size()) {
+        switch (text[pos]) {
+            case 'k': case 'K': value <<= 10; break;
+            case 'm': case 'M': value <<= 20; break;
+            case 'g': case 'G': value <<= 30; break;
+            default: throw std::invalid_argument(text);
+        }
+        if (pos + 1 != text.size()) {
+            throw std::invalid_argument(text);
+        }
+    }
+    return static_cast<std::size_t>(value);
+}
+
+/**
+ * @brief Разбор списка через запятую
+ * @param text Строка вида "1,2,4"
+ * @return Значения списка
+ * @throw std::invalid_argument При некорректной записи
+ */
+std::vector<std::size_t> parseList(const std::string& text)
+{
+    std::vector<std::size_t> values;
+    std::size_t begin = 0;
+    while (begin <= text.size()) {
+        std::size_t end = text.find(',', begin);
+        if (end == std::string::npos) {
+            end = text.size();
+        }
+        values.push_back(parseSize(text.substr(begin, end - begin)));
+        begin = end + 1;
+    }
+    return values;
+}
+
+/**
+ * @brief Вывод справки
+ * @param program Имя программы
+ */
+void printUsage(const char* program)
+{
+    std::cerr << "Использование: " << program << " [параметры]\n"
+              << "  --min-size N      наименьший размер сообщения (по умолчанию 16)\n"
+              << "  --max-size N      наибольший размер сообщения (по умолчанию 64M, не больше 1G)\n"
+              << "  --sizes A,B,...   явный список размеров вместо ряда min..max с шагом 4\n"
+              << "  --keys A,B,...    длины ключа Гронсфельда (по умолчанию 1,7,64)\n"
+              << "  --columns A,B,... количества столбцов таблицы 1..1000 (по умолчанию 1,2,3,5,8,16,64,256,1000)\n"
+              << "  --threads A,B,... количества потоков (по умолчанию 1,2,4)\n"
+              << "  --min-time S      наименьшее время замера одного сочетания, с (по умолчанию 0.2)\n"
+              << "  --only gronsfeld|table|composite  замерять только один шифр\n"
+              << "  --output FILE     записать JSON в файл\n";
+}
+
+/**
+ * @brief Разбор параметров командной строки
+ * @param argc Количество аргументов
+ * @param argv Аргументы
+ * @param options Параметры перебора
+ * @return true, если параметры разобраны успешно
+ */
+bool parseOptions(int argc, char** argv, BenchOptions& options)
+{
+    try {
+        for (int i = 1; i < argc; i++) {
+            const std::string arg = argv[i];
+            if (i + 1 >= argc) {
+                return false;
+            }
+            const std::string value = argv[++i];
+            if (arg == "--min-size") {
+                options.minSize = parseSize(value);
+            } else if (arg == "--max-size") {
+                options.maxSize = parseSize(value);
+            } else if (arg == "--sizes") {
+                options.sizes = parseList(value);
+            } else if (arg == "--keys") {
+                options.keyLengths = parseList(value);
+            } else if (arg == "--columns") {
+                options.columns.clear();
+                for (std::size_t c : parseList(value)) {
+                    options.columns.push_back(static_cast<int>(c));
+                }
+            } else if (arg == "--threads") {
+                options.threads = parseList(value);
+            } else if (arg == "--min-time") {
+                options.minTime = std::stod(value);
+            } else if (arg == "--only") {
+                options.gronsfeld = (value == "gronsfeld");
+                options.table = (value == "table");
+                options.composite = (value == "composite");
+                if (!options.gronsfeld && !options.table && !options.composite) {
+                    return false;
+                }
+            } else if (arg == "--output") {
+                options.output = value;
+            } else {
+                return false;
+            }
+        }
+    } catch (const std::exception&) {
+        return false;
+    }
+
+    if (options.sizes.empty()) {
+        for (std::size_t size = options.minSize; size > 0 && size <= options.maxSize; size *= 4) {
+            options.sizes.push_back(size);
+        }
+    }
+    for (std::size_t keyLength : options.keyLengths) {
+        if (keyLength == 0) {
+            return false;
+        }
+    }
+    const std::size_t sizeLimit = std::size_t(1) << 30;
+    for (std::size_t size : options.sizes) {
+        if (size < 2 || size > sizeLimit) {
+            return false;
+        }
+    }
+    return true;
+}
+
+/**
+ * @brief Случайный текст из заглавных русских букв в кодировке UTF-8
+ * @param size Размер текста в байтах (округляется вниз до четного)
+ * @param seed Начальное значение генератора
+ * @return Текст из size / 2 букв
+ */
+std::string randomText(std::size_t size, unsigned seed)
+{
+    static const char letters[] = "АБВГДЕЁЖЗИЙКЛМНОПРСТУФХЦЧШЩЪЫЬЭЮЯ";
+    const std::size_t count = (sizeof(letters) - 1) / 2;
+    std::mt19937 generator(seed);
+    std::string text(size / 2 * 2, '\0');
+    for (std::size_t i = 0; i < text.size(); i += 2) {
+        const std::size_t letter = generator() % count;
+        text[i] = letters[2 * letter];
+        text[i + 1] = letters[2 * letter + 1];
+    }
+    return text;
+}
+
+/**
+ * @brief Случайный ключ Гронсфельда из русских букв
+ * @param length Длина ключа
+ * @param seed Начальное значение генератора
+ * @return Ключ
+ */
+std::wstring randomKey(std::size_t length, unsigned seed)
+{
+    std::mt19937 generator(seed);
+    std::wstring key(length, L'А');
+    for (wchar_t& c : key) {
+        c = russianAlphabet.symbols[generator() % russianAlphabet.size];
+    }
+    return key;
+}
+
+/**
+ * @brief Многократный вызов функции с замером задержки каждого вызова
+ * @param options Параметры перебора
+ * @param call Замеряемая функция
+ * @return Результат замера
+ * @details Вызовы повторяются, пока суммарное время не превысит options.minTime,
+ * но не меньше options.minIterations и не больше options.maxIterations раз
+ */
+template <class Call>
+BenchResult measure(const BenchOptions& options, Call&& call)
+{
+    using Clock = std::chrono::steady_clock;
+    call(); // Прогрев: первый вызов не учитывается
+
+    std::vector<double> samples;
+    samples.reserve(1024);
+    const std::size_t allocationsBefore = allocationCount.load();
+    double total = 0;
+    while (samples.size() < options.minIterations
+           || (total < options.minTime && samples.size() < options.maxIterations)) {
+        const Clock::time_point start = Clock::now();
+        call();
+        const double elapsed = std::chrono::duration<double>(Clock::now() - start).count();
+        samples.push_back(elapsed);
+        total += elapsed;
+    }
+
+    BenchResult result;
+    result.iterations = samples.size();
+    result.seconds = total;
+    // Выделения памяти самого массива замеров не исключаются: при росте
+    // вектора их единицы на миллионы вызовов, что не влияет на результат
+    result.allocations = static_cast<double>(allocationCount.load() - allocationsBefore) / samples.size();
+    std::sort(samples.begin(), samples.end());
+    result.p50 = samples[samples.size() / 2] * 1e9;
+    result.p99 = samples[std::min(samples.size() - 1, samples.size() * 99 / 100)] * 1e9;
+    return result;
+}
+
+/**
+ * @brief Запись результатов в формате JSON
+ */
+class JsonWriter
+{
+private:
+    std::FILE* file; ///< Файл результата
+    bool first = true; ///< Признак первой записи массива
+
+public:
+    /**
+     * @brief Конструктор, записывает начало документа
+     * @param file Открытый файл
+     */
+    explicit JsonWriter(std::FILE* file) : file(file) {
+        std::fprintf(file, "{\n  \"kernel\": \"%s\",\n  \"hardware_threads\": %u,\n  \"results\": [",
+                     shiftKernelName(), std::thread::hardware_concurrency());
+    }
+
+    /**
+     * @brief Запись результата одного сочетания
+     * @param cipher Имя шифра
+     * @param operation "encrypt" или "decrypt"
+     * @param bytes Размер сообщения в байтах
+     * @param chars Размер сообщения в символах
+     * @param key Длина ключа или количество столбцов
+     * @param threads Количество потоков
+     * @param r Результат замера
+     */
+    void add(const char* cipher, const char* operation, std::size_t bytes, std::size_t chars,
+             std::size_t key, std::size_t threads, const BenchResult& r) {
+        const double perCall = r.seconds / r.iterations;
+        std::fprintf(file, "%s\n    {\"cipher\": \"%s\", \"op\": \"%s\", \"bytes\": %zu, \"chars\": %zu, "
+                     "\"key\": %zu, \"threads\": %zu, \"iterations\": %zu, \"mb_per_s\": %.3f, "
+                     "\"ns_per_char\": %.4f, \"allocs_per_call\": %.3f, \"p50_ns\": %.0f, \"p99_ns\": %.0f}",
+                     first ? "" : ",", cipher, operation, bytes, chars, key, threads, r.iterations,
+                     bytes / perCall / 1e6, perCall * 1e9 / chars, r.allocations, r.p50, r.p99);
+        std::fflush(file);
+        first = false;
+    }
+
+    /**
+     * @brief Деструктор, записывает конец документа
+     */
+    ~JsonWriter() {
+        std::fprintf(file, "\n  ]\n}\n");
+    }
+};
+
+/**
+ * @brief Замеры modAlphaCipher
+ * @param options Параметры перебора
+ * @param json Запись результатов
+ * @details Несколько потоков замеряются только для текстов, которые
+ * параллельный режим действительно делит на части
+ */
+void benchGronsfeld(const BenchOptions& options, JsonWriter& json)
+{
+    for (std::size_t size : options.sizes) {
+        const std::string text = randomText(size, 1);
+        for (std::size_t keyLength : options.keyLengths) {
+            modAlphaCipher cipher(randomKey(keyLength, 2));
+            const std::string cipherText = cipher.encrypt(std::string_view(text));
+            for (std::size_t threads : options.threads) {
+                if (threads > 1 && text.size() < 2 * modAlphaCipher::defaultParallelChunk) {
+                    continue;
+                }
+                cipher.setParallelism(threads);
+                BenchResult r = measure(options, [&] { cipher.encrypt(std::string_view(text)); });
+                json.add("gronsfeld", "encrypt", text.size(), text.size() / 2, keyLength, threads, r);
+                r = measure(options, [&] { cipher.decrypt(std::string_view(cipherText)); });
+                json.add("gronsfeld", "decrypt", text.size(), text.size() / 2, keyLength, threads, r);
+            }
+        }
+    }
+}
+
+/**
+ * @brief Замеры TableCipher
+ * @param options Параметры перебора
+ * @param json Запись результатов
+ * @details Пропускаются сочетания, недопустимые для шифра:
+ * ключ длиннее текста и таблица больше 10000 строк. Несколько потоков
+ * замеряются только для текстов, которые параллельный режим делит на части
+ */
+void benchTable(const BenchOptions& options, JsonWriter& json)
+{
+    for (std::size_t size : options.sizes) {
+        const std::string text = randomText(size, 1);
+        const std::size_t chars = text.size() / 2;
+        for (int columns : options.columns) {
+            if (columns < 1 || columns > 1000 || static_cast<std::size_t>(columns) > chars
+                || (chars + columns - 1) / columns > 10000) {
+                continue;
+            }
+            TableCipher cipher(columns);
+            const std::string cipherText = cipher.encrypt(std::string_view(text));
+            for (std::size_t threads : options.threads) {
+                if (threads > 1 && text.size() < 2 * TableCipher::defaultParallelChunk) {
+                    continue;
+                }
+                cipher.setParallelism(threads);
+                BenchResult r = measure(options, [&] { cipher.encrypt(std::string_view(text)); });
+                json.add("table", "encrypt", text.size(), chars, columns, threads, r);
+                r = measure(options, [&] { cipher.decrypt(std::string_view(cipherText)); });
+                json.add("table", "decrypt", text.size(), chars, columns, threads, r);
+            }
+        }
+    }
+}
+
+/**
+ * @brief Замеры CompositeCipher
+ * @param options Параметры перебора
+ * @param json Запись результатов
+ * @details Для каждого сочетания замеряется составной шифр (cipher "composite")
+ * и последовательное применение modAlphaCipher и TableCipher (cipher "chained")
+ * с тем же результатом. Ключ Гронсфельда берется первой длины из списка,
+ * в поле key записывается количество столбцов
+ */
+void benchComposite(const BenchOptions& options, JsonWriter& json)
+{
+    const std::wstring key = randomKey(options.keyLengths.front(), 2);
+    for (std::size_t size : options.sizes) {
+        const std::string text = randomText(size, 1);
+        const std::size_t chars = text.size() / 2;
+        for (int columns : options.columns) {
+            if (columns < 1 || columns > 1000 || static_cast<std::size_t>(columns) > chars
+                || (chars + columns - 1) / columns > 10000) {
+                continue;
+            }
+            CompositeCipher composite(key, columns);
+            modAlphaCipher gronsfeld(key);
+            TableCipher table(columns);
+            const std::string cipherText = composite.encrypt(std::string_view(text));
+            BenchResult r = measure(options, [&] { composite.encrypt(std::string_view(text)); });
+            json.add("composite", "encrypt", text.size(), chars, columns, 1, r);
+            r = measure(options, [&] { composite.decrypt(std::string_view(cipherText)); });
+            json.add("composite", "decrypt", text.size(), chars, columns, 1, r);
+            r = measure(options, [&] { table.encrypt(std::string_view(gronsfeld.encrypt(std::string_view(text)))); });
+            json.add("chained", "encrypt", text.size(), chars, columns, 1, r);
+            r = measure(options, [&] { gronsfeld.decrypt(std::string_view(table.decrypt(std::string_view(cipherText)))); });
+            json.add("chained", "decrypt", text.size(), chars, columns, 1, r);
+        }
+    }
+}
+
+} // namespace
+
+/**
+ * @brief Главная функция программы замеров
+ * @param argc Количество аргументов
+ * @param argv Аргументы командной строки
+ * @return 0 при успехе, 1 при ошибке
+ */
+int main(int argc, char** argv)
+{
+    // Классы символов нужны шифру таблицы; на машинах без русской локали
+    // годится любая локаль UTF-8
+    try {
+        std::locale::global(std::locale("ru_RU.UTF-8"));
+    } catch (const std::runtime_error&) {
+        try {
+            std::locale::global(std::locale("C.UTF-8"));
+        } catch (const std::runtime_error&) {
+            std::cerr << "Ошибка: не найдена локаль ru_RU.UTF-8 или C.UTF-8\n";
+            return 1;
+        }
+    }
+
+    BenchOptions options;
+    if (!parseOptions(argc, argv, options)) {
+        printUsage(argv[0]);
+        return 1;
+    }
+
+    std::FILE* file = stdout;
+    if (!options.output.empty()) {
+        file = std::fopen(options.output.c_str(), "w");
+        if (!file) {
+            std::cerr << "Не удалось открыть файл " << options.output << ": " << std::strerror(errno) << "\n";
+            return 1;
+        }
+    }
+
+    {
+        JsonWriter json(file);
+        if (options.gronsfeld) {
+            benchGronsfeld(options, json);
+        }
+        if (options.table) {
+            benchTable(options, json);
+        }
+        if (options.composite) {
+            benchComposite(options, json);
+        }
+    }
+
+    if (file != stdout) {
+        std::fclose(file);
+    }
+    return 0;
+}
@@ -0,0 +1,77 @@
+#pragma once
+#include <cstddef>
+#include <string>
+#include <string_view>
+#include <vector>
+#include "cipherResult.h"
+
+/**
+ * @file
+ * @author Ганьшин В.А.
+ * @version 1.0
+ * @date 17.12.2025
+ * @brief Пакетная обработка сообщений
+ * @details Сообщения пакета хранятся подряд в одной строке (арене),
+ * границы сообщений задаются массивом смещений: сообщение i занимает
+ * промежуток [offsets[i], offsets[i + 1]). Результаты возвращаются так же.
+ */
+
+/**
+ * @brief Результат пакетной обработки сообщений
+ * @tparam Char Тип символа (wchar_t или char для UTF-8)
+ * @details Ошибка в одном сообщении не прерывает обработку пакета:
+ * результат такого сообщения пустой, а код ошибки записывается в errors.
+ * Текст сообщения об ошибке можно получить через errorMessage() шифра
+ */
+template <class Char>
+struct BatchResult {
+    std::basic_string<Char> data; ///< Результаты всех сообщений подряд
+    std::vector<std::size_t> offsets; ///< Начало результата i-го сообщения; последний элемент - конец данных
+    std::vector<CipherError> errors; ///< Ошибка i-го сообщения (код CipherErrc::ok при успехе)
+    std::size_t failed = 0; ///< Количество сообщений с ошибками
+
+    /**
+     * @brief Количество сообщений в пакете
+     * @return Количество сообщений
+     */
+    std::size_t size() const {
+        return errors.size();
+    }
+
+    /**
+     * @brief Признак успешной обработки сообщения
+     * @param i Номер сообщения
+     * @return true, если сообщение обработано без ошибок
+     */
+    bool ok(std::size_t i) const {
+        return !errors[i];
+    }
+
+    /**
+     * @brief Результат обработки сообщения
+     * @param i Номер сообщения
+     * @return Результат (пустой для сообщения с ошибкой)
+     */
+    std::basic_string_view<Char> message(std::size_t i) const {
+        return std::basic_string_view<Char>(data.data() + offsets[i], offsets[i + 1] - offsets[i]);
+    }
+};
+
+/**
+ * @brief Проверка массива смещений пакета
+ * @param offsets Смещения сообщений
+ * @param arenaSize Длина арены
+ * @return true, если смещения не убывают и не выходят за пределы арены
+ */
+inline bool batchOffsetsValid(const std::vector<std::size_t>& offsets, std::size_t arenaSize)
+{
+    if (offsets.empty()) {
+        return false;
+    }
+    for (std::size_t i = 1; i < offsets.size(); i++) {
+        if (offsets[i] < offsets[i - 1]) {
+            return false;
+        }
+    }
+    return offsets.back() <= arenaSize;
+}
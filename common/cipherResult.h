@@ -0,0 +1,171 @@
+#pragma once
+#include <cstddef>
+#include <optional>
+#include <utility>
+
+/**
+ * @file
+ * @author Ганьшин В.А.
+ * @version 1.0
+ * @date 17.12.2025
+ * @brief Коды ошибок и результат операций шифрования без исключений
+ * @details Общий модуль для шифров Гронсфельда и табличной перестановки.
+ * Методы try* возвращают CipherResult: значение или код ошибки с позицией
+ * символа, на котором обнаружена ошибка. Методы, выбрасывающие исключения,
+ * построены поверх них и передают тот же код в исключении.
+ */
+
+/**
+ * @brief Код ошибки шифрования
+ */
+enum class CipherErrc {
+    ok = 0, ///< Ошибки нет
+    emptyKey, ///< Пустой ключ
+    invalidKeySymbol, ///< Недопустимый символ в ключе
+    noKeyLetters, ///< Ключ не содержит букв алфавита
+    keyNotPositive, ///< Ключ таблицы не положительный
+    keyTooLarge, ///< Ключ таблицы больше 1000
+    emptyText, ///< Пустой текст
+    invalidSymbol, ///< Недопустимый символ или некорректная последовательность UTF-8
+    noLetters, ///< Текст не содержит букв алфавита
+    keyLongerThanText, ///< Ключ таблицы больше длины текста
+    tableTooLarge, ///< Таблица больше 10000 строк или текст слишком длинный для маршрута таблицы
+    bufferTooSmall, ///< Недостаточный размер буфера для результата
+    inPlaceUnsupported, ///< Обработка на месте невозможна (для данного алфавита или файла)
+    invalidBatchOffsets, ///< Некорректные смещения сообщений пакета
+    ioError, ///< Ошибка чтения или записи файла
+    invalidRoute ///< Некорректный маршрут таблицы или маршрут, не поддерживаемый для файлов
+};
+
+/**
+ * @brief Описание ошибки шифрования
+ */
+struct CipherError {
+    CipherErrc code = CipherErrc::ok; ///< Код ошибки
+    std::size_t offset = 0; ///< Позиция ошибочного символа (в символах ключа или текста, для UTF-8 - в байтах); для CipherErrc::ioError - значение errno
+
+    /**
+     * @brief Признак ошибки
+     * @return true, если код отличен от CipherErrc::ok
+     */
+    explicit operator bool() const {
+        return code != CipherErrc::ok;
+    }
+};
+
+/**
+ * @brief Результат операции: значение или ошибка
+ * @tparam T Тип значения
+ * @details Упрощенный аналог std::expected из C++23.
+ *
+ * Пример использования:
+ * @code
+ * CipherResult<std::string> r = cipher.tryEncrypt(std::string_view(text));
+ * if (r) {
+ *     write(*r);
+ * } else if (r.error().code == CipherErrc::invalidSymbol) {
+ *     skipRecord(r.error().offset);
+ * }
+ * @endcode
+ */
+template <class T>
+class CipherResult
+{
+private:
+    std::optional<T> val; ///< Значение (пусто при ошибке)
+    CipherError err; ///< Ошибка (код ok при успехе)
+
+public:
+    /**
+     * @brief Успешный результат
+     * @param value Значение
+     */
+    CipherResult(T value) : val(std::move(value)) {}
+
+    /**
+     * @brief Результат с ошибкой
+     * @param error Описание ошибки
+     */
+    CipherResult(CipherError error) : err(error) {}
+
+    /**
+     * @brief Результат с ошибкой
+     * @param code Код ошибки
+     * @param offset Позиция ошибочного символа
+     */
+    CipherResult(CipherErrc code, std::size_t offset = 0) : err{code, offset} {}
+
+    /**
+     * @brief Признак успешного результата
+     * @return true, если результат содержит значение
+     */
+    bool hasValue() const {
+        return val.has_value();
+    }
+
+    /**
+     * @brief Признак успешного результата
+     * @return true, если результат содержит значение
+     */
+    explicit operator bool() const {
+        return val.has_value();
+    }
+
+    /**
+     * @brief Значение результата
+     * @return Ссылка на значение
+     * @warning Вызывается только для успешного результата
+     */
+    T& value() {
+        return *val;
+    }
+
+    /**
+     * @brief Значение результата
+     * @return Ссылка на значение
+     * @warning Вызывается только для успешного результата
+     */
+    const T& value() const {
+        return *val;
+    }
+
+    /**
+     * @brief Значение результата
+     * @return Ссылка на значение
+     */
+    T& operator*() {
+        return *val;
+    }
+
+    /**
+     * @brief Значение результата
+     * @return Ссылка на значение
+     */
+    const T& operator*() const {
+        return *val;
+    }
+
+    /**
+     * @brief Доступ к членам значения
+     * @return Указатель на значение
+     */
+    T* operator->() {
+        return &*val;
+    }
+
+    /**
+     * @brief Доступ к членам значения
+     * @return Указатель на значение
+     */
+    const T* operator->() const {
+        return &*val;
+    }
+
+    /**
+     * @brief Описание ошибки
+     * @return Ошибка; для успешного результата код CipherErrc::ok
+     */
+    const CipherError& error() const {
+        return err;
+    }
+};
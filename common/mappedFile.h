@@ -0,0 +1,78 @@
+#pragma once
+#include <cstddef>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+/**
+ * @file
+ * @author Ганьшин В.А.
+ * @version 1.0
+ * @date 17.12.2025
+ * @brief Файл, отображенный в память
+ * @details Общий модуль для программ шифрования методом Гронсфельда
+ * и табличной маршрутной перестановки
+ */
+
+/**
+ * @brief Файл, отображенный в память
+ * @details Освобождает отображение и закрывает файл в деструкторе.
+ * При ошибке методы возвращают false, причина остается в errno
+ */
+struct MappedFile {
+    int fd = -1; ///< Дескриптор файла
+    char* data = nullptr; ///< Начало отображения (nullptr для пустого файла)
+    std::size_t size = 0; ///< Размер отображения в байтах
+
+    /**
+     * @brief Отображение открытого файла fd в память
+     * @param length Длина отображения
+     * @param protection PROT_READ или PROT_READ | PROT_WRITE
+     * @return true при успехе
+     */
+    bool map(std::size_t length, int protection) {
+        size = length;
+        if (length == 0) {
+            return true;
+        }
+        void* p = mmap(nullptr, length, protection, MAP_SHARED, fd, 0);
+        if (p == MAP_FAILED) {
+            return false;
+        }
+        data = static_cast<char*>(p);
+        madvise(data, length, MADV_SEQUENTIAL);
+        return true;
+    }
+
+    /**
+     * @brief Открытие файла и отображение всего файла только для чтения
+     * @param path Путь к файлу
+     * @param info Сведения о файле (fstat)
+     * @return true при успехе
+     */
+    bool openForReading(const char* path, struct stat& info) {
+        fd = open(path, O_RDONLY);
+        return fd >= 0 && fstat(fd, &info) == 0 && map(static_cast<std::size_t>(info.st_size), PROT_READ);
+    }
+
+    /**
+     * @brief Освобождение отображения (файл остается открытым)
+     */
+    void unmap() {
+        if (data != nullptr) {
+            munmap(data, size);
+            data = nullptr;
+        }
+    }
+
+    /**
+     * @brief Деструктор: освобождение отображения и закрытие файла
+     */
+    ~MappedFile() {
+        unmap();
+        if (fd >= 0) {
+            close(fd);
+        }
+    }
+};
@@ -0,0 +1,116 @@
+#include "threadPool.h"
+
+/**
+ * @file threadPool.cpp
+ * @brief Реализация пула потоков
+ */
+
+/**
+ * @brief Конструктор пула
+ * @param workers Количество одновременно выполняемых задач
+ */
+ThreadPool::ThreadPool(std::size_t workers)
+{
+    if (workers == 0) {
+        workers = 1;
+    }
+    threads.reserve(workers - 1);
+    for (std::size_t i = 1; i < workers; i++) {
+        threads.emplace_back(&ThreadPool::workerLoop, this);
+    }
+}
+
+/**
+ * @brief Деструктор, останавливает рабочие потоки
+ */
+ThreadPool::~ThreadPool()
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    wake.notify_all();
+    for (std::thread& t : threads) {
+        t.join();
+    }
+}
+
+/**
+ * @brief Выполнение задач текущего задания, пока они не закончатся
+ */
+void ThreadPool::drain()
+{
+    for (;;) {
+        std::size_t i = next.fetch_add(1);
+        if (i >= taskCount) {
+            return;
+        }
+        try {
+            (*task)(i);
+        } catch (...) {
+            std::lock_guard<std::mutex> lock(mutex);
+            if (!error) {
+                error = std::current_exception();
+            }
+        }
+    }
+}
+
+/**
+ * @brief Цикл рабочего потока
+ */
+void ThreadPool::workerLoop()
+{
+    std::uint64_t seen = 0;
+    for (;;) {
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            wake.wait(lock, [&] { return stopping || generation != seen; });
+            if (stopping) {
+                return;
+            }
+            seen = generation;
+        }
+        drain();
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            if (--active == 0) {
+                finished.notify_one();
+            }
+        }
+    }
+}
+
+/**
+ * @brief Выполнение задач и ожидание их завершения
+ * @param count Количество задач
+ * @param job Функция, вызываемая для каждого номера задачи
+ * @throw Первое исключение, выброшенное одной из задач
+ */
+void ThreadPool::run(std::size_t count, const std::function<void(std::size_t)>& job)
+{
+    std::lock_guard<std::mutex> order(runMutex);
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        task = &job;
+        taskCount = count;
+        next = 0;
+        error = nullptr;
+        active = threads.size();
+        ++generation;
+    }
+    wake.notify_all();
+    drain();
+
+    std::exception_ptr failure;
+    {
+        std::unique_lock<std::mutex> lock(mutex);
+        finished.wait(lock, [&] { return active == 0; });
+        task = nullptr;
+        failure = error;
+        error = nullptr;
+    }
+    if (failure) {
+        std::rethrow_exception(failure);
+    }
+}
@@ -0,0 +1,90 @@
+#pragma once
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/**
+ * @file
+ * @author Ганьшин В.А.
+ * @version 1.0
+ * @date 17.12.2025
+ * @brief Пул потоков для параллельной обработки больших текстов
+ */
+
+/**
+ * @brief Пул потоков фиксированного размера
+ * @details Метод run() раздает задачи 0..count-1 рабочим потокам и вызывающему потоку
+ * и возвращает управление после выполнения всех задач.
+ * Одновременные вызовы run() из разных потоков выполняются по очереди.
+ *
+ * Пример использования:
+ * @code
+ * ThreadPool pool(8);
+ * pool.run(ranges, [&](std::size_t i) { process(i); });
+ * @endcode
+ * @warning Вызов run() изнутри задачи того же пула приводит к взаимной блокировке
+ */
+class ThreadPool
+{
+private:
+    std::vector<std::thread> threads; ///< Рабочие потоки (на один меньше размера пула)
+    std::mutex mutex; ///< Защита состояния задания
+    std::mutex runMutex; ///< Очередность вызовов run()
+    std::condition_variable wake; ///< Сигнал рабочим потокам о новом задании
+    std::condition_variable finished; ///< Сигнал о завершении задания всеми потоками
+    const std::function<void(std::size_t)>* task = nullptr; ///< Текущее задание
+    std::size_t taskCount = 0; ///< Количество задач в текущем задании
+    std::atomic<std::size_t> next{0}; ///< Номер следующей невыданной задачи
+    std::size_t active = 0; ///< Количество рабочих потоков, не закончивших задание
+    std::uint64_t generation = 0; ///< Номер текущего задания
+    bool stopping = false; ///< Признак остановки пула
+    std::exception_ptr error; ///< Первое исключение, выброшенное задачей
+
+    /**
+     * @brief Цикл рабочего потока
+     */
+    void workerLoop();
+
+    /**
+     * @brief Выполнение задач текущего задания, пока они не закончатся
+     */
+    void drain();
+
+public:
+    /**
+     * @brief Конструктор пула
+     * @param workers Количество одновременно выполняемых задач (не меньше 1),
+     * по умолчанию - количество ядер процессора
+     */
+    explicit ThreadPool(std::size_t workers = std::thread::hardware_concurrency());
+
+    /**
+     * @brief Деструктор, останавливает рабочие потоки
+     */
+    ~ThreadPool();
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    /**
+     * @brief Размер пула
+     * @return Количество одновременно выполняемых задач
+     */
+    std::size_t size() const {
+        return threads.size() + 1;
+    }
+
+    /**
+     * @brief Выполнение задач и ожидание их завершения
+     * @param count Количество задач
+     * @param job Функция, вызываемая для каждого номера задачи от 0 до count-1
+     * @throw Первое исключение, выброшенное одной из задач (остальные задачи при этом выполняются)
+     */
+    void run(std::size_t count, const std::function<void(std::size_t)>& job);
+};
@@ -0,0 +1,131 @@
+#pragma once
+#include <cstddef>
+
+/**
+ * @file
+ * @author Ганьшин В.А.
+ * @version 1.0
+ * @date 17.12.2025
+ * @brief Разбор и запись символов UTF-8
+ * @details Общий модуль для программ шифрования методом Гронсфельда
+ * и табличной маршрутной перестановки
+ */
+
+/// Признак некорректной последовательности UTF-8 (совпадает с WEOF)
+constexpr char32_t utf8Invalid = 0xFFFFFFFF;
+
+/**
+ * @brief Декодирование одного символа UTF-8
+ * @param p Текущая позиция в строке, сдвигается за прочитанный символ
+ * @param end Конец строки
+ * @return Код символа или utf8Invalid для некорректной, неполной
+ * или избыточной (overlong) последовательности; в этом случае пропускается один байт
+ */
+inline char32_t utf8Decode(const char*& p, const char* end)
+{
+    const unsigned char b0 = static_cast<unsigned char>(*p);
+    if (b0 < 0x80) {
+        ++p;
+        return b0;
+    }
+
+    std::size_t length;
+    char32_t c;
+    char32_t minimum;
+    if (b0 >= 0xC2 && b0 <= 0xDF) {
+        length = 2; c = b0 & 0x1F; minimum = 0x80;
+    } else if (b0 >= 0xE0 && b0 <= 0xEF) {
+        length = 3; c = b0 & 0x0F; minimum = 0x800;
+    } else if (b0 >= 0xF0 && b0 <= 0xF4) {
+        length = 4; c = b0 & 0x07; minimum = 0x10000;
+    } else {
+        ++p;
+        return utf8Invalid;
+    }
+
+    if (static_cast<std::size_t>(end - p) < length) {
+        ++p;
+        return utf8Invalid;
+    }
+    for (std::size_t i = 1; i < length; i++) {
+        const unsigned char b = static_cast<unsigned char>(p[i]);
+        if ((b & 0xC0) != 0x80) {
+            ++p;
+            return utf8Invalid;
+        }
+        c = (c << 6) | (b & 0x3F);
+    }
+    if (c < minimum || c > 0x10FFFF || (c >= 0xD800 && c <= 0xDFFF)) {
+        ++p;
+        return utf8Invalid;
+    }
+    p += length;
+    return c;
+}
+
+/**
+ * @brief Длина последовательности UTF-8 по первому байту
+ * @param lead Первый байт последовательности
+ * @return Ожидаемое количество байт (от 1 до 4); для недопустимого первого байта - 1
+ */
+constexpr std::size_t utf8SequenceLength(unsigned char lead)
+{
+    return (lead >= 0xC2 && lead <= 0xDF) ? 2 :
+           (lead >= 0xE0 && lead <= 0xEF) ? 3 :
+           (lead >= 0xF0 && lead <= 0xF4) ? 4 : 1;
+}
+
+/**
+ * @brief Длина незавершенной последовательности в конце фрагмента
+ * @details Используется при обработке потока по частям: хвост, разрезанный
+ * границей фрагмента, откладывается до поступления следующего фрагмента
+ * @param begin Начало фрагмента
+ * @param end Конец фрагмента
+ * @return Количество байт незавершенного символа в конце фрагмента (0, если его нет)
+ */
+inline std::size_t utf8IncompleteTail(const char* begin, const char* end)
+{
+    for (std::size_t back = 1; back <= 3 && back <= static_cast<std::size_t>(end - begin); back++) {
+        const unsigned char b = static_cast<unsigned char>(end[-static_cast<std::ptrdiff_t>(back)]);
+        if ((b & 0xC0) != 0x80) {
+            return utf8SequenceLength(b) > back ? back : 0;
+        }
+    }
+    return 0;
+}
+
+/**
+ * @brief Длина символа в кодировке UTF-8
+ * @param c Код символа
+ * @return Количество байт (от 1 до 4)
+ */
+constexpr std::size_t utf8Length(char32_t c)
+{
+    return c < 0x80 ? 1 : c < 0x800 ? 2 : c < 0x10000 ? 3 : 4;
+}
+
+/**
+ * @brief Запись одного символа в кодировке UTF-8
+ * @param c Код символа
+ * @param out Позиция записи
+ * @return Позиция сразу после записанного символа
+ */
+inline char* utf8Encode(char32_t c, char* out)
+{
+    if (c < 0x80) {
+        *out++ = static_cast<char>(c);
+    } else if (c < 0x800) {
+        *out++ = static_cast<char>(0xC0 | (c >> 6));
+        *out++ = static_cast<char>(0x80 | (c & 0x3F));
+    } else if (c < 0x10000) {
+        *out++ = static_cast<char>(0xE0 | (c >> 12));
+        *out++ = static_cast<char>(0x80 | ((c >> 6) & 0x3F));
+        *out++ = static_cast<char>(0x80 | (c & 0x3F));
+    } else {
+        *out++ = static_cast<char>(0xF0 | (c >> 18));
+        *out++ = static_cast<char>(0x80 | ((c >> 12) & 0x3F));
+        *out++ = static_cast<char>(0x80 | ((c >> 6) & 0x3F));
+        *out++ = static_cast<char>(0x80 | (c & 0x3F));
+    }
+    return out;
+}
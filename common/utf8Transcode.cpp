@@ -0,0 +1,468 @@
+#include "utf8Transcode.h"
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__)) && __SIZEOF_WCHAR_T__ == 4
+#define UTF8_X86_KERNELS
+#include <immintrin.h>
+#endif
+#include <stdexcept>
+#include "utf8.h"
+
+/**
+ * @file utf8Transcode.cpp
+ * @brief Реализация перекодирования UTF-8 в широкие строки и обратно
+ * @details Векторный разбор загружает 16 байт с текущей границы символа.
+ * Байты ASCII распознаются по старшему биту (movemask). Двухбайтовые
+ * последовательности проверяются парами как 16-битные числа little-endian:
+ * (v & 0xC0E0) == 0x80C0 означает первый байт 110xxxxx и второй 10xxxxxx,
+ * а ненулевые биты 0x1E первого байта исключают избыточные записи C0 и C1.
+ * Если блок начинается с отрезка ASCII или двухбайтовых символов, записывается
+ * весь блок, а позиция сдвигается на длину отрезка (номер первого нулевого
+ * бита маски). Так смешанный текст (слова кириллицы через пробел) тоже
+ * обрабатывается векторно. Остальные символы разбираются по одному через
+ * utf8Decode(). Кодирование устроено так же: восемь символов проверяются
+ * на диапазоны 0..0x7F и 0x80..0x7FF и упаковываются в 8 или 16 байт; при SSSE3
+ * блок с любым чередованием этих диапазонов сжимается одной перестановкой.
+ * Векторная запись может выходить за конец отрезка, поэтому буфер UTF-8
+ * выделяется с запасом encodeSlack байт.
+ */
+
+namespace {
+
+/// Тип указателя на реализацию декодирования
+using DecodeKernel = bool (*)(const unsigned char*, std::size_t, wchar_t*, std::size_t&, std::size_t&);
+
+/// Тип указателя на реализацию кодирования
+using EncodeKernel = bool (*)(const wchar_t*, std::size_t, char*, std::size_t&, std::size_t&);
+
+/// Запас буфера UTF-8 для векторной записи за концом отрезка
+constexpr std::size_t encodeSlack = 16;
+
+/**
+ * @brief Скалярное декодирование символов
+ * @param in Строка UTF-8
+ * @param i Позиция первого байта, на выходе - позиция после разобранных символов
+ * или позиция ошибки
+ * @param stop Позиция, до которой разбираются символы (последний символ может выйти за нее)
+ * @param length Длина строки в байтах
+ * @param out Буфер широких символов
+ * @param o Количество записанных символов, увеличивается
+ * @return false, если найдена некорректная последовательность
+ */
+bool decodeRun(const unsigned char* in, std::size_t& i, std::size_t stop, std::size_t length, wchar_t* out, std::size_t& o)
+{
+    while (i < stop) {
+        const unsigned char b0 = in[i];
+        if (b0 < 0x80) {
+            out[o++] = static_cast<wchar_t>(b0);
+            i++;
+            continue;
+        }
+        if (b0 >= 0xC2 && b0 <= 0xDF && i + 1 < length && (in[i + 1] & 0xC0) == 0x80) {
+            out[o++] = static_cast<wchar_t>(((b0 & 0x1F) << 6) | (in[i + 1] & 0x3F));
+            i += 2;
+            continue;
+        }
+        const char* p = reinterpret_cast<const char*>(in + i);
+        const char32_t c = utf8Decode(p, reinterpret_cast<const char*>(in + length));
+        if (c == utf8Invalid) {
+            return false;
+        }
+        out[o++] = static_cast<wchar_t>(c);
+        i = static_cast<std::size_t>(reinterpret_cast<const unsigned char*>(p) - in);
+    }
+    return true;
+}
+
+/**
+ * @brief Скалярное кодирование символов
+ * @param in Широкая строка
+ * @param i Позиция первого символа, на выходе - позиция после записанных символов
+ * или позиция ошибки
+ * @param stop Позиция, до которой кодируются символы
+ * @param out Буфер UTF-8
+ * @param o Количество записанных байт, увеличивается
+ * @return false, если найден суррогат или код больше U+10FFFF
+ */
+bool encodeRun(const wchar_t* in, std::size_t& i, std::size_t stop, char* out, std::size_t& o)
+{
+    for (; i < stop; i++) {
+        const char32_t c = static_cast<char32_t>(in[i]);
+        if (c < 0x80) {
+            out[o++] = static_cast<char>(c);
+        } else if (c < 0x800) {
+            out[o++] = static_cast<char>(0xC0 | (c >> 6));
+            out[o++] = static_cast<char>(0x80 | (c & 0x3F));
+        } else if (c > 0x10FFFF || (c >= 0xD800 && c <= 0xDFFF)) {
+            return false;
+        } else {
+            o = static_cast<std::size_t>(utf8Encode(c, out + o) - out);
+        }
+    }
+    return true;
+}
+
+/**
+ * @brief Скалярная реализация декодирования
+ * @param in Строка UTF-8
+ * @param length Длина строки в байтах
+ * @param out Буфер не меньше length символов
+ * @param i Позиция ошибки в байтах (length при успехе)
+ * @param o Количество записанных символов
+ * @return false, если найдена некорректная последовательность
+ */
+bool decodeScalar(const unsigned char* in, std::size_t length, wchar_t* out, std::size_t& i, std::size_t& o)
+{
+    return decodeRun(in, i, length, length, out, o);
+}
+
+/**
+ * @brief Скалярная реализация кодирования
+ * @param in Широкая строка
+ * @param length Количество символов
+ * @param out Буфер не меньше длины результата плюс encodeSlack байт
+ * @param i Позиция ошибки в символах (length при успехе)
+ * @param o Количество записанных байт
+ * @return false, если найден суррогат или код больше U+10FFFF
+ */
+bool encodeScalar(const wchar_t* in, std::size_t length, char* out, std::size_t& i, std::size_t& o)
+{
+    return encodeRun(in, i, length, out, o);
+}
+
+#ifdef UTF8_X86_KERNELS
+
+/**
+ * @brief Реализация декодирования на SSE2
+ * @param in Строка UTF-8
+ * @param length Длина строки в байтах
+ * @param out Буфер не меньше length символов
+ * @param i Позиция ошибки в байтах (length при успехе)
+ * @param o Количество записанных символов
+ * @return false, если найдена некорректная последовательность
+ */
+__attribute__((target("sse2")))
+bool decodeSse2(const unsigned char* in, std::size_t length, wchar_t* out, std::size_t& i, std::size_t& o)
+{
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i formMask = _mm_set1_epi16(static_cast<short>(0xC0E0));
+    const __m128i formValue = _mm_set1_epi16(static_cast<short>(0x80C0));
+    const __m128i overlongMask = _mm_set1_epi16(0x001E);
+    const __m128i leadBits = _mm_set1_epi16(0x001F);
+    const __m128i continuationBits = _mm_set1_epi16(0x003F);
+
+    // Символов не больше, чем байт, поэтому o <= i и запись 16 символов
+    // при i + 16 <= length не выходит за буфер
+    while (i + 16 <= length) {
+        const __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(in + i));
+        const unsigned nonAscii = static_cast<unsigned>(_mm_movemask_epi8(v));
+        if ((nonAscii & 1) == 0) {
+            const __m128i low = _mm_unpacklo_epi8(v, zero);
+            const __m128i high = _mm_unpackhi_epi8(v, zero);
+            __m128i* dst = reinterpret_cast<__m128i*>(out + o);
+            _mm_storeu_si128(dst, _mm_unpacklo_epi16(low, zero));
+            _mm_storeu_si128(dst + 1, _mm_unpackhi_epi16(low, zero));
+            _mm_storeu_si128(dst + 2, _mm_unpacklo_epi16(high, zero));
+            _mm_storeu_si128(dst + 3, _mm_unpackhi_epi16(high, zero));
+            const std::size_t n = nonAscii == 0 ? 16 : static_cast<std::size_t>(__builtin_ctz(nonAscii));
+            i += n;
+            o += n;
+            continue;
+        }
+
+        const __m128i form = _mm_cmpeq_epi16(_mm_and_si128(v, formMask), formValue);
+        const __m128i overlong = _mm_cmpeq_epi16(_mm_and_si128(v, overlongMask), zero);
+        const unsigned pairs = static_cast<unsigned>(_mm_movemask_epi8(_mm_andnot_si128(overlong, form)));
+        if (pairs & 1) {
+            const __m128i code = _mm_or_si128(_mm_slli_epi16(_mm_and_si128(v, leadBits), 6),
+                                              _mm_and_si128(_mm_srli_epi16(v, 8), continuationBits));
+            __m128i* dst = reinterpret_cast<__m128i*>(out + o);
+            _mm_storeu_si128(dst, _mm_unpacklo_epi16(code, zero));
+            _mm_storeu_si128(dst + 1, _mm_unpackhi_epi16(code, zero));
+            const std::size_t n = static_cast<std::size_t>(__builtin_ctz(~pairs)) / 2;
+            i += 2 * n;
+            o += n;
+            continue;
+        }
+
+        if (!decodeRun(in, i, i + 1, length, out, o)) {
+            return false;
+        }
+    }
+    return decodeRun(in, i, length, length, out, o);
+}
+
+/**
+ * @brief Реализация кодирования на SSE2
+ * @param in Широкая строка
+ * @param length Количество символов
+ * @param out Буфер не меньше длины результата плюс encodeSlack байт
+ * @param i Позиция ошибки в символах (length при успехе)
+ * @param o Количество записанных байт
+ * @return false, если найден суррогат или код больше U+10FFFF
+ */
+__attribute__((target("sse2")))
+bool encodeSse2(const wchar_t* in, std::size_t length, char* out, std::size_t& i, std::size_t& o)
+{
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i notAscii = _mm_set1_epi32(~0x7F);
+    const __m128i notTwoByte = _mm_set1_epi32(~0x7FF);
+    const __m128i continuationBits = _mm_set1_epi16(0x003F);
+    const __m128i leadPrefix = _mm_set1_epi16(0x00C0);
+    const __m128i continuationPrefix = _mm_set1_epi16(static_cast<short>(0x8000));
+
+    // Запись 8 или 16 байт может выйти за конец отрезка не больше чем
+    // на encodeSlack байт
+    while (i + 8 <= length) {
+        const __m128i a = _mm_loadu_si128(reinterpret_cast<const __m128i*>(in + i));
+        const __m128i b = _mm_loadu_si128(reinterpret_cast<const __m128i*>(in + i + 4));
+        const __m128i asciiA = _mm_cmpeq_epi32(_mm_and_si128(a, notAscii), zero);
+        const __m128i asciiB = _mm_cmpeq_epi32(_mm_and_si128(b, notAscii), zero);
+        const unsigned ascii = static_cast<unsigned>(_mm_movemask_ps(_mm_castsi128_ps(asciiA)))
+                             | static_cast<unsigned>(_mm_movemask_ps(_mm_castsi128_ps(asciiB))) << 4;
+        if (ascii & 1) {
+            const __m128i packed = _mm_packs_epi32(a, b);
+            _mm_storel_epi64(reinterpret_cast<__m128i*>(out + o), _mm_packus_epi16(packed, packed));
+            const std::size_t n = static_cast<std::size_t>(__builtin_ctz(~ascii));
+            i += n;
+            o += n;
+            continue;
+        }
+
+        const __m128i twoByteA = _mm_andnot_si128(asciiA, _mm_cmpeq_epi32(_mm_and_si128(a, notTwoByte), zero));
+        const __m128i twoByteB = _mm_andnot_si128(asciiB, _mm_cmpeq_epi32(_mm_and_si128(b, notTwoByte), zero));
+        const unsigned twoByte = static_cast<unsigned>(_mm_movemask_ps(_mm_castsi128_ps(twoByteA)))
+                               | static_cast<unsigned>(_mm_movemask_ps(_mm_castsi128_ps(twoByteB))) << 4;
+        if (twoByte & 1) {
+            // Коды двухбайтовых символов меньше 0x800 и упаковываются без насыщения;
+            // остальные дорожки записываются мусором и перезаписываются следующим шагом
+            const __m128i code = _mm_packs_epi32(a, b);
+            const __m128i lead = _mm_or_si128(_mm_srli_epi16(code, 6), leadPrefix);
+            const __m128i continuation = _mm_or_si128(_mm_slli_epi16(_mm_and_si128(code, continuationBits), 8), continuationPrefix);
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(out + o), _mm_or_si128(lead, continuation));
+            const std::size_t n = static_cast<std::size_t>(__builtin_ctz(~twoByte));
+            i += n;
+            o += 2 * n;
+            continue;
+        }
+
+        if (!encodeRun(in, i, i + 1, out, o)) {
+            return false;
+        }
+    }
+    return encodeRun(in, i, length, out, o);
+}
+
+/**
+ * @brief Таблица перестановок для сжатия восьми символов кодов до 0x800
+ * @details Для маски двухбайтовых символов m хранит управляющий вектор
+ * pshufb, который выбирает из восьми 16-битных дорожек оба байта у двухбайтовых
+ * символов и младший байт у ASCII, и длину результата 8 + popcount(m)
+ */
+struct CompressTable {
+    alignas(16) unsigned char shuffle[256][16]; ///< Управляющие векторы
+    unsigned char length[256]; ///< Длины результата в байтах
+
+    constexpr CompressTable() : shuffle(), length() {
+        for (unsigned mask = 0; mask < 256; mask++) {
+            unsigned n = 0;
+            for (unsigned k = 0; k < 8; k++) {
+                shuffle[mask][n++] = static_cast<unsigned char>(2 * k);
+                if (mask & (1u << k)) {
+                    shuffle[mask][n++] = static_cast<unsigned char>(2 * k + 1);
+                }
+            }
+            length[mask] = static_cast<unsigned char>(n);
+            for (; n < 16; n++) {
+                shuffle[mask][n] = 0x80;
+            }
+        }
+    }
+};
+
+/// Таблица перестановок для encodeSsse3()
+constexpr CompressTable compressTable;
+
+/**
+ * @brief Реализация кодирования на SSSE3
+ * @details Восемь символов с кодами до 0x800 кодируются без ветвлений
+ * при любом чередовании ASCII и двухбайтовых символов: каждая дорожка получает
+ * запись двухбайтового символа или код ASCII, после чего лишние старшие байты
+ * ASCII удаляются перестановкой из compressTable
+ * @param in Широкая строка
+ * @param length Количество символов
+ * @param out Буфер не меньше длины результата плюс encodeSlack байт
+ * @param i Позиция ошибки в символах (length при успехе)
+ * @param o Количество записанных байт
+ * @return false, если найден суррогат или код больше U+10FFFF
+ */
+__attribute__((target("ssse3")))
+bool encodeSsse3(const wchar_t* in, std::size_t length, char* out, std::size_t& i, std::size_t& o)
+{
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i notTwoByte = _mm_set1_epi32(~0x7FF);
+    const __m128i asciiMax = _mm_set1_epi16(0x007F);
+    const __m128i continuationBits = _mm_set1_epi16(0x003F);
+    const __m128i leadPrefix = _mm_set1_epi16(0x00C0);
+    const __m128i continuationPrefix = _mm_set1_epi16(static_cast<short>(0x8000));
+
+    while (i + 8 <= length) {
+        const __m128i a = _mm_loadu_si128(reinterpret_cast<const __m128i*>(in + i));
+        const __m128i b = _mm_loadu_si128(reinterpret_cast<const __m128i*>(in + i + 4));
+        const __m128i wide = _mm_or_si128(_mm_and_si128(a, notTwoByte), _mm_and_si128(b, notTwoByte));
+        if (_mm_movemask_epi8(_mm_cmpeq_epi32(wide, zero)) != 0xFFFF) {
+            if (!encodeRun(in, i, i + 1, out, o)) {
+                return false;
+            }
+            continue;
+        }
+
+        const __m128i code = _mm_packs_epi32(a, b);
+        const __m128i twoByte = _mm_cmpgt_epi16(code, asciiMax);
+        const __m128i lead = _mm_or_si128(_mm_srli_epi16(code, 6), leadPrefix);
+        const __m128i continuation = _mm_or_si128(_mm_slli_epi16(_mm_and_si128(code, continuationBits), 8), continuationPrefix);
+        const __m128i lanes = _mm_or_si128(_mm_and_si128(twoByte, _mm_or_si128(lead, continuation)),
+                                           _mm_andnot_si128(twoByte, code));
+        const unsigned mask = static_cast<unsigned>(_mm_movemask_epi8(_mm_packs_epi16(twoByte, zero)));
+        const __m128i shuffle = _mm_load_si128(reinterpret_cast<const __m128i*>(compressTable.shuffle[mask]));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(out + o), _mm_shuffle_epi8(lanes, shuffle));
+        i += 8;
+        o += compressTable.length[mask];
+    }
+    return encodeRun(in, i, length, out, o);
+}
+
+#endif
+
+/**
+ * @brief Выбранная реализация перекодирования
+ */
+struct KernelChoice {
+    DecodeKernel decode; ///< Декодирование UTF-8
+    EncodeKernel encode; ///< Кодирование в UTF-8
+    const char* name; ///< Название реализации
+};
+
+/**
+ * @brief Выбор реализации по возможностям процессора
+ * @return Реализация SSSE3, SSE2 или скалярная
+ */
+KernelChoice selectKernel()
+{
+#ifdef UTF8_X86_KERNELS
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("ssse3")) {
+        return {decodeSse2, encodeSsse3, "ssse3"};
+    }
+    if (__builtin_cpu_supports("sse2")) {
+        return {decodeSse2, encodeSse2, "sse2"};
+    }
+#endif
+    return {decodeScalar, encodeScalar, "scalar"};
+}
+
+/**
+ * @brief Реализация, выбранная при первом обращении
+ * @return Выбранная реализация
+ */
+const KernelChoice& kernelChoice()
+{
+    static const KernelChoice choice = selectKernel();
+    return choice;
+}
+
+/**
+ * @brief Длина записи широкой строки в UTF-8
+ * @param in Широкая строка
+ * @return Количество байт (для недопустимых кодов - верхняя оценка)
+ */
+std::size_t utf8Size(std::wstring_view in)
+{
+    std::size_t size = 0;
+    for (wchar_t c : in) {
+        size += utf8Length(static_cast<char32_t>(c));
+    }
+    return size;
+}
+
+} // namespace
+
+/**
+ * @brief Декодирование строки UTF-8 в широкую строку
+ * @param in Строка в кодировке UTF-8
+ * @param out Буфер результата (содержимое заменяется)
+ * @return CipherErrc::invalidSymbol с позицией первой некорректной, неполной
+ * или избыточной (overlong) последовательности в байтах; при ошибке out
+ * содержит символы до этой позиции
+ */
+CipherError utf8ToWide(std::string_view in, std::wstring& out)
+{
+    out.resize(in.size());
+    std::size_t i = 0;
+    std::size_t o = 0;
+    const bool valid = kernelChoice().decode(reinterpret_cast<const unsigned char*>(in.data()), in.size(), out.data(), i, o);
+    out.resize(o);
+    if (!valid) {
+        return {CipherErrc::invalidSymbol, i};
+    }
+    return {};
+}
+
+/**
+ * @brief Кодирование широкой строки в UTF-8
+ * @param in Широкая строка
+ * @param out Буфер результата (содержимое заменяется)
+ * @return CipherErrc::invalidSymbol с позицией первого символа, не являющегося
+ * кодом Unicode (суррогат или код больше U+10FFFF); при ошибке out содержит
+ * символы до этой позиции
+ */
+CipherError wideToUtf8(std::wstring_view in, std::string& out)
+{
+    out.resize(utf8Size(in) + encodeSlack);
+    std::size_t i = 0;
+    std::size_t o = 0;
+    const bool valid = kernelChoice().encode(in.data(), in.size(), out.data(), i, o);
+    out.resize(o);
+    if (!valid) {
+        return {CipherErrc::invalidSymbol, i};
+    }
+    return {};
+}
+
+/**
+ * @brief Декодирование строки UTF-8 в широкую строку
+ * @param in Строка в кодировке UTF-8
+ * @return Широкая строка
+ * @throw std::range_error При некорректной последовательности UTF-8
+ */
+std::wstring utf8ToWide(std::string_view in)
+{
+    std::wstring out;
+    if (utf8ToWide(in, out)) {
+        throw std::range_error("Некорректная последовательность UTF-8");
+    }
+    return out;
+}
+
+/**
+ * @brief Кодирование широкой строки в UTF-8
+ * @param in Широкая строка
+ * @return Строка в кодировке UTF-8
+ * @throw std::range_error Если строка содержит суррогат или код больше U+10FFFF
+ */
+std::string wideToUtf8(std::wstring_view in)
+{
+    std::string out;
+    if (wideToUtf8(in, out)) {
+        throw std::range_error("Символ не может быть записан в UTF-8");
+    }
+    return out;
+}
+
+/**
+ * @brief Название реализации перекодирования, выбранной для текущего процессора
+ * @return "ssse3", "sse2" или "scalar"
+ */
+const char* utf8TranscodeKernelName()
+{
+    return kernelChoice().name;
+}
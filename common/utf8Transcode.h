@@ -0,0 +1,67 @@
+#pragma once
+#include <cstddef>
+#include <string>
+#include <string_view>
+#include "cipherResult.h"
+
+/**
+ * @file
+ * @author Ганьшин В.А.
+ * @version 1.0
+ * @date 17.12.2025
+ * @brief Перекодирование строк UTF-8 в широкие строки и обратно
+ * @details Общий модуль ввода-вывода программ шифрования методом Гронсфельда
+ * и табличной маршрутной перестановки вместо std::wstring_convert и
+ * преобразования через локаль потока. Строка обрабатывается блоками по 16 байт
+ * (SSE2, SSSE3): блок ASCII расширяется или сужается целиком, блок из восьми двухбайтовых
+ * символов (кириллица, латиница с диакритикой) собирается сдвигами и масками,
+ * а при кодировании на SSSE3 смесь ASCII и двухбайтовых символов сжимается
+ * перестановкой байт.
+ * Остальные символы разбираются по одному, с быстрыми ветвями для ASCII и
+ * двухбайтовых последовательностей. Реализация выбирается один раз во время
+ * выполнения; скалярная дает тот же результат. Функции с буфером результата
+ * заменяют его содержимое, сохраняя выделенную память, поэтому повторное
+ * использование одного буфера не выделяет память.
+ */
+
+/**
+ * @brief Декодирование строки UTF-8 в широкую строку
+ * @param in Строка в кодировке UTF-8
+ * @param out Буфер результата (содержимое заменяется)
+ * @return CipherErrc::invalidSymbol с позицией первой некорректной, неполной
+ * или избыточной (overlong) последовательности в байтах; при ошибке out
+ * содержит символы до этой позиции
+ */
+CipherError utf8ToWide(std::string_view in, std::wstring& out);
+
+/**
+ * @brief Кодирование широкой строки в UTF-8
+ * @param in Широкая строка
+ * @param out Буфер результата (содержимое заменяется)
+ * @return CipherErrc::invalidSymbol с позицией первого символа, не являющегося
+ * кодом Unicode (суррогат или код больше U+10FFFF); при ошибке out содержит
+ * символы до этой позиции
+ */
+CipherError wideToUtf8(std::wstring_view in, std::string& out);
+
+/**
+ * @brief Декодирование строки UTF-8 в широкую строку
+ * @param in Строка в кодировке UTF-8
+ * @return Широкая строка
+ * @throw std::range_error При некорректной последовательности UTF-8
+ */
+std::wstring utf8ToWide(std::string_view in);
+
+/**
+ * @brief Кодирование широкой строки в UTF-8
+ * @param in Широкая строка
+ * @return Строка в кодировке UTF-8
+ * @throw std::range_error Если строка содержит суррогат или код больше U+10FFFF
+ */
+std::string wideToUtf8(std::wstring_view in);
+
+/**
+ * @brief Название реализации перекодирования, выбранной для текущего процессора
+ * @return "ssse3", "sse2" или "scalar"
+ */
+const char* utf8TranscodeKernelName();
@@ -0,0 +1,415 @@
+/**
+ * @file compositeCipher.cpp
+ * @brief Реализация составного шифра Гронсфельда и табличной перестановки
+ */
+
+#include "compositeCipher.h"
+#include <algorithm>
+#include <cstdint>
+#include <cwctype>
+#include <type_traits>
+#include <utility>
+#include <vector>
+#include "../common/utf8.h"
+#include "../route_doc/routeKernel.h"
+#include "../route_doc/tableCipher.h"
+
+namespace {
+
+/**
+ * @brief Проверка, является ли символ буквой какого-либо алфавита
+ * @param c Символ
+ * @return true для буквы (как в шифре Гронсфельда: таблица letterTable, выше U+07FF - std::iswalpha)
+ */
+bool isLetter(char32_t c)
+{
+    return (c < alphabetCodeRange) ? letterTable.letter[c] : (c != utf8Invalid && std::iswalpha(static_cast<wint_t>(c)));
+}
+
+/**
+ * @brief Чтение символа широкой строки
+ * @param p Текущая позиция, сдвигается за прочитанный символ
+ * @return Код символа
+ */
+char32_t nextChar(const wchar_t*& p, const wchar_t*)
+{
+    return static_cast<char32_t>(*p++);
+}
+
+/**
+ * @brief Чтение символа строки UTF-8
+ * @param p Текущая позиция, сдвигается за прочитанный символ
+ * @param end Конец строки
+ * @return Код символа или utf8Invalid
+ */
+char32_t nextChar(const char*& p, const char* end)
+{
+    return utf8Decode(p, end);
+}
+
+/**
+ * @brief Запись символа в широкую строку
+ * @param out Позиция записи
+ * @param c Символ
+ */
+void putChar(wchar_t*& out, wchar_t c)
+{
+    *out++ = c;
+}
+
+/**
+ * @brief Запись символа в строку UTF-8
+ * @param out Позиция записи
+ * @param c Символ
+ */
+void putChar(char*& out, wchar_t c)
+{
+    out = utf8Encode(static_cast<char32_t>(c), out);
+}
+
+/**
+ * @brief Отметка символа, который удаляется шифром Гронсфельда после перестановки
+ * @tparam Cell Тип ячейки буфера номеров
+ */
+template <class Cell>
+constexpr Cell skippedCell = static_cast<Cell>(~Cell(0));
+
+/**
+ * @brief Проверка текста и перевод его в номера букв алфавита
+ * @tparam Char wchar_t или char (UTF-8)
+ * @tparam Cell Тип ячейки буфера номеров
+ * @param text Текст
+ * @param alphabet Алфавит шифра Гронсфельда
+ * @param cells Буфер номеров не короче text.size()
+ * @param keepSkipped true - пробелы и буквы других алфавитов записываются отметкой
+ * skippedCell, false - пропускаются
+ * @param count Количество записанных ячеек
+ * @param letters Количество букв алфавита
+ * @return CipherErrc::invalidSymbol с позицией символа (для UTF-8 - в байтах)
+ */
+template <class Char, class Cell>
+CipherError scanText(std::basic_string_view<Char> text, const AlphabetTable& alphabet, Cell* cells,
+                     bool keepSkipped, std::size_t& count, std::size_t& letters)
+{
+    const Char* p = text.data();
+    const Char* end = p + text.size();
+    count = 0;
+    letters = 0;
+    while (p != end) {
+        const Char* at = p;
+        const char32_t c = nextChar(p, end);
+        const int idx = (c < alphabetCodeRange) ? alphabet.index[c] : -1;
+        if (idx >= 0) {
+            cells[count++] = static_cast<Cell>(idx);
+            letters++;
+        } else if (c == U' ' || isLetter(c)) {
+            if (keepSkipped) {
+                cells[count++] = skippedCell<Cell>;
+            }
+        } else {
+            return {CipherErrc::invalidSymbol, static_cast<std::size_t>(at - text.data())};
+        }
+    }
+    return {};
+}
+
+/**
+ * @brief Проверка размеров таблицы
+ * @param numColumns Количество столбцов таблицы
+ * @param length Длина переставляемого текста
+ * @param encrypting true - шифрование таблицей, false - расшифрование
+ * @return Ошибка TableCipher для текста этой длины
+ */
+CipherError checkTable(int numColumns, std::size_t length, bool encrypting)
+{
+    if (static_cast<std::size_t>(numColumns) > length) {
+        return {CipherErrc::keyLongerThanText, 0};
+    }
+    if (encrypting && (length + numColumns - 1) / numColumns > 10000) {
+        return {CipherErrc::tableTooLarge, 0};
+    }
+    return {};
+}
+
+/**
+ * @brief Значение результата или исключение с его ошибкой
+ * @param result Результат операции
+ * @param encrypting true - шифрование, false - расшифрование
+ * @return Значение результата
+ * @throw cipher_error Если результат содержит ошибку
+ */
+template <class T>
+T valueOrThrow(CipherResult<T>&& result, bool encrypting)
+{
+    if (!result) {
+        throw CompositeCipher::makeError(result.error(), encrypting);
+    }
+    return std::move(*result);
+}
+
+} // namespace
+
+/**
+ * @brief Конструктор по проверенным ключам
+ * @param gronsfeld Шифр Гронсфельда
+ * @param numColumns Количество столбцов таблицы
+ * @param order Порядок стадий
+ */
+CompositeCipher::CompositeCipher(modAlphaCipher gronsfeld, int numColumns, CompositeOrder order)
+    : gronsfeld(std::move(gronsfeld)), numColumns(numColumns), order(order)
+{
+}
+
+/**
+ * @brief Конструктор с установкой ключей
+ * @param gronsfeldKey Ключ шифра Гронсфельда
+ * @param tableKey Количество столбцов таблицы
+ * @param order Порядок стадий при шифровании
+ * @param alpha Алфавит шифра Гронсфельда
+ * @throw cipher_error Если один из ключей некорректен
+ */
+CompositeCipher::CompositeCipher(const std::wstring& gronsfeldKey, int tableKey, CompositeOrder order,
+                                 const AlphabetTable& alpha)
+    : gronsfeld(gronsfeldKey, alpha), numColumns(tableKey), order(order)
+{
+    CipherError error = TableCipher::checkKey(tableKey);
+    if (error) {
+        throw makeError(error, true);
+    }
+}
+
+/**
+ * @brief Создание шифра без исключений
+ * @param gronsfeldKey Ключ шифра Гронсфельда
+ * @param tableKey Количество столбцов таблицы
+ * @param order Порядок стадий при шифровании
+ * @param alpha Алфавит шифра Гронсфельда
+ * @return Шифр или ошибка ключа
+ */
+CipherResult<CompositeCipher> CompositeCipher::create(const std::wstring& gronsfeldKey, int tableKey,
+                                                      CompositeOrder order, const AlphabetTable& alpha)
+{
+    CipherResult<modAlphaCipher> gronsfeld = modAlphaCipher::create(gronsfeldKey, alpha);
+    if (!gronsfeld) {
+        return gronsfeld.error();
+    }
+    CipherError error = TableCipher::checkKey(tableKey);
+    if (error) {
+        return error;
+    }
+    return CompositeCipher(std::move(*gronsfeld), tableKey, order);
+}
+
+/**
+ * @brief Исключение для ошибки
+ * @param error Описание ошибки
+ * @param encrypting true - шифрование, false - расшифрование
+ * @return Исключение с сообщением той стадии, к которой относится ошибка
+ */
+cipher_error CompositeCipher::makeError(CipherError error, bool encrypting)
+{
+    switch (error.code) {
+        case CipherErrc::keyNotPositive:
+        case CipherErrc::keyTooLarge:
+        case CipherErrc::keyLongerThanText:
+        case CipherErrc::tableTooLarge:
+            return cipher_error(TableCipher::errorMessage(error.code, encrypting), error);
+        default:
+            return cipher_error(modAlphaCipher::errorMessage(error.code, encrypting), error);
+    }
+}
+
+/**
+ * @brief Шифрование или расшифрование за один проход
+ * @param text Исходный текст
+ * @param encrypting true - шифрование, false - расшифрование
+ * @return Результат или ошибка
+ * @details Если замена выполняется до перестановки (шифрование при порядке
+ * CompositeOrder::gronsfeldFirst, расшифрование при CompositeOrder::tableFirst),
+ * при проверке остаются только номера букв алфавита; они сдвигаются по ключу
+ * в порядке текста и переставляются ячейками по 1 байту.
+ * Иначе переставляется весь текст: пробелы и буквы других алфавитов занимают
+ * ячейки с отметкой skippedCell, а после перестановки пропускаются, и ключ
+ * Гронсфельда идет по порядку результата перестановки. Так ошибки и их порядок
+ * совпадают с последовательным применением шифров
+ */
+template <class Char>
+CipherResult<std::basic_string<Char>> CompositeCipher::transform(std::basic_string_view<Char> text, bool encrypting) const
+{
+    if (text.empty()) {
+        return CipherErrc::emptyText;
+    }
+
+    const AlphabetTable& alphabet = *gronsfeld.alphabet;
+    const unsigned char* shift = encrypting ? gronsfeld.encryptShift.data() : gronsfeld.decryptShift.data();
+    const unsigned char modulus = static_cast<unsigned char>(alphabet.size); // 256 -> 0
+    const std::size_t keyLength = gronsfeld.key.size();
+    const bool shiftFirst = (order == CompositeOrder::gronsfeldFirst) == encrypting;
+    const std::size_t charWidth = std::is_same_v<Char, char> ? static_cast<std::size_t>(alphabet.maxUtf8Length) : 1;
+
+    std::basic_string<Char> result;
+    Char* out = nullptr;
+    auto emit = [&](const unsigned char* indices, std::size_t length) {
+        for (std::size_t i = 0; i < length; i++) {
+            putChar(out, alphabet.symbols[indices[i]]);
+        }
+    };
+
+    if (shiftFirst) {
+        std::vector<unsigned char> letters(text.size());
+        std::size_t count;
+        std::size_t found;
+        CipherError error = scanText(text, alphabet, letters.data(), false, count, found);
+        if (error) {
+            return error;
+        }
+        if (count == 0) {
+            return CipherErrc::noLetters;
+        }
+        error = checkTable(numColumns, count, encrypting);
+        if (error) {
+            return error;
+        }
+        std::size_t k = 0;
+        for (std::size_t i = 0; i < count; i += kernelBlockSize) {
+            const std::size_t length = std::min(kernelBlockSize, count - i);
+            shiftIndices(letters.data() + i, shift + k, length, modulus);
+            k = (k + length) % keyLength;
+        }
+        std::vector<unsigned char> permuted(count);
+        transposeRoute(letters.data(), permuted.data(), 1, tableRoute(numColumns, count), encrypting);
+        result.resize(count * charWidth);
+        out = &result[0];
+        emit(permuted.data(), count);
+    } else {
+        // Номера 0 .. 255 при алфавите из 256 букв не оставляют места для отметки
+        auto permuteFirst = [&](auto cell) -> CipherError {
+            using Cell = decltype(cell);
+            std::vector<Cell> cells(text.size());
+            std::size_t count;
+            std::size_t letters;
+            CipherError error = scanText(text, alphabet, cells.data(), true, count, letters);
+            if (error) {
+                return error;
+            }
+            error = checkTable(numColumns, count, encrypting);
+            if (error) {
+                return error;
+            }
+            if (letters == 0) {
+                return {CipherErrc::noLetters, 0};
+            }
+            std::vector<Cell> permuted(count);
+            transposeRoute(cells.data(), permuted.data(), sizeof(Cell), tableRoute(numColumns, count), encrypting);
+            result.resize(letters * charWidth);
+            out = &result[0];
+            unsigned char block[kernelBlockSize];
+            std::size_t k = 0;
+            std::size_t i = 0;
+            while (i < count) {
+                std::size_t filled = 0;
+                for (; i < count && filled < kernelBlockSize; i++) {
+                    if (permuted[i] != skippedCell<Cell>) {
+                        block[filled++] = static_cast<unsigned char>(permuted[i]);
+                    }
+                }
+                shiftIndices(block, shift + k, filled, modulus);
+                k = (k + filled) % keyLength;
+                emit(block, filled);
+            }
+            return {};
+        };
+        CipherError error = (alphabet.size < 256) ? permuteFirst(static_cast<unsigned char>(0))
+                                                  : permuteFirst(static_cast<std::uint16_t>(0));
+        if (error) {
+            return error;
+        }
+    }
+
+    result.resize(static_cast<std::size_t>(out - result.data()));
+    return result;
+}
+
+/**
+ * @brief Шифрование текста
+ * @param open_text Открытый текст
+ * @return Зашифрованная строка
+ * @throw cipher_error При некорректном тексте
+ */
+std::wstring CompositeCipher::encrypt(const std::wstring& open_text) const
+{
+    return valueOrThrow(tryEncrypt(open_text), true);
+}
+
+/**
+ * @brief Расшифрование текста
+ * @param cipher_text Зашифрованный текст
+ * @return Расшифрованная строка
+ * @throw cipher_error При некорректном тексте
+ */
+std::wstring CompositeCipher::decrypt(const std::wstring& cipher_text) const
+{
+    return valueOrThrow(tryDecrypt(cipher_text), false);
+}
+
+/**
+ * @brief Шифрование текста в кодировке UTF-8
+ * @param open_text Открытый текст в кодировке UTF-8
+ * @return Зашифрованная строка в кодировке UTF-8
+ * @throw cipher_error При некорректном тексте
+ */
+std::string CompositeCipher::encrypt(std::string_view open_text) const
+{
+    return valueOrThrow(tryEncrypt(open_text), true);
+}
+
+/**
+ * @brief Расшифрование текста в кодировке UTF-8
+ * @param cipher_text Зашифрованный текст в кодировке UTF-8
+ * @return Расшифрованная строка в кодировке UTF-8
+ * @throw cipher_error При некорректном тексте
+ */
+std::string CompositeCipher::decrypt(std::string_view cipher_text) const
+{
+    return valueOrThrow(tryDecrypt(cipher_text), false);
+}
+
+/**
+ * @brief Шифрование текста без исключений
+ * @param open_text Открытый текст
+ * @return Зашифрованная строка или ошибка
+ */
+CipherResult<std::wstring> CompositeCipher::tryEncrypt(const std::wstring& open_text) const
+{
+    return transform(std::wstring_view(open_text), true);
+}
+
+/**
+ * @brief Расшифрование текста без исключений
+ * @param cipher_text Зашифрованный текст
+ * @return Расшифрованная строка или ошибка
+ */
+CipherResult<std::wstring> CompositeCipher::tryDecrypt(const std::wstring& cipher_text) const
+{
+    return transform(std::wstring_view(cipher_text), false);
+}
+
+/**
+ * @brief Шифрование текста UTF-8 без исключений
+ * @param open_text Открытый текст в кодировке UTF-8
+ * @return Зашифрованная строка или ошибка
+ */
+CipherResult<std::string> CompositeCipher::tryEncrypt(std::string_view open_text) const
+{
+    return transform(open_text, true);
+}
+
+/**
+ * @brief Расшифрование текста UTF-8 без исключений
+ * @param cipher_text Зашифрованный текст в кодировке UTF-8
+ * @return Расшифрованная строка или ошибка
+ */
+CipherResult<std::string> CompositeCipher::tryDecrypt(std::string_view cipher_text) const
+{
+    return transform(cipher_text, false);
+}
@@ -0,0 +1,167 @@
+#pragma once
+#include <string>
+#include <string_view>
+#include "../alpha_doc/modAlphaCipher.h"
+#include "../common/cipherResult.h"
+
+/**
+ * @file
+ * @author Ганьшин В.А.
+ * @version 1.0
+ * @date 17.12.2025
+ * @brief Составной шифр: шифр Гронсфельда и табличная перестановка за один проход
+ * @details Замена буквы не зависит от ее места в таблице, если позиция в ключе
+ * Гронсфельда берется по порядку той стадии, которая выполняется первой. Поэтому
+ * обе стадии выполняются над одним буфером номеров букв алфавита (1-2 байта на символ):
+ * текст проверяется один раз, номера сдвигаются векторным ядром shiftIndices()
+ * и переставляются блочным ядром transposeRoute(), а итоговый шифротекст
+ * записывается один раз, без промежуточной строки между стадиями.
+ */
+
+/**
+ * @brief Порядок стадий составного шифра при шифровании
+ */
+enum class CompositeOrder {
+    gronsfeldFirst, ///< Сначала шифр Гронсфельда, затем табличная перестановка
+    tableFirst ///< Сначала табличная перестановка, затем шифр Гронсфельда
+};
+
+/**
+ * @brief Составной шифр Гронсфельда и табличной маршрутной перестановки
+ * @details Результат совпадает с последовательным применением шифров:
+ * при порядке CompositeOrder::gronsfeldFirst
+ * encrypt(text) == TableCipher(tableKey).encrypt(modAlphaCipher(key).encrypt(text)) и
+ * decrypt(text) == modAlphaCipher(key).decrypt(TableCipher(tableKey).decrypt(text)),
+ * при порядке CompositeOrder::tableFirst стадии меняются местами.
+ * Символы проверяются по правилам шифра Гронсфельда в режиме InputPolicy::strict:
+ * буквы алфавита шифруются, пробелы и буквы других алфавитов удаляются
+ * (при перестановке до замены - после перестановки), остальные символы - ошибка.
+ * Маршрут таблицы - маршрут TableCipher по умолчанию
+ */
+class CompositeCipher {
+private:
+    modAlphaCipher gronsfeld; ///< Ключ и алфавит шифра Гронсфельда
+    int numColumns; ///< Количество столбцов таблицы
+    CompositeOrder order; ///< Порядок стадий при шифровании
+
+    /**
+     * @brief Конструктор по проверенным ключам
+     * @param gronsfeld Шифр Гронсфельда
+     * @param numColumns Количество столбцов таблицы
+     * @param order Порядок стадий
+     */
+    CompositeCipher(modAlphaCipher gronsfeld, int numColumns, CompositeOrder order);
+
+    /**
+     * @brief Шифрование или расшифрование за один проход
+     * @tparam Char wchar_t или char (UTF-8)
+     * @param text Исходный текст
+     * @param encrypting true - шифрование, false - расшифрование
+     * @return Результат или ошибка
+     */
+    template <class Char>
+    CipherResult<std::basic_string<Char>> transform(std::basic_string_view<Char> text, bool encrypting) const;
+
+public:
+    CompositeCipher() = delete;
+
+    /**
+     * @brief Конструктор с установкой ключей
+     * @param gronsfeldKey Ключ шифра Гронсфельда
+     * @param tableKey Количество столбцов таблицы (1 .. 1000)
+     * @param order Порядок стадий при шифровании
+     * @param alpha Алфавит шифра Гронсфельда
+     * @throw cipher_error Если один из ключей некорректен
+     */
+    CompositeCipher(const std::wstring& gronsfeldKey, int tableKey,
+                    CompositeOrder order = CompositeOrder::gronsfeldFirst,
+                    const AlphabetTable& alpha = russianAlphabet);
+
+    /**
+     * @brief Создание шифра без исключений
+     * @param gronsfeldKey Ключ шифра Гронсфельда
+     * @param tableKey Количество столбцов таблицы (1 .. 1000)
+     * @param order Порядок стадий при шифровании
+     * @param alpha Алфавит шифра Гронсфельда
+     * @return Шифр или ошибка ключа
+     */
+    static CipherResult<CompositeCipher> create(const std::wstring& gronsfeldKey, int tableKey,
+                                                CompositeOrder order = CompositeOrder::gronsfeldFirst,
+                                                const AlphabetTable& alpha = russianAlphabet);
+
+    /**
+     * @brief Исключение для ошибки
+     * @param error Описание ошибки
+     * @param encrypting true - шифрование, false - расшифрование
+     * @return Исключение с сообщением той стадии, к которой относится ошибка
+     */
+    static cipher_error makeError(CipherError error, bool encrypting);
+
+    /**
+     * @brief Порядок стадий при шифровании
+     * @return Порядок стадий
+     */
+    CompositeOrder stageOrder() const {
+        return order;
+    }
+
+    /**
+     * @brief Шифрование текста
+     * @param open_text Открытый текст
+     * @return Зашифрованная строка (прописные буквы алфавита)
+     * @throw cipher_error При некорректном тексте
+     */
+    std::wstring encrypt(const std::wstring& open_text) const;
+
+    /**
+     * @brief Расшифрование текста
+     * @param cipher_text Зашифрованный текст
+     * @return Расшифрованная строка (прописные буквы алфавита)
+     * @throw cipher_error При некорректном тексте
+     */
+    std::wstring decrypt(const std::wstring& cipher_text) const;
+
+    /**
+     * @brief Шифрование текста в кодировке UTF-8
+     * @param open_text Открытый текст в кодировке UTF-8
+     * @return Зашифрованная строка в кодировке UTF-8
+     * @throw cipher_error При некорректном тексте
+     */
+    std::string encrypt(std::string_view open_text) const;
+
+    /**
+     * @brief Расшифрование текста в кодировке UTF-8
+     * @param cipher_text Зашифрованный текст в кодировке UTF-8
+     * @return Расшифрованная строка в кодировке UTF-8
+     * @throw cipher_error При некорректном тексте
+     */
+    std::string decrypt(std::string_view cipher_text) const;
+
+    /**
+     * @brief Шифрование текста без исключений
+     * @param open_text Открытый текст
+     * @return Зашифрованная строка или ошибка с позицией недопустимого символа
+     */
+    CipherResult<std::wstring> tryEncrypt(const std::wstring& open_text) const;
+
+    /**
+     * @brief Расшифрование текста без исключений
+     * @param cipher_text Зашифрованный текст
+     * @return Расшифрованная строка или ошибка с позицией недопустимого символа
+     */
+    CipherResult<std::wstring> tryDecrypt(const std::wstring& cipher_text) const;
+
+    /**
+     * @brief Шифрование текста UTF-8 без исключений
+     * @param open_text Открытый текст в кодировке UTF-8
+     * @return Зашифрованная строка или ошибка с позицией недопустимого символа в байтах
+     */
+    CipherResult<std::string> tryEncrypt(std::string_view open_text) const;
+
+    /**
+     * @brief Расшифрование текста UTF-8 без исключений
+     * @param cipher_text Зашифрованный текст в кодировке UTF-8
+     * @return Расшифрованная строка или ошибка с позицией недопустимого символа в байтах
+     */
+    CipherResult<std::string> tryDecrypt(std::string_view cipher_text) const;
+};
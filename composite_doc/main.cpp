@@ -0,0 +1,183 @@
+#include "compositeCipher.h"
+#include "../route_doc/tableCipher.h"
+#include "../common/utf8Transcode.h"
+#include <iostream>
+#include <locale>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+/**
+ * @file
+ * @author Ганьшин В.А.
+ * @version 1.0
+ * @date 17.12.2025
+ * @brief Главный модуль проверки составного шифра
+ * @details Сравнивает CompositeCipher с последовательным применением
+ * modAlphaCipher и TableCipher в обоих порядках стадий
+ */
+
+/// Количество непройденных проверок самотестирования
+int failedChecks = 0;
+
+/**
+ * @brief Вывод результата проверки самотестирования
+ * @param what Что проверялось
+ * @param passed true, если проверка пройдена
+ */
+void reportCheck(const std::string& what, bool passed)
+{
+    std::cout << "   Проверка: " << what << (passed ? " - корректно" : " - НЕКОРРЕКТНО") << std::endl;
+    if (!passed) {
+        failedChecks++;
+    }
+}
+
+/**
+ * @brief Последовательное применение шифров
+ * @tparam Text std::wstring или std::string (UTF-8)
+ * @param gronsfeld Шифр Гронсфельда
+ * @param table Шифр табличной перестановки
+ * @param order Порядок стадий при шифровании
+ * @param text Исходный текст
+ * @param encrypting true - шифрование, false - расшифрование
+ * @return Результат второй стадии или ошибка первой стадии, на которой она возникла
+ */
+template <class Text>
+CipherResult<Text> chained(const modAlphaCipher& gronsfeld, const TableCipher& table, CompositeOrder order,
+                           const Text& text, bool encrypting)
+{
+    auto gronsfeldStage = [&](const Text& in) {
+        return encrypting ? gronsfeld.tryEncrypt(in) : gronsfeld.tryDecrypt(in);
+    };
+    auto tableStage = [&](const Text& in) {
+        return encrypting ? table.tryEncrypt(in) : table.tryDecrypt(in);
+    };
+    const bool gronsfeldFirst = (order == CompositeOrder::gronsfeldFirst) == encrypting;
+    CipherResult<Text> first = gronsfeldFirst ? gronsfeldStage(text) : tableStage(text);
+    if (!first) {
+        return first.error();
+    }
+    return gronsfeldFirst ? tableStage(*first) : gronsfeldStage(*first);
+}
+
+/**
+ * @brief Совпадение результатов составного и последовательного шифрования
+ * @param composite Результат CompositeCipher
+ * @param expected Результат последовательного применения шифров
+ * @return true, если совпадают значения или коды и позиции ошибок
+ */
+template <class Text>
+bool sameResult(const CipherResult<Text>& composite, const CipherResult<Text>& expected)
+{
+    if (composite.hasValue() != expected.hasValue()) {
+        return false;
+    }
+    if (composite) {
+        return *composite == *expected;
+    }
+    return composite.error().code == expected.error().code && composite.error().offset == expected.error().offset;
+}
+
+/**
+ * @brief Построение тестового текста UTF-8 из слов через пробел
+ * @param words Количество слов
+ * @return Текст с русскими и латинскими словами
+ */
+std::string sampleText(std::size_t words)
+{
+    const char* vocabulary[] = {"ШИФР", "гронсфельда", "Ёж", "ТАБЛИЦА", "route", "ключ", "Text", "Я"};
+    std::mt19937 random(3);
+    std::string text;
+    for (std::size_t i = 0; i < words; i++) {
+        if (i > 0) {
+            text += ' ';
+        }
+        text += vocabulary[random() % 8];
+    }
+    return text;
+}
+
+/**
+ * @brief Сравнение составного шифра с последовательным применением шифров
+ * @details Для обоих порядков стадий и нескольких ключей таблицы каждый текст
+ * зашифровывается и расшифровывается в виде широкой строки и UTF-8. Среди текстов
+ * есть пробелы, латинские буквы, недопустимые символы, текст без русских букв,
+ * текст короче ключа таблицы и текст, не помещающийся в 10000 строк
+ */
+void testChained()
+{
+    std::cout << "СРАВНЕНИЕ С ПОСЛЕДОВАТЕЛЬНЫМ ПРИМЕНЕНИЕМ ШИФРОВ" << std::endl;
+
+    const std::vector<std::string> texts = {
+        "ПРИВЕТ МИР",
+        "Привет hello мир Ёлка",
+        "ИТРЕРВИПМ",
+        "ПРИВЕТ 5 МИР",
+        "hello world",
+        "ПРИ",
+        "",
+        sampleText(3000),
+        std::string(20001, 'A') + "Я"
+    };
+    const std::wstring key = L"КЛЮЧ";
+    modAlphaCipher gronsfeld(key);
+
+    for (CompositeOrder order : {CompositeOrder::gronsfeldFirst, CompositeOrder::tableFirst}) {
+        const std::string name = (order == CompositeOrder::gronsfeldFirst) ? "Гронсфельд, затем таблица"
+                                                                          : "таблица, затем Гронсфельд";
+        bool wideSame = true;
+        bool utf8Same = true;
+        for (int columns : {1, 3, 7}) {
+            const CompositeCipher composite(key, columns, order);
+            const TableCipher table(columns);
+            for (const std::string& text : texts) {
+                const std::wstring wideText = utf8ToWide(text);
+                for (bool encrypting : {true, false}) {
+                    wideSame = wideSame && sameResult(
+                        encrypting ? composite.tryEncrypt(wideText) : composite.tryDecrypt(wideText),
+                        chained(gronsfeld, table, order, wideText, encrypting));
+                    utf8Same = utf8Same && sameResult(
+                        encrypting ? composite.tryEncrypt(std::string_view(text)) : composite.tryDecrypt(std::string_view(text)),
+                        chained(gronsfeld, table, order, text, encrypting));
+                }
+            }
+        }
+        reportCheck("широкие строки (" + name + ")", wideSame);
+        reportCheck("UTF-8 (" + name + ")", utf8Same);
+    }
+    std::cout << std::endl;
+}
+
+/**
+ * @brief Главная функция программы
+ * @return Код завершения программы: 0 - все проверки пройдены, 1 - есть непройденные проверки
+ */
+int main()
+{
+    // Классы символов нужны шифрам; на машинах без русской локали годится любая локаль UTF-8
+    try {
+        std::locale::global(std::locale("ru_RU.UTF-8"));
+    } catch (const std::runtime_error&) {
+        try {
+            std::locale::global(std::locale("C.UTF-8"));
+        } catch (const std::runtime_error&) {
+            std::cerr << "ОШИБКА: не найдена локаль ru_RU.UTF-8 или C.UTF-8" << std::endl;
+            return 1;
+        }
+    }
+
+    std::cout << " ПРОВЕРКА СОСТАВНОГО ШИФРА" << std::endl;
+    std::cout << std::endl;
+
+    testChained();
+
+    std::cout << "Все тесты завершены";
+    if (failedChecks > 0) {
+        std::cout << ", непройденных проверок: " << failedChecks << std::endl;
+        return 1;
+    }
+    std::cout << "." << std::endl;
+    return 0;
+}
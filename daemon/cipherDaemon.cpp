@@ -0,0 +1,533 @@
+/**
+ * @file cipherDaemon.cpp
+ * @brief Реализация демона шифрования
+ */
+
+#include "cipherDaemon.h"
+#include "../common/utf8.h"
+#include <cerrno>
+#include <chrono>
+#include <climits>
+#include <cstring>
+#include <system_error>
+#include <utility>
+#include <fcntl.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+namespace {
+
+/// Количество событий, забираемых одним вызовом epoll_wait
+constexpr int maxEvents = 256;
+
+/// Объем одного чтения из сокета
+constexpr std::size_t readChunk = std::size_t(64) << 10;
+
+/**
+ * @brief Исключение для системной ошибки
+ * @param what Описание действия
+ * @return Исключение с текущим errno
+ */
+std::system_error systemError(const char* what)
+{
+    return std::system_error(errno, std::generic_category(), what);
+}
+
+/**
+ * @brief Регистрация дескриптора в epoll
+ * @param epollFd Экземпляр epoll
+ * @param fd Дескриптор
+ * @param events Маска событий
+ * @param data Номер события
+ * @return true при успехе
+ */
+bool watch(int epollFd, int fd, std::uint32_t events, std::uint64_t data)
+{
+    epoll_event event{};
+    event.events = events;
+    event.data.u64 = data;
+    return epoll_ctl(epollFd, EPOLL_CTL_ADD, fd, &event) == 0;
+}
+
+/**
+ * @brief Ключ пакета
+ * @param header Заголовок запроса
+ * @param key Ключ Гронсфельда
+ * @return Строка, одинаковая для запросов с одинаковыми шифром, операцией и ключом
+ */
+std::string batchKey(const RequestHeader& header, std::string_view key)
+{
+    std::string result(6, '\0');
+    result[0] = static_cast<char>(header.cipher);
+    result[1] = static_cast<char>(header.operation);
+    putUint32(&result[2], header.tableKey);
+    result.append(key);
+    return result;
+}
+
+/**
+ * @brief Часть пакета для одной задачи пула
+ */
+struct BatchChunk {
+    std::size_t batch; ///< Номер пакета
+    std::size_t first; ///< Первое сообщение части
+    std::size_t last; ///< Сообщение после последнего
+    const CipherError* error = nullptr; ///< Ошибка ключа (все сообщения части получают ее)
+    BatchResult<char> result; ///< Результаты сообщений части
+};
+
+} // namespace
+
+/**
+ * @brief Конструктор: создание сокета и пула потоков
+ * @param daemonOptions Параметры демона
+ * @throw std::system_error Если сокет не удалось создать
+ */
+CipherDaemon::CipherDaemon(DaemonOptions daemonOptions)
+    : options(std::move(daemonOptions)), pool(options.workers > 0 ? options.workers : 1)
+{
+    sockaddr_un address{};
+    address.sun_family = AF_UNIX;
+    if (options.socketPath.empty() || options.socketPath.size() >= sizeof(address.sun_path)) {
+        throw std::system_error(ENAMETOOLONG, std::generic_category(), "socket path");
+    }
+    std::memcpy(address.sun_path, options.socketPath.c_str(), options.socketPath.size() + 1);
+
+    listenFd = socket(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    if (listenFd < 0) {
+        throw systemError("socket");
+    }
+    if (bind(listenFd, reinterpret_cast<sockaddr*>(&address), sizeof(address)) != 0) {
+        // Сокет, к которому никто не подключен, остался от завершившегося демона
+        int probe = (errno == EADDRINUSE) ? socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0) : -1;
+        const bool stale = probe >= 0 && connect(probe, reinterpret_cast<sockaddr*>(&address), sizeof(address)) != 0 && errno == ECONNREFUSED;
+        if (probe >= 0) {
+            close(probe);
+        }
+        if (!stale || unlink(options.socketPath.c_str()) != 0 ||
+            bind(listenFd, reinterpret_cast<sockaddr*>(&address), sizeof(address)) != 0) {
+            const std::system_error error = systemError("bind");
+            close(listenFd);
+            throw error;
+        }
+    }
+    if (listen(listenFd, SOMAXCONN) != 0) {
+        const std::system_error error = systemError("listen");
+        close(listenFd);
+        unlink(options.socketPath.c_str());
+        throw error;
+    }
+
+    epollFd = epoll_create1(EPOLL_CLOEXEC);
+    stopFd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    if (epollFd < 0 || stopFd < 0 || !watch(epollFd, listenFd, EPOLLIN, listenEvent) || !watch(epollFd, stopFd, EPOLLIN, stopEvent)) {
+        const std::system_error error = systemError("epoll");
+        if (epollFd >= 0) {
+            close(epollFd);
+        }
+        if (stopFd >= 0) {
+            close(stopFd);
+        }
+        close(listenFd);
+        unlink(options.socketPath.c_str());
+        throw error;
+    }
+}
+
+/**
+ * @brief Деструктор: закрытие соединений и удаление файла сокета
+ */
+CipherDaemon::~CipherDaemon()
+{
+    for (auto& entry : connections) {
+        close(entry.second.fd);
+    }
+    close(epollFd);
+    close(stopFd);
+    close(listenFd);
+    unlink(options.socketPath.c_str());
+}
+
+/**
+ * @brief Остановка цикла событий
+ */
+void CipherDaemon::stop()
+{
+    const std::uint64_t one = 1;
+    ssize_t written = write(stopFd, &one, sizeof(one));
+    (void)written;
+}
+
+/**
+ * @brief Цикл событий
+ * @details Пока есть накопленные запросы, epoll_wait ждет не дольше остатка окна
+ * batchWindowMs; после разбора событий пакеты выполняются, если окно истекло
+ * или накоплено maxBatchRequests запросов
+ * @throw std::system_error При ошибке epoll
+ */
+void CipherDaemon::run()
+{
+    using Clock = std::chrono::steady_clock;
+    epoll_event events[maxEvents];
+    Clock::time_point batchStart;
+    bool stopping = false;
+    while (!stopping) {
+        int timeout = -1;
+        if (pendingRequests > 0) {
+            const auto waited = std::chrono::duration_cast<std::chrono::milliseconds>(Clock::now() - batchStart).count();
+            timeout = (waited < options.batchWindowMs) ? static_cast<int>(options.batchWindowMs - waited) : 0;
+        }
+        const int count = epoll_wait(epollFd, events, maxEvents, timeout);
+        if (count < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            throw systemError("epoll_wait");
+        }
+
+        const bool wasIdle = (pendingRequests == 0);
+        for (int i = 0; i < count; i++) {
+            const std::uint64_t id = events[i].data.u64;
+            if (id == listenEvent) {
+                acceptConnections();
+            } else if (id == stopEvent) {
+                stopping = true;
+            } else {
+                bool alive = true;
+                if (events[i].events & (EPOLLIN | EPOLLRDHUP | EPOLLHUP | EPOLLERR)) {
+                    alive = readConnection(id);
+                }
+                if (alive && (events[i].events & EPOLLOUT)) {
+                    alive = writeConnection(id);
+                }
+                if (!alive) {
+                    closeConnection(id);
+                }
+            }
+        }
+        if (wasIdle && pendingRequests > 0) {
+            batchStart = Clock::now();
+        }
+
+        if (pendingRequests > 0 && (stopping || options.batchWindowMs <= 0 || pendingRequests >= options.maxBatchRequests ||
+                                    Clock::now() - batchStart >= std::chrono::milliseconds(options.batchWindowMs))) {
+            flush();
+        }
+    }
+}
+
+/**
+ * @brief Прием всех ожидающих соединений
+ */
+void CipherDaemon::acceptConnections()
+{
+    while (true) {
+        const int fd = accept4(listenFd, nullptr, nullptr, SOCK_NONBLOCK | SOCK_CLOEXEC);
+        if (fd < 0) {
+            return;
+        }
+        const std::uint64_t id = nextConnection++;
+        if (!watch(epollFd, fd, EPOLLIN | EPOLLOUT | EPOLLRDHUP | EPOLLET, id)) {
+            close(fd);
+            continue;
+        }
+        connections[id].fd = fd;
+        stats.connections++;
+    }
+}
+
+/**
+ * @brief Чтение и разбор кадров соединения
+ * @details Сокет читается до EAGAIN (события epoll с флагом EPOLLET), затем
+ * из буфера извлекаются все полные кадры
+ * @param id Номер соединения
+ * @return false, если соединение нужно закрыть
+ */
+bool CipherDaemon::readConnection(std::uint64_t id)
+{
+    auto found = connections.find(id);
+    if (found == connections.end()) {
+        return true;
+    }
+    Connection& connection = found->second;
+    while (!connection.peerClosed) {
+        const std::size_t size = connection.input.size();
+        connection.input.resize(size + readChunk);
+        const ssize_t received = recv(connection.fd, &connection.input[size], readChunk, 0);
+        connection.input.resize(size + (received > 0 ? static_cast<std::size_t>(received) : 0));
+        if (received == 0) {
+            connection.peerClosed = true;
+        } else if (received < 0) {
+            if (errno == EAGAIN || errno == EWOULDBLOCK) {
+                break;
+            }
+            if (errno != EINTR) {
+                return false;
+            }
+        }
+    }
+
+    while (connection.input.size() - connection.parsed >= requestHeaderSize) {
+        const char* frame = connection.input.data() + connection.parsed;
+        RequestHeader header;
+        if (!parseRequestHeader(frame, header)) {
+            return false;
+        }
+        const std::size_t frameSize = requestHeaderSize + header.keyLength + header.textLength;
+        if (connection.input.size() - connection.parsed < frameSize) {
+            break;
+        }
+        const std::string_view key(frame + requestHeaderSize, header.keyLength);
+        const std::string_view text(frame + requestHeaderSize + header.keyLength, header.textLength);
+        enqueue(id, header, key, text);
+        connection.inFlight++;
+        connection.parsed += frameSize;
+    }
+    if (connection.parsed == connection.input.size()) {
+        connection.input.clear();
+        connection.parsed = 0;
+    } else if (connection.parsed > connection.input.size() / 2) {
+        connection.input.erase(0, connection.parsed);
+        connection.parsed = 0;
+    }
+    return !(connection.peerClosed && connection.inFlight == 0 && connection.sent == connection.output.size());
+}
+
+/**
+ * @brief Отправка накопленных ответов соединения
+ * @param id Номер соединения
+ * @return false, если соединение нужно закрыть
+ */
+bool CipherDaemon::writeConnection(std::uint64_t id)
+{
+    auto found = connections.find(id);
+    if (found == connections.end()) {
+        return true;
+    }
+    Connection& connection = found->second;
+    while (connection.sent < connection.output.size()) {
+        const ssize_t written = send(connection.fd, connection.output.data() + connection.sent,
+                                     connection.output.size() - connection.sent, MSG_NOSIGNAL);
+        if (written < 0) {
+            if (errno == EAGAIN || errno == EWOULDBLOCK) {
+                return true;
+            }
+            if (errno != EINTR) {
+                return false;
+            }
+            continue;
+        }
+        connection.sent += static_cast<std::size_t>(written);
+    }
+    connection.output.clear();
+    connection.sent = 0;
+    return !(connection.peerClosed && connection.inFlight == 0);
+}
+
+/**
+ * @brief Закрытие соединения
+ * @details Запросы соединения, уже попавшие в пакеты, выполняются, но ответы на них отбрасываются
+ * @param id Номер соединения
+ */
+void CipherDaemon::closeConnection(std::uint64_t id)
+{
+    auto found = connections.find(id);
+    if (found != connections.end()) {
+        close(found->second.fd);
+        connections.erase(found);
+    }
+}
+
+/**
+ * @brief Постановка запроса в пакет
+ * @param id Номер соединения
+ * @param header Заголовок запроса
+ * @param key Ключ Гронсфельда
+ * @param text Текст запроса
+ */
+void CipherDaemon::enqueue(std::uint64_t id, const RequestHeader& header, std::string_view key, std::string_view text)
+{
+    if (header.cipher == CipherKind::table) {
+        key = {};
+    }
+    auto slot = batchIndex.try_emplace(batchKey(header, key), batches.size());
+    if (slot.second) {
+        batches.push_back(Batch{header.cipher, header.operation, std::string(key), header.tableKey, {}, {0}, {}});
+    }
+    Batch& batch = batches[slot.first->second];
+    batch.arena.append(text);
+    batch.offsets.push_back(batch.arena.size());
+    batch.senders.push_back(Sender{id, header.id});
+    pendingRequests++;
+}
+
+/**
+ * @brief Шифр Гронсфельда для ключа
+ * @details Ключ переводится из UTF-8 без локали; некорректная последовательность
+ * считается недопустимым символом ключа. Ошибки ключа тоже кэшируются. Найденный
+ * шифр переносится в начало списка; размер кэша ограничивается в конце flush()
+ * удалением давно использованных шифров, когда ссылки на шифры больше не нужны
+ * @param key Ключ в UTF-8
+ * @return Шифр или ошибка ключа
+ */
+const CipherResult<modAlphaCipher>& CipherDaemon::gronsfeldCipher(const std::string& key)
+{
+    auto found = gronsfeldIndex.find(key);
+    if (found != gronsfeldIndex.end()) {
+        stats.cipherHits++;
+        gronsfeldCiphers.splice(gronsfeldCiphers.begin(), gronsfeldCiphers, found->second);
+        return found->second->cipher;
+    }
+    stats.cipherMisses++;
+
+    CipherResult<modAlphaCipher> cipher = [&key]() -> CipherResult<modAlphaCipher> {
+        std::wstring wideKey;
+        const char* p = key.data();
+        const char* end = p + key.size();
+        while (p < end) {
+            const char* at = p;
+            const char32_t c = utf8Decode(p, end);
+            if (c == utf8Invalid) {
+                return {CipherErrc::invalidKeySymbol, static_cast<std::size_t>(at - key.data())};
+            }
+            wideKey.push_back(static_cast<wchar_t>(c));
+        }
+        return modAlphaCipher::create(wideKey);
+    }();
+    gronsfeldCiphers.push_front(CachedCipher{key, std::move(cipher)});
+    gronsfeldIndex.emplace(key, gronsfeldCiphers.begin());
+    return gronsfeldCiphers.front().cipher;
+}
+
+/**
+ * @brief Шифр таблицы для ключа
+ * @param key Количество столбцов
+ * @return Шифр; nullptr, если ключ некорректен
+ */
+const TableCipher* CipherDaemon::tableCipher(std::uint32_t key)
+{
+    auto found = tableCiphers.find(key);
+    if (found != tableCiphers.end()) {
+        stats.cipherHits++;
+        return &found->second;
+    }
+    stats.cipherMisses++;
+    if (key > static_cast<std::uint32_t>(INT_MAX) || TableCipher::checkKey(static_cast<int>(key))) {
+        return nullptr;
+    }
+    return &tableCiphers.emplace(key, TableCipher(static_cast<int>(key))).first->second;
+}
+
+/**
+ * @brief Выполнение накопленных пакетов и отправка ответов
+ * @details Пакеты делятся на части примерно по chunkBytes байт текста по границам
+ * сообщений, и все части всех пакетов выполняются одним вызовом пула. Ответы
+ * дописываются в буферы соединений и сразу отправляются. В конце, когда ссылки
+ * на шифры больше не нужны, кэш шифров Гронсфельда сокращается до cipherCacheSize
+ * удалением давно использованных ключей (с конца списка)
+ */
+void CipherDaemon::flush()
+{
+    std::vector<BatchChunk> chunks;
+    std::vector<CipherError> keyErrors(batches.size());
+    std::vector<const modAlphaCipher*> gronsfeld(batches.size(), nullptr);
+    std::vector<const TableCipher*> table(batches.size(), nullptr);
+    for (std::size_t b = 0; b < batches.size(); b++) {
+        const Batch& batch = batches[b];
+        if (batch.cipher == CipherKind::gronsfeld) {
+            const CipherResult<modAlphaCipher>& cipher = gronsfeldCipher(batch.key);
+            if (cipher) {
+                gronsfeld[b] = &*cipher;
+            } else {
+                keyErrors[b] = cipher.error();
+            }
+        } else {
+            table[b] = tableCipher(batch.tableKey);
+            if (!table[b]) {
+                keyErrors[b] = (batch.tableKey > static_cast<std::uint32_t>(INT_MAX)) ? CipherError{CipherErrc::keyTooLarge, 0}
+                                                                                        : TableCipher::checkKey(static_cast<int>(batch.tableKey));
+            }
+        }
+
+        const std::size_t count = batch.senders.size();
+        std::size_t first = 0;
+        while (first < count) {
+            std::size_t last = first + 1;
+            while (last < count && batch.offsets[last + 1] - batch.offsets[first] <= options.chunkBytes) {
+                last++;
+            }
+            chunks.push_back(BatchChunk{b, first, last, keyErrors[b] ? &keyErrors[b] : nullptr, {}});
+            first = last;
+        }
+    }
+
+    pool.run(chunks.size(), [&](std::size_t i) {
+        BatchChunk& chunk = chunks[i];
+        if (chunk.error) {
+            return;
+        }
+        const Batch& batch = batches[chunk.batch];
+        const std::size_t base = batch.offsets[chunk.first];
+        const std::string_view messages(batch.arena.data() + base, batch.offsets[chunk.last] - base);
+        std::vector<std::size_t> offsets(batch.offsets.begin() + chunk.first, batch.offsets.begin() + chunk.last + 1);
+        for (std::size_t& offset : offsets) {
+            offset -= base;
+        }
+        const bool encrypting = (batch.operation == CipherOperation::encrypt);
+        if (gronsfeld[chunk.batch]) {
+            chunk.result = encrypting ? gronsfeld[chunk.batch]->encryptBatch(messages, offsets)
+                                      : gronsfeld[chunk.batch]->decryptBatch(messages, offsets);
+        } else {
+            chunk.result = encrypting ? table[chunk.batch]->encryptBatch(messages, offsets)
+                                      : table[chunk.batch]->decryptBatch(messages, offsets);
+        }
+    });
+
+    std::vector<std::uint64_t> touched;
+    for (const BatchChunk& chunk : chunks) {
+        const Batch& batch = batches[chunk.batch];
+        for (std::size_t m = chunk.first; m < chunk.last; m++) {
+            const Sender& sender = batch.senders[m];
+            auto found = connections.find(sender.connection);
+            if (found == connections.end()) {
+                continue;
+            }
+            Connection& connection = found->second;
+            ResponseHeader response;
+            response.id = sender.id;
+            std::string_view text;
+            CipherError error = chunk.error ? *chunk.error : chunk.result.errors[m - chunk.first];
+            if (error) {
+                response.status = error.code;
+                response.offset = static_cast<std::uint32_t>(error.offset);
+            } else {
+                text = chunk.result.message(m - chunk.first);
+            }
+            if (connection.output.empty()) {
+                touched.push_back(sender.connection);
+            }
+            appendResponse(connection.output, response, text);
+            connection.inFlight--;
+        }
+    }
+
+    stats.flushes++;
+    stats.batches += batches.size();
+    stats.requests += pendingRequests;
+    batches.clear();
+    batchIndex.clear();
+    pendingRequests = 0;
+    while (gronsfeldCiphers.size() > options.cipherCacheSize) {
+        gronsfeldIndex.erase(gronsfeldCiphers.back().key);
+        gronsfeldCiphers.pop_back();
+    }
+
+    for (std::uint64_t id : touched) {
+        if (!writeConnection(id)) {
+            closeConnection(id);
+        }
+    }
+}
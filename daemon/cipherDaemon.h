@@ -0,0 +1,226 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <list>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+#include "cipherProtocol.h"
+#include "../alpha_doc/modAlphaCipher.h"
+#include "../route_doc/tableCipher.h"
+#include "../common/threadPool.h"
+
+/**
+ * @file
+ * @author Ганьшин В.А.
+ * @version 1.0
+ * @date 17.12.2025
+ * @brief Демон шифрования modAlphaCipher и TableCipher на сокете Unix
+ * @details Один поток ведет цикл событий epoll: принимает соединения, читает
+ * кадры запросов (см. cipherProtocol.h) и пишет ответы. Запросы с одинаковыми
+ * шифром, операцией и ключом складываются в общий пакет прямо при разборе кадра.
+ * Когда готовые события разобраны (и, если задано, истекло окно ожидания), все
+ * накопленные пакеты делятся на части по границам сообщений и выполняются пулом
+ * потоков через encryptBatch()/decryptBatch(). Поэтому чем больше одновременных
+ * клиентов, тем крупнее пакеты. Пока пул работает, цикл событий не читает сокеты,
+ * и пришедшие за это время запросы попадают в следующий пакет. Объекты шифров
+ * хранятся в кэше по ключу и создаются только для новых ключей.
+ */
+
+/**
+ * @brief Параметры демона
+ */
+struct DaemonOptions {
+    std::string socketPath; ///< Путь к сокету Unix
+    std::size_t workers = std::thread::hardware_concurrency(); ///< Количество потоков пула
+    int batchWindowMs = 0; ///< Сколько ждать новых запросов перед выполнением пакета, мс (0 - не ждать)
+    std::size_t maxBatchRequests = 4096; ///< Количество запросов, после которого пакет выполняется без ожидания
+    std::size_t chunkBytes = std::size_t(64) << 10; ///< Объем текста на одну задачу пула, байт
+    std::size_t cipherCacheSize = 1024; ///< Наибольшее количество ключей Гронсфельда в кэше
+};
+
+/**
+ * @brief Статистика работы демона
+ */
+struct DaemonStats {
+    std::uint64_t connections = 0; ///< Принято соединений
+    std::uint64_t requests = 0; ///< Выполнено запросов
+    std::uint64_t batches = 0; ///< Выполнено пакетов (групп запросов с одним шифром и ключом)
+    std::uint64_t flushes = 0; ///< Запусков пула
+    std::uint64_t cipherHits = 0; ///< Пакетов, для которых шифр взят из кэша
+    std::uint64_t cipherMisses = 0; ///< Пакетов, для которых шифр создан заново
+};
+
+/**
+ * @brief Демон шифрования
+ *
+ * Пример использования:
+ * @code
+ * DaemonOptions options;
+ * options.socketPath = "/run/cipher.sock";
+ * CipherDaemon daemon(options);
+ * daemon.run();
+ * @endcode
+ */
+class CipherDaemon
+{
+private:
+    /**
+     * @brief Соединение с клиентом
+     */
+    struct Connection {
+        int fd = -1; ///< Дескриптор сокета
+        std::string input; ///< Принятые, но не разобранные байты
+        std::size_t parsed = 0; ///< Количество разобранных байт в начале input
+        std::string output; ///< Неотправленные ответы
+        std::size_t sent = 0; ///< Количество отправленных байт в начале output
+        std::size_t inFlight = 0; ///< Запросы, ожидающие выполнения
+        bool peerClosed = false; ///< Клиент закрыл передачу
+    };
+
+    /**
+     * @brief Отправитель запроса в пакете
+     */
+    struct Sender {
+        std::uint64_t connection; ///< Номер соединения
+        std::uint32_t id; ///< Номер запроса
+    };
+
+    /**
+     * @brief Шифр Гронсфельда в кэше
+     */
+    struct CachedCipher {
+        std::string key; ///< Ключ в UTF-8
+        CipherResult<modAlphaCipher> cipher; ///< Шифр или ошибка ключа
+    };
+
+    /**
+     * @brief Пакет запросов с одинаковыми шифром, операцией и ключом
+     */
+    struct Batch {
+        CipherKind cipher; ///< Шифр
+        CipherOperation operation; ///< Операция
+        std::string key; ///< Ключ Гронсфельда в UTF-8
+        std::uint32_t tableKey; ///< Количество столбцов таблицы
+        std::string arena; ///< Тексты запросов подряд
+        std::vector<std::size_t> offsets{0}; ///< Смещения текстов в arena
+        std::vector<Sender> senders; ///< Отправители запросов
+    };
+
+    DaemonOptions options; ///< Параметры
+    int listenFd = -1; ///< Слушающий сокет
+    int epollFd = -1; ///< Экземпляр epoll
+    int stopFd = -1; ///< eventfd для остановки цикла
+    ThreadPool pool; ///< Пул потоков
+    std::uint64_t nextConnection = firstConnection; ///< Номер следующего соединения
+    std::unordered_map<std::uint64_t, Connection> connections; ///< Открытые соединения
+    std::vector<Batch> batches; ///< Накопленные пакеты
+    std::unordered_map<std::string, std::size_t> batchIndex; ///< Номер пакета по шифру, операции и ключу
+    std::size_t pendingRequests = 0; ///< Количество запросов в накопленных пакетах
+    std::list<CachedCipher> gronsfeldCiphers; ///< Шифры Гронсфельда (или ошибки ключа) от недавно использованных к давно использованным
+    std::unordered_map<std::string, std::list<CachedCipher>::iterator> gronsfeldIndex; ///< Поиск шифра Гронсфельда по ключу
+    std::unordered_map<std::uint32_t, TableCipher> tableCiphers; ///< Шифры таблицы по количеству столбцов
+    DaemonStats stats; ///< Статистика
+
+    /// Номер события слушающего сокета
+    static constexpr std::uint64_t listenEvent = 0;
+
+    /// Номер события остановки
+    static constexpr std::uint64_t stopEvent = 1;
+
+    /// Номер первого соединения
+    static constexpr std::uint64_t firstConnection = 2;
+
+    /**
+     * @brief Прием всех ожидающих соединений
+     */
+    void acceptConnections();
+
+    /**
+     * @brief Чтение и разбор кадров соединения
+     * @param id Номер соединения
+     * @return false, если соединение нужно закрыть (ошибка или нарушение протокола)
+     */
+    bool readConnection(std::uint64_t id);
+
+    /**
+     * @brief Отправка накопленных ответов соединения
+     * @param id Номер соединения
+     * @return false, если соединение нужно закрыть
+     */
+    bool writeConnection(std::uint64_t id);
+
+    /**
+     * @brief Закрытие соединения
+     * @param id Номер соединения
+     */
+    void closeConnection(std::uint64_t id);
+
+    /**
+     * @brief Постановка запроса в пакет
+     * @param id Номер соединения
+     * @param header Заголовок запроса
+     * @param key Ключ Гронсфельда
+     * @param text Текст запроса
+     */
+    void enqueue(std::uint64_t id, const RequestHeader& header, std::string_view key, std::string_view text);
+
+    /**
+     * @brief Выполнение накопленных пакетов и отправка ответов
+     */
+    void flush();
+
+    /**
+     * @brief Шифр Гронсфельда для ключа
+     * @param key Ключ в UTF-8
+     * @return Шифр из кэша или новый шифр; ошибка ключа
+     */
+    const CipherResult<modAlphaCipher>& gronsfeldCipher(const std::string& key);
+
+    /**
+     * @brief Шифр таблицы для ключа
+     * @param key Количество столбцов
+     * @return Шифр из кэша или новый шифр; nullptr, если ключ некорректен
+     */
+    const TableCipher* tableCipher(std::uint32_t key);
+
+public:
+    /**
+     * @brief Конструктор: создание сокета и пула потоков
+     * @details Если по пути сокета уже есть сокет, к которому нельзя подключиться
+     * (остался от завершившегося процесса), он удаляется
+     * @param daemonOptions Параметры демона
+     * @throw std::system_error Если сокет не удалось создать
+     */
+    explicit CipherDaemon(DaemonOptions daemonOptions);
+
+    /**
+     * @brief Деструктор: закрытие соединений и удаление файла сокета
+     */
+    ~CipherDaemon();
+
+    CipherDaemon(const CipherDaemon&) = delete;
+    CipherDaemon& operator=(const CipherDaemon&) = delete;
+
+    /**
+     * @brief Цикл событий
+     * @details Возвращает управление после вызова stop()
+     * @throw std::system_error При ошибке epoll
+     */
+    void run();
+
+    /**
+     * @brief Остановка цикла событий
+     * @details Можно вызывать из другого потока и из обработчика сигнала
+     */
+    void stop();
+
+    /**
+     * @brief Статистика работы
+     * @return Счетчики с момента запуска
+     */
+    const DaemonStats& statistics() const {
+        return stats;
+    }
+};
@@ -0,0 +1,190 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include "../common/cipherResult.h"
+
+/**
+ * @file
+ * @author Ганьшин В.А.
+ * @version 1.0
+ * @date 17.12.2025
+ * @brief Двоичный протокол демона шифрования
+ * @details Клиент и демон обмениваются кадрами через потоковый сокет Unix.
+ * Все целые числа записываются в порядке little-endian.
+ *
+ * Кадр запроса: заголовок requestHeaderSize байт, затем ключ и текст (UTF-8):
+ * | Смещение | Размер | Поле                                         |
+ * |----------|--------|----------------------------------------------|
+ * | 0        | 4      | id - номер запроса, возвращается в ответе    |
+ * | 4        | 1      | cipher - шифр (CipherKind)                   |
+ * | 5        | 1      | operation - операция (CipherOperation)       |
+ * | 6        | 2      | keyLength - длина ключа Гронсфельда в байтах |
+ * | 8        | 4      | tableKey - количество столбцов таблицы       |
+ * | 12       | 4      | textLength - длина текста в байтах           |
+ *
+ * Кадр ответа: заголовок responseHeaderSize байт, затем результат (UTF-8):
+ * | Смещение | Размер | Поле                                               |
+ * |----------|--------|----------------------------------------------------|
+ * | 0        | 4      | id - номер запроса                                 |
+ * | 4        | 4      | status - код ошибки CipherErrc (0 - успех)         |
+ * | 8        | 4      | offset - позиция ошибочного символа в байтах       |
+ * | 12       | 4      | textLength - длина результата в байтах (0 при ошибке) |
+ *
+ * Ответы на запросы одного соединения могут приходить не в порядке запросов,
+ * поэтому клиент сопоставляет их по id. Некорректный заголовок (неизвестный шифр
+ * или операция, слишком длинный текст) закрывает соединение.
+ */
+
+/// Размер заголовка кадра запроса в байтах
+constexpr std::size_t requestHeaderSize = 16;
+
+/// Размер заголовка кадра ответа в байтах
+constexpr std::size_t responseHeaderSize = 16;
+
+/// Наибольшая длина текста одного запроса в байтах
+constexpr std::size_t maxRequestText = std::size_t(64) << 20;
+
+/**
+ * @brief Шифр запроса
+ */
+enum class CipherKind : std::uint8_t {
+    gronsfeld = 1, ///< modAlphaCipher, ключ - буквы алфавита в поле ключа
+    table = 2 ///< TableCipher, ключ - поле tableKey
+};
+
+/**
+ * @brief Операция запроса
+ */
+enum class CipherOperation : std::uint8_t {
+    encrypt = 1, ///< Зашифровать текст
+    decrypt = 2 ///< Расшифровать текст
+};
+
+/**
+ * @brief Заголовок кадра запроса
+ */
+struct RequestHeader {
+    std::uint32_t id = 0; ///< Номер запроса
+    CipherKind cipher = CipherKind::gronsfeld; ///< Шифр
+    CipherOperation operation = CipherOperation::encrypt; ///< Операция
+    std::uint16_t keyLength = 0; ///< Длина ключа Гронсфельда в байтах
+    std::uint32_t tableKey = 0; ///< Количество столбцов таблицы
+    std::uint32_t textLength = 0; ///< Длина текста в байтах
+};
+
+/**
+ * @brief Заголовок кадра ответа
+ */
+struct ResponseHeader {
+    std::uint32_t id = 0; ///< Номер запроса
+    CipherErrc status = CipherErrc::ok; ///< Код ошибки
+    std::uint32_t offset = 0; ///< Позиция ошибочного символа в байтах
+    std::uint32_t textLength = 0; ///< Длина результата в байтах
+};
+
+/**
+ * @brief Запись 32-битного числа в порядке little-endian
+ * @param out Буфер не меньше 4 байт
+ * @param value Число
+ */
+inline void putUint32(char* out, std::uint32_t value)
+{
+    for (int i = 0; i < 4; i++) {
+        out[i] = static_cast<char>((value >> (8 * i)) & 0xFF);
+    }
+}
+
+/**
+ * @brief Чтение 32-битного числа в порядке little-endian
+ * @param in Буфер не меньше 4 байт
+ * @return Число
+ */
+inline std::uint32_t getUint32(const char* in)
+{
+    std::uint32_t value = 0;
+    for (int i = 0; i < 4; i++) {
+        value |= static_cast<std::uint32_t>(static_cast<unsigned char>(in[i])) << (8 * i);
+    }
+    return value;
+}
+
+/**
+ * @brief Разбор заголовка запроса
+ * @param in Буфер не меньше requestHeaderSize байт
+ * @param header Заголовок
+ * @return true, если шифр, операция и длина текста допустимы
+ */
+inline bool parseRequestHeader(const char* in, RequestHeader& header)
+{
+    header.id = getUint32(in);
+    const auto cipher = static_cast<unsigned char>(in[4]);
+    const auto operation = static_cast<unsigned char>(in[5]);
+    header.keyLength = static_cast<std::uint16_t>(static_cast<unsigned char>(in[6]) | (static_cast<unsigned char>(in[7]) << 8));
+    header.tableKey = getUint32(in + 8);
+    header.textLength = getUint32(in + 12);
+    if (cipher != static_cast<unsigned char>(CipherKind::gronsfeld) && cipher != static_cast<unsigned char>(CipherKind::table)) {
+        return false;
+    }
+    if (operation != static_cast<unsigned char>(CipherOperation::encrypt) && operation != static_cast<unsigned char>(CipherOperation::decrypt)) {
+        return false;
+    }
+    header.cipher = static_cast<CipherKind>(cipher);
+    header.operation = static_cast<CipherOperation>(operation);
+    return header.textLength <= maxRequestText;
+}
+
+/**
+ * @brief Добавление кадра запроса в буфер
+ * @param out Буфер отправки
+ * @param header Заголовок (поля keyLength и textLength берутся из key и text)
+ * @param key Ключ Гронсфельда в UTF-8 (пустой для TableCipher)
+ * @param text Текст в UTF-8
+ */
+inline void appendRequest(std::string& out, const RequestHeader& header, std::string_view key, std::string_view text)
+{
+    char head[requestHeaderSize];
+    putUint32(head, header.id);
+    head[4] = static_cast<char>(header.cipher);
+    head[5] = static_cast<char>(header.operation);
+    head[6] = static_cast<char>(key.size() & 0xFF);
+    head[7] = static_cast<char>((key.size() >> 8) & 0xFF);
+    putUint32(head + 8, header.tableKey);
+    putUint32(head + 12, static_cast<std::uint32_t>(text.size()));
+    out.append(head, requestHeaderSize);
+    out.append(key);
+    out.append(text);
+}
+
+/**
+ * @brief Добавление кадра ответа в буфер
+ * @param out Буфер отправки
+ * @param header Заголовок (поле textLength берется из text)
+ * @param text Результат в UTF-8
+ */
+inline void appendResponse(std::string& out, const ResponseHeader& header, std::string_view text)
+{
+    char head[responseHeaderSize];
+    putUint32(head, header.id);
+    putUint32(head + 4, static_cast<std::uint32_t>(header.status));
+    putUint32(head + 8, header.offset);
+    putUint32(head + 12, static_cast<std::uint32_t>(text.size()));
+    out.append(head, responseHeaderSize);
+    out.append(text);
+}
+
+/**
+ * @brief Разбор заголовка ответа
+ * @param in Буфер не меньше responseHeaderSize байт
+ * @return Заголовок ответа
+ */
+inline ResponseHeader parseResponseHeader(const char* in)
+{
+    ResponseHeader header;
+    header.id = getUint32(in);
+    header.status = static_cast<CipherErrc>(getUint32(in + 4));
+    header.offset = getUint32(in + 8);
+    header.textLength = getUint32(in + 12);
+    return header;
+}
@@ -0,0 +1,146 @@
+/**
+ * @file main.cpp
+ * @author Ганьшин В.А.
+ * @version 1.0
+ * @date 17.12.2025
+ * @brief Главный модуль демона шифрования
+ * @details Запускает CipherDaemon на заданном сокете Unix и работает до сигнала
+ * SIGINT или SIGTERM, после чего выводит статистику в стандартный поток ошибок.
+ *
+ * Сборка из корня репозитория:
+ * @code
+ * g++ -std=c++17 -O2 -pthread daemon/main.cpp daemon/cipherDaemon.cpp \
+ *     alpha_doc/modAlphaCipher.cpp alpha_doc/gronsfeldKernel.cpp \
+ *     route_doc/tableCipher.cpp route_doc/routeKernel.cpp route_doc/tablePlan.cpp route_doc/routeEngine.cpp route_doc/tableFile.cpp \
+ *     common/threadPool.cpp -o cipherDaemon
+ * @endcode
+ *
+ * Пример запуска:
+ * @code
+ * ./cipherDaemon --socket /tmp/cipher.sock --workers 8 --batch-window 1
+ * @endcode
+ */
+
+#include "cipherDaemon.h"
+#include <csignal>
+#include <iostream>
+#include <locale>
+#include <stdexcept>
+#include <string>
+#include <system_error>
+
+namespace {
+
+/// Демон, которому обработчик сигнала передает остановку
+CipherDaemon* runningDaemon = nullptr;
+
+/**
+ * @brief Обработчик SIGINT и SIGTERM
+ */
+void handleStop(int)
+{
+    if (runningDaemon) {
+        runningDaemon->stop();
+    }
+}
+
+/**
+ * @brief Вывод справки по параметрам
+ * @param program Имя программы
+ */
+void printUsage(const char* program)
+{
+    std::cerr << "Использование: " << program << " --socket PATH [параметры]\n"
+              << "  --socket PATH       путь к сокету Unix\n"
+              << "  --workers N         количество потоков пула (по умолчанию - количество ядер)\n"
+              << "  --batch-window MS   сколько ждать новых запросов перед выполнением пакета (по умолчанию 0)\n"
+              << "  --max-batch N       количество запросов, после которого пакет выполняется сразу (по умолчанию 4096)\n"
+              << "  --chunk BYTES       объем текста на одну задачу пула (по умолчанию 65536)\n"
+              << "  --cache N           наибольшее количество ключей Гронсфельда в кэше (по умолчанию 1024)\n";
+}
+
+/**
+ * @brief Разбор параметров командной строки
+ * @param argc Количество аргументов
+ * @param argv Аргументы
+ * @param options Параметры демона
+ * @return true, если параметры разобраны успешно
+ */
+bool parseOptions(int argc, char** argv, DaemonOptions& options)
+{
+    try {
+        for (int i = 1; i < argc; i++) {
+            const std::string arg = argv[i];
+            if (i + 1 >= argc) {
+                return false;
+            }
+            const std::string value = argv[++i];
+            if (arg == "--socket") {
+                options.socketPath = value;
+            } else if (arg == "--workers") {
+                options.workers = std::stoul(value);
+            } else if (arg == "--batch-window") {
+                options.batchWindowMs = std::stoi(value);
+            } else if (arg == "--max-batch") {
+                options.maxBatchRequests = std::stoul(value);
+            } else if (arg == "--chunk") {
+                options.chunkBytes = std::stoul(value);
+            } else if (arg == "--cache") {
+                options.cipherCacheSize = std::stoul(value);
+            } else {
+                return false;
+            }
+        }
+    } catch (const std::exception&) {
+        return false;
+    }
+    return !options.socketPath.empty();
+}
+
+} // namespace
+
+/**
+ * @brief Точка входа демона
+ * @param argc Количество аргументов
+ * @param argv Аргументы командной строки
+ * @return 0 при штатной остановке, 1 при ошибке
+ */
+int main(int argc, char** argv)
+{
+    // Классы символов нужны шифру таблицы; на машинах без русской локали
+    // годится любая локаль UTF-8
+    try {
+        std::locale::global(std::locale("ru_RU.UTF-8"));
+    } catch (const std::runtime_error&) {
+        try {
+            std::locale::global(std::locale("C.UTF-8"));
+        } catch (const std::runtime_error&) {
+            std::cerr << "Ошибка: не найдена локаль ru_RU.UTF-8 или C.UTF-8\n";
+            return 1;
+        }
+    }
+
+    DaemonOptions options;
+    if (!parseOptions(argc, argv, options)) {
+        printUsage(argv[0]);
+        return 1;
+    }
+
+    try {
+        CipherDaemon daemon(options);
+        runningDaemon = &daemon;
+        std::signal(SIGINT, handleStop);
+        std::signal(SIGTERM, handleStop);
+        daemon.run();
+        runningDaemon = nullptr;
+
+        const DaemonStats& stats = daemon.statistics();
+        std::cerr << "Соединений: " << stats.connections << ", запросов: " << stats.requests
+                  << ", пакетов: " << stats.batches << ", запусков пула: " << stats.flushes
+                  << ", шифров из кэша: " << stats.cipherHits << ", создано шифров: " << stats.cipherMisses << "\n";
+    } catch (const std::system_error& e) {
+        std::cerr << "Ошибка демона: " << e.what() << "\n";
+        return 1;
+    }
+    return 0;
+}
@@ -1,10 +1,24 @@
 #include "tableCipher.h"
+#include "tableFile.h"
+#include "tableKeySearch.h"
+#include "../common/utf8Transcode.h"
 #include <iostream>
 #include <string>
 #include <limits>
 #include <locale>
-#include <codecvt>
 #include <sstream>
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <random>
+#include <stdexcept>
+#include <vector>
+#include <stdlib.h>
+#include <unistd.h>
 
 /**
  * @file
@@ -12,27 +26,30 @@
  * @version 1.0
  * @date 17.12.2025
  * @brief Главный модуль программы шифрования табличной маршрутной перестановки
- * @details Содержит пользовательский интерфейс для работы с шифром табличной перестановки
+ * @details Содержит пользовательский интерфейс для работы с шифром табличной перестановки.
+ * С параметрами --key N --encrypt|--decrypt программа работает без меню: шифрует
+ * каждую строку стандартного ввода или файла и пишет результаты в стандартный вывод,
+ * например: `cat messages.txt | ./table --key 5 --encrypt > encrypted.txt`
  */
 
 /**
  * @brief Преобразование строки в широкую строку
  * @param str Обычная строка
  * @return Широкая строка
+ * @throw std::range_error При некорректной последовательности UTF-8
  */
 std::wstring string_to_wstring(const std::string& str) {
-    std::wstring_convert<std::codecvt_utf8<wchar_t>> converter;
-    return converter.from_bytes(str);
+    return utf8ToWide(str);
 }
 
 /**
  * @brief Преобразование широкой строки в обычную строку
  * @param wstr Широкая строка
  * @return Обычная строка
+ * @throw std::range_error Если строка содержит суррогат или код больше U+10FFFF
  */
 std::string wstring_to_string(const std::wstring& wstr) {
-    std::wstring_convert<std::codecvt_utf8<wchar_t>> converter;
-    return converter.to_bytes(wstr);
+    return wideToUtf8(wstr);
 }
 
 /**
@@ -144,30 +161,65 @@ void processCipherOperation(bool isEncryption) {
         }
         
     } catch (const table_cipher_error& e) {
-        std::wcout << L"ОШИБКА ШИФРОВАНИЯ: " << e.what() << std::endl;
-        
-        // Детализация типа ошибки
-        std::string error_msg = e.what();
-        if (error_msg.find("Пустой текст") != std::string::npos) {
-            std::wcout << L"   ТИП ОШИБКИ: Пустой текст" << std::endl;
-        } else if (error_msg.find("недопустимые символы") != std::string::npos) {
-            std::wcout << L"   ТИП ОШИБКИ: Недопустимые символы" << std::endl;
-        } else if (error_msg.find("Ключ должен быть") != std::string::npos) {
-            std::wcout << L"   ТИП ОШИБКИ: Некорректный ключ" << std::endl;
-        } else if (error_msg.find("Ключ не может быть больше") != std::string::npos) {
-            std::wcout << L"   ТИП ОШИБКИ: Ключ слишком большой" << std::endl;
-        } else if (error_msg.find("Слишком большая таблица") != std::string::npos) {
-            std::wcout << L"   ТИП ОШИБКИ: Слишком большой текст" << std::endl;
-        } else {
-            std::wcout << L"   ТИП ОШИБКИ: Неизвестная ошибка шифрования" << std::endl;
+        std::wcout << L"ОШИБКА ШИФРОВАНИЯ: " << string_to_wstring(e.what()) << std::endl;
+        
+        // Детализация типа ошибки по коду
+        switch (e.code()) {
+            case CipherErrc::emptyText:
+                std::wcout << L"   ТИП ОШИБКИ: Пустой текст" << std::endl;
+                break;
+            case CipherErrc::invalidSymbol:
+                std::wcout << L"   ТИП ОШИБКИ: Недопустимые символы (позиция "
+                           << e.error().offset << L")" << std::endl;
+                break;
+            case CipherErrc::keyNotPositive:
+                std::wcout << L"   ТИП ОШИБКИ: Некорректный ключ" << std::endl;
+                break;
+            case CipherErrc::keyLongerThanText:
+                std::wcout << L"   ТИП ОШИБКИ: Ключ слишком большой" << std::endl;
+                break;
+            case CipherErrc::tableTooLarge:
+                std::wcout << L"   ТИП ОШИБКИ: Слишком большой текст" << std::endl;
+                break;
+            default:
+                std::wcout << L"   ТИП ОШИБКИ: Неизвестная ошибка шифрования" << std::endl;
+                break;
         }
         
     } catch (const std::exception& e) {
-        std::wcout << L"КРИТИЧЕСКАЯ ОШИБКА: " << e.what() << std::endl;
+        std::wcout << L"КРИТИЧЕСКАЯ ОШИБКА: " << string_to_wstring(e.what()) << std::endl;
         std::wcout << L"   ТИП ОШИБКИ: Системная ошибка" << std::endl;
     }
 }
 
+/**
+ * @brief Построение тестового текста UTF-8 из русских слов через пробел
+ * @param words Количество слов
+ * @return Текст
+ */
+std::string sampleText(std::size_t words) {
+    const char* vocabulary[] = {"ТАБЛИЦА", "перестановка", "Ёж", "СТОЛБЕЦ", "строка", "ключ", "маршрут", "Я"};
+    std::mt19937 random(5);
+    std::string text;
+    for (std::size_t i = 0; i < words; i++) {
+        if (i > 0) {
+            text += ' ';
+        }
+        text += vocabulary[random() % 8];
+    }
+    return text;
+}
+
+/**
+ * @brief Чтение файла целиком
+ * @param path Путь к файлу
+ * @return Содержимое файла (пустое, если файл не открылся)
+ */
+std::string readFile(const std::string& path) {
+    std::ifstream file(path, std::ios::binary);
+    return std::string(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+}
+
 /**
  * @brief Демонстрация работы шифра на тестовых примерах
  * @details Показывает корректную работу шифра и обработку различных ошибок
@@ -192,7 +244,7 @@ void demonstrateCipher() {
             std::wcout << L"   Шифр работает корректно!" << std::endl;
         }
     } catch (const table_cipher_error& e) {
-        std::wcout << L"   Ошибка: " << e.what() << std::endl;
+        std::wcout << L"   Ошибка: " << string_to_wstring(e.what()) << std::endl;
     }
     
     // Тест 2: Ошибочный ключ
@@ -200,7 +252,7 @@ void demonstrateCipher() {
     try {
         TableCipher cipher(-5); // Отрицательный ключ
     } catch (const table_cipher_error& e) {
-        std::wcout << L"   Ошибка: " << e.what() << std::endl;
+        std::wcout << L"   Ошибка: " << string_to_wstring(e.what()) << std::endl;
     }
     
     // Тест 3: Пустой текст
@@ -209,7 +261,7 @@ void demonstrateCipher() {
         TableCipher cipher(3);
         std::wstring encrypted = cipher.encrypt(L"");
     } catch (const table_cipher_error& e) {
-        std::wcout << L"   Ошибка: " << e.what() << std::endl;
+        std::wcout << L"   Ошибка: " << string_to_wstring(e.what()) << std::endl;
     }
     
     // Тест 4: Ключ больше длины текста
@@ -218,7 +270,399 @@ void demonstrateCipher() {
         TableCipher cipher(10);
         std::wstring encrypted = cipher.encrypt(L"ПРИВЕТ");
     } catch (const table_cipher_error& e) {
-        std::wcout << L"   Ошибка: " << e.what() << std::endl;
+        std::wcout << L"   Ошибка: " << string_to_wstring(e.what()) << std::endl;
+    }
+    
+    // Тест 5: Пробелы сохраняются и переставляются вместе с буквами
+    std::wcout << L"\n ТЕСТ 5: Текст с пробелами" << std::endl;
+    try {
+        TableCipher cipher(4);
+        std::wstring original = L"ПРИВЕТ МИР КАК ДЕЛА";
+        std::wstring encrypted = cipher.encrypt(original);
+        std::wstring decrypted = cipher.decrypt(encrypted);
+        
+        std::wcout << L"   Исходный текст: '" << original << L"'" << std::endl;
+        std::wcout << L"   Ключ = 4" << std::endl;
+        std::wcout << L"   Зашифрованный:  '" << encrypted << L"'" << std::endl;
+        std::wcout << L"   Расшифрованный: '" << decrypted << L"'" << std::endl;
+        
+        if (original == decrypted && encrypted.size() == original.size()) {
+            std::wcout << L"   Шифр работает корректно!" << std::endl;
+        } else {
+            std::wcout << L"   Ошибка: расшифровка не совпадает с исходным текстом!" << std::endl;
+        }
+    } catch (const table_cipher_error& e) {
+        std::wcout << L"   Ошибка: " << string_to_wstring(e.what()) << std::endl;
+    }
+    
+    // Тест 6: Параллельная обработка по диапазонам столбцов совпадает с последовательной
+    std::wcout << L"\n ТЕСТ 6: Параллельная обработка" << std::endl;
+    try {
+        TableCipher serial(37);
+        TableCipher parallel(37);
+        parallel.setParallelism(4, 1000);
+        
+        const std::string text = sampleText(5000);
+        const std::wstring wideText = string_to_wstring(text);
+        const std::string encrypted = serial.encrypt(std::string_view(text));
+        const std::wstring wideEncrypted = serial.encrypt(wideText);
+        const bool same = parallel.encrypt(std::string_view(text)) == encrypted
+                       && parallel.decrypt(std::string_view(encrypted)) == text
+                       && parallel.encrypt(wideText) == wideEncrypted
+                       && parallel.decrypt(wideEncrypted) == wideText;
+        
+        // Две ошибки в разных частях текста: сообщается первая
+        // (вставка перед пробелом не разрезает символы UTF-8)
+        const std::size_t firstInvalid = text.find(' ', text.size() / 2);
+        std::string invalid = text;
+        invalid.insert(text.find(' ', text.size() - 200), "!");
+        invalid.insert(firstInvalid, "5");
+        const CipherResult<std::string> serialError = serial.tryEncrypt(std::string_view(invalid));
+        const CipherResult<std::string> parallelError = parallel.tryEncrypt(std::string_view(invalid));
+        const bool sameError = !serialError && !parallelError
+                            && serialError.error().offset == firstInvalid
+                            && parallelError.error().offset == firstInvalid;
+        
+        std::wcout << L"   Длина текста: " << wideText.size() << L" символов, ключ = 37, потоков: 4" << std::endl;
+        if (same && sameError) {
+            std::wcout << L"   Результат и позиция ошибки совпадают с последовательной обработкой!" << std::endl;
+        } else {
+            std::wcout << L"   Ошибка: параллельная обработка расходится с последовательной!" << std::endl;
+        }
+    } catch (const table_cipher_error& e) {
+        std::wcout << L"   Ошибка: " << string_to_wstring(e.what()) << std::endl;
+    }
+    
+    // Тест 7: Файл обрабатывается полосами строк, результат совпадает с шифрованием в памяти
+    std::wcout << L"\n ТЕСТ 7: Шифрование файла по частям" << std::endl;
+    char inputPath[] = "/tmp/tableCipherXXXXXX";
+    const int fd = mkstemp(inputPath);
+    if (fd < 0) {
+        std::wcout << L"   Ошибка: не удалось создать временный файл" << std::endl;
+        return;
+    }
+    close(fd);
+    const std::string encryptedPath = std::string(inputPath) + ".enc";
+    const std::string decryptedPath = std::string(inputPath) + ".dec";
+    try {
+        // Около 2 МБ текста при бюджете 1 МБ - несколько полос
+        const std::string text = sampleText(150000);
+        std::ofstream(inputPath, std::ios::binary) << text;
+        
+        TableCipher cipher(400);
+        const std::string expected = cipher.encrypt(std::string_view(text));
+        const CipherResult<std::size_t> encrypted = routeFile(400, inputPath, encryptedPath, true, minTableFileBudget);
+        const CipherResult<std::size_t> decrypted = routeFile(400, encryptedPath, decryptedPath, false, minTableFileBudget);
+        
+        std::wcout << L"   Размер файла: " << text.size() << L" байт, ключ = 400" << std::endl;
+        if (encrypted && decrypted && readFile(encryptedPath) == expected && readFile(decryptedPath) == text) {
+            std::wcout << L"   Результат совпадает с шифрованием в памяти, расшифровка корректна!" << std::endl;
+        } else {
+            std::wcout << L"   Ошибка: результат шифрования файла не совпадает с шифрованием в памяти!" << std::endl;
+        }
+    } catch (const table_cipher_error& e) {
+        std::wcout << L"   Ошибка: " << string_to_wstring(e.what()) << std::endl;
+    }
+    unlink(inputPath);
+    unlink(encryptedPath.c_str());
+    unlink(decryptedPath.c_str());
+}
+
+/**
+ * @brief Демонстрация маршрутов записи и чтения таблицы
+ * @details Таблица 4 × 3 с неполной последней строкой проверяет пропуск
+ * несуществующих ячеек: для каждого маршрута чтения шифротекст известен заранее.
+ * Затем каждая пара маршрутов записи и чтения (в том числе отраженных)
+ * проверяется расшифрованием зашифрованного текста последовательно (планы из кэша)
+ * и в нескольких потоках, для широких строк и UTF-8 с символами разной длины
+ */
+void demonstrateRoutes() {
+    std::wcout << L"\n ТЕСТ 8: Маршруты чтения таблицы" << std::endl;
+    try {
+        // Таблица:
+        //   А Б В Г
+        //   Д Е Ж З
+        //   И К
+        const std::wstring original = L"АБВГДЕЖЗИК";
+        struct Expected {
+            const wchar_t* name; ///< Название маршрута
+            TableRoute read; ///< Маршрут чтения
+            const wchar_t* text; ///< Ожидаемый шифротекст
+        };
+        const Expected cases[] = {
+            {L"по умолчанию", TableRoute{RouteShape::columns, true, {}}, L"ГЗВЖБЕКАДИ"},
+            {L"спираль", TableRoute{RouteShape::spiral, false, {}}, L"АБВГЗКИДЕЖ"},
+            {L"отраженная спираль", TableRoute{RouteShape::spiral, true, {}}, L"ГВБАДИКЗЖЕ"},
+            {L"диагонали", TableRoute{RouteShape::diagonal, false, {}}, L"АБДВЕИГЖКЗ"},
+            {L"змейка по строкам", TableRoute{RouteShape::snakeRows, false, {}}, L"АБВГЗЖЕДИК"},
+            {L"змейка по столбцам", TableRoute{RouteShape::snakeColumns, false, {}}, L"АДИКЕБВЖЗГ"},
+            {L"ключевое слово ШИФР", TableRoute::keyword(L"ШИФР"), L"БЕКГЗВЖАДИ"}
+        };
+        std::wcout << L"   Исходный текст: " << original << L", ключ = 4" << std::endl;
+        bool allMatch = true;
+        for (const Expected& expected : cases) {
+            TableCipher cipher(4);
+            cipher.setRoutes(TableRoutes{TableRoute{}, expected.read});
+            const std::wstring encrypted = cipher.encrypt(original);
+            const bool match = encrypted == expected.text && cipher.decrypt(encrypted) == original;
+            allMatch = allMatch && match;
+            std::wcout << L"   " << expected.name << L": " << encrypted
+                       << (match ? L"" : L" (ожидалось " + std::wstring(expected.text) + L")") << std::endl;
+        }
+        
+        // Ключевое слово другой длины не подходит к таблице
+        bool rejected = false;
+        try {
+            TableCipher cipher(4);
+            cipher.setRoutes(TableRoutes{TableRoute{}, TableRoute::keyword(L"КОД")});
+        } catch (const table_cipher_error& e) {
+            rejected = e.code() == CipherErrc::invalidRoute;
+        }
+        
+        if (allMatch && rejected) {
+            std::wcout << L"   Все маршруты дают ожидаемый шифротекст, неподходящее ключевое слово отвергнуто!" << std::endl;
+        } else {
+            std::wcout << L"   Ошибка: маршрут дал неожиданный шифротекст или ключевое слово не отвергнуто!" << std::endl;
+        }
+    } catch (const table_cipher_error& e) {
+        std::wcout << L"   Ошибка: " << string_to_wstring(e.what()) << std::endl;
+    }
+    
+    std::wcout << L"\n ТЕСТ 9: Все пары маршрутов записи и чтения" << std::endl;
+    try {
+        std::vector<TableRoute> routes;
+        for (RouteShape shape : {RouteShape::rows, RouteShape::columns, RouteShape::snakeRows, RouteShape::snakeColumns,
+                                 RouteShape::spiral, RouteShape::diagonal}) {
+            routes.push_back(TableRoute{shape, false, {}});
+            routes.push_back(TableRoute{shape, true, {}});
+        }
+        routes.push_back(TableRoute::keyword(L"МАРШРУТ"));
+        TableRoute mirroredKeyword = TableRoute::keyword(L"МАРШРУТ");
+        mirroredKeyword.mirrored = true;
+        routes.push_back(mirroredKeyword);
+        
+        const std::string text = sampleText(500);
+        const std::wstring wideText = string_to_wstring(text);
+        std::size_t failures = 0;
+        for (const TableRoute& write : routes) {
+            for (const TableRoute& read : routes) {
+                TableCipher serial(7);
+                TableCipher parallel(7);
+                serial.setRoutes(TableRoutes{write, read});
+                parallel.setRoutes(TableRoutes{write, read});
+                parallel.setParallelism(4, 100);
+                const std::wstring wideEncrypted = serial.encrypt(wideText);
+                const std::string encrypted = serial.encrypt(std::string_view(text));
+                const bool passed = serial.decrypt(wideEncrypted) == wideText
+                                 && serial.decrypt(std::string_view(encrypted)) == text
+                                 && wstring_to_string(wideEncrypted) == encrypted
+                                 && parallel.encrypt(wideText) == wideEncrypted
+                                 && parallel.decrypt(wideEncrypted) == wideText
+                                 && parallel.encrypt(std::string_view(text)) == encrypted
+                                 && parallel.decrypt(std::string_view(encrypted)) == text;
+                if (!passed) {
+                    failures++;
+                }
+            }
+        }
+        
+        std::wcout << L"   Пар маршрутов: " << routes.size() * routes.size() << L", длина текста: "
+                   << wideText.size() << L" символов, ключ = 7" << std::endl;
+        if (failures == 0) {
+            std::wcout << L"   Расшифровка корректна, параллельная обработка совпадает с последовательной!" << std::endl;
+        } else {
+            std::wcout << L"   Ошибка: пар маршрутов с некорректным результатом: " << failures << std::endl;
+        }
+    } catch (const table_cipher_error& e) {
+        std::wcout << L"   Ошибка: " << string_to_wstring(e.what()) << std::endl;
+    }
+}
+
+/**
+ * @brief Демонстрация подбора ключа по шифротексту
+ * @details Модель обучается на первой половине тестового текста, шифруется начало второй половины
+ */
+void demonstrateKeySearch() {
+    std::wcout << L"\n ТЕСТ 10: Подбор ключа по шифротексту" << std::endl;
+    try {
+        const std::string corpus = sampleText(6000);
+        const std::size_t half = corpus.find(' ', corpus.size() / 2);
+        // Ключ 1 дает таблицу из одного столбца, поэтому текст короче 10000 символов
+        const std::string text = corpus.substr(half + 1, corpus.find(' ', half + 9000) - half - 1);
+        TableKeySearch serial(BigramModel::train(std::string_view(corpus).substr(0, half)));
+        TableKeySearch parallel = serial;
+        parallel.setParallelism(4);
+        
+        bool found = true;
+        for (int key : {1, 7, 113, 999}) {
+            const std::string encrypted = TableCipher(key).encrypt(std::string_view(text));
+            const std::wstring wideEncrypted = string_to_wstring(encrypted);
+            const int serialKey = serial.search(std::string_view(encrypted)).front().key;
+            const int parallelKey = parallel.search(std::string_view(encrypted)).front().key;
+            const int wideKey = parallel.search(wideEncrypted).front().key;
+            std::wcout << L"   Ключ " << key << L": найден " << serialKey << L" (параллельно: "
+                       << parallelKey << L", широкая строка: " << wideKey << L")" << std::endl;
+            found = found && serialKey == key && parallelKey == key && wideKey == key;
+        }
+        
+        if (found) {
+            std::wcout << L"   Все ключи найдены, параллельный подбор совпадает с последовательным!" << std::endl;
+        } else {
+            std::wcout << L"   Ошибка: лучший кандидат не совпадает с ключом шифрования!" << std::endl;
+        }
+    } catch (const table_cipher_error& e) {
+        std::wcout << L"   Ошибка: " << string_to_wstring(e.what()) << std::endl;
+    }
+}
+
+/**
+ * @brief Демонстрация кэша планов перестановки
+ * @details Сообщения трех длин повторяются; для каждой длины план строится один раз,
+ * остальные обращения обслуживаются кэшем. Результат сравнивается с шифром без кэша
+ */
+void demonstratePlanCache() {
+    std::wcout << L"\n ТЕСТ 11: Кэш планов перестановки" << std::endl;
+    try {
+        const std::wstring text = string_to_wstring(sampleText(200));
+        const std::size_t lengths[] = {40, 41, 97};
+        bool passed = true;
+        for (const TableRoutes& routes : {TableRoutes{}, TableRoutes{TableRoute{}, TableRoute{RouteShape::spiral, false, {}}}}) {
+            TableCipher cached(5);
+            TableCipher uncached(5);
+            cached.setRoutes(routes);
+            uncached.setRoutes(routes);
+            cached.setPlanCache(4);
+            uncached.setPlanCache(0);
+            
+            // Каждая длина: 5 сообщений, шифрование и расшифрование - 10 обращений, из них 1 промах
+            for (std::size_t repeat = 0; repeat < 5; repeat++) {
+                for (std::size_t length : lengths) {
+                    const std::wstring message = text.substr(repeat * 100, length);
+                    const std::wstring encrypted = cached.encrypt(message);
+                    passed = passed && encrypted == uncached.encrypt(message)
+                                    && cached.decrypt(encrypted) == message;
+                }
+            }
+            const TablePlanStats stats = cached.planStats();
+            std::wcout << L"   Попаданий: " << stats.hits << L", промахов: " << stats.misses
+                       << L", планов: " << stats.plans << L" из " << stats.capacity << std::endl;
+            passed = passed && stats.hits == 27 && stats.misses == 3 && stats.plans == 3 && stats.capacity == 4
+                            && uncached.planStats().plans == 0;
+            
+            // Три длины по кругу в кэше на два плана: каждый план вытесняется до повторного обращения
+            cached.setPlanCache(2);
+            for (std::size_t repeat = 0; repeat < 3; repeat++) {
+                for (std::size_t length : lengths) {
+                    const std::wstring message = text.substr(0, length);
+                    passed = passed && cached.encrypt(message) == uncached.encrypt(message);
+                }
+            }
+            const TablePlanStats evicted = cached.planStats();
+            passed = passed && evicted.hits == 0 && evicted.misses == 9 && evicted.plans == 2;
+        }
+        
+        if (passed) {
+            std::wcout << L"   Статистика кэша верна, результат совпадает с шифром без кэша!" << std::endl;
+        } else {
+            std::wcout << L"   Ошибка: кэш планов работает некорректно!" << std::endl;
+        }
+    } catch (const table_cipher_error& e) {
+        std::wcout << L"   Ошибка: " << string_to_wstring(e.what()) << std::endl;
+    }
+}
+
+/**
+ * @brief Сравнение пакетной обработки с обработкой по одному сообщению
+ * @tparam Char wchar_t или char (UTF-8)
+ * @param cipher Шифр
+ * @param messages Сообщения пакета
+ * @param encrypting true - шифрование, false - дешифрование
+ * @return Количество сообщений, результат, границы или ошибка которых расходятся с tryEncrypt()/tryDecrypt()
+ */
+template <class Char>
+std::size_t batchMismatches(const TableCipher& cipher, const std::vector<std::basic_string<Char>>& messages, bool encrypting) {
+    std::basic_string<Char> arena;
+    std::vector<std::size_t> offsets{0};
+    for (const std::basic_string<Char>& message : messages) {
+        arena += message;
+        offsets.push_back(arena.size());
+    }
+    const std::basic_string_view<Char> view(arena);
+    const BatchResult<Char> batch = encrypting ? cipher.encryptBatch(view, offsets) : cipher.decryptBatch(view, offsets);
+    if (batch.size() != messages.size() || batch.offsets.size() != messages.size() + 1
+        || batch.offsets.back() != batch.data.size()) {
+        return messages.size();
+    }
+    std::size_t mismatches = 0;
+    std::size_t failed = 0;
+    for (std::size_t i = 0; i < messages.size(); i++) {
+        const CipherResult<std::basic_string<Char>> single = encrypting ? cipher.tryEncrypt(messages[i])
+                                                                        : cipher.tryDecrypt(messages[i]);
+        bool same;
+        if (single) {
+            same = batch.ok(i) && batch.message(i) == *single;
+        } else {
+            failed++;
+            same = !batch.ok(i) && batch.errors[i].code == single.error().code
+                && batch.errors[i].offset == single.error().offset && batch.message(i).empty();
+        }
+        if (!same) {
+            mismatches++;
+        }
+    }
+    return (batch.failed == failed) ? mismatches : mismatches + 1;
+}
+
+/**
+ * @brief Демонстрация пакетной обработки
+ * @details Пакет содержит корректные сообщения, сообщения с недопустимыми символами,
+ * пустое сообщение и сообщения короче ключа; каждый результат сравнивается
+ * с обработкой сообщения по отдельности
+ */
+void demonstrateBatch() {
+    std::wcout << L"\n ТЕСТ 12: Пакетная обработка" << std::endl;
+    try {
+        TableCipher cipher(5);
+        const std::vector<std::string> messages = {
+            "ПРИВЕТ МИР",
+            "ПРИВЕТ 5 МИР",
+            "",
+            "ПРИ",
+            "Ёж и hello",
+            sampleText(50),
+            "КЛЮЧ!",
+            "ТАБЛИЦА"
+        };
+        std::vector<std::wstring> wideMessages;
+        for (const std::string& message : messages) {
+            wideMessages.push_back(string_to_wstring(message));
+        }
+        
+        std::size_t mismatches = 0;
+        for (bool encrypting : {true, false}) {
+            mismatches += batchMismatches(cipher, messages, encrypting);
+            mismatches += batchMismatches(cipher, wideMessages, encrypting);
+        }
+        const BatchResult<char> batch = cipher.encryptBatch(std::string_view(messages[0] + messages[3]),
+                                                            {0, messages[0].size(), messages[0].size() + messages[3].size()});
+        
+        bool rejected = false;
+        try {
+            cipher.encryptBatch(std::string_view("ПРИВЕТ"), {0, 4, 2});
+        } catch (const table_cipher_error& e) {
+            rejected = e.error().code == CipherErrc::invalidBatchOffsets;
+        }
+        
+        std::wcout << L"   Сообщений в пакете: " << messages.size() << L", ключ = 5" << std::endl;
+        std::wcout << L"   Сообщение короче ключа: " << string_to_wstring(TableCipher::errorMessage(batch.errors[1].code, true))
+                   << std::endl;
+        if (mismatches == 0 && batch.ok(0) && !batch.ok(1) && rejected) {
+            std::wcout << L"   Результаты и ошибки совпадают с обработкой по одному сообщению!" << std::endl;
+        } else {
+            std::wcout << L"   Ошибка: пакетная обработка расходится с обработкой по одному сообщению!" << std::endl;
+        }
+    } catch (const table_cipher_error& e) {
+        std::wcout << L"   Ошибка: " << string_to_wstring(e.what()) << std::endl;
     }
 }
 
@@ -255,14 +699,251 @@ void showHelp() {
     
     demonstrateInputErrors();
     demonstrateCipher();
+    demonstrateRoutes();
+    demonstrateKeySearch();
+    demonstratePlanCache();
+    demonstrateBatch();
+}
+
+/// Объем одного чтения входного потока в пакетном режиме, байт
+constexpr std::size_t batchReadSize = std::size_t(1) << 20;
+
+/// Количество ошибочных записей, о которых пакетный режим сообщает построчно
+constexpr std::size_t maxReportedErrors = 10;
+
+/**
+ * @brief Параметры пакетного режима
+ */
+struct BatchOptions {
+    int key = 0; ///< Количество столбцов таблицы
+    bool keySet = false; ///< Ключ задан
+    bool encrypting = true; ///< true - шифрование, false - расшифрование
+    bool operationSet = false; ///< Операция задана
+    std::string input; ///< Входной файл (пусто - стандартный ввод)
+};
+
+/**
+ * @brief Статистика пакетного режима
+ */
+struct BatchStats {
+    std::size_t records = 0; ///< Обработано непустых записей
+    std::size_t failed = 0; ///< Записей с ошибками
+    std::size_t empty = 0; ///< Пустых строк (переносятся в результат без шифрования)
+    std::size_t bytesIn = 0; ///< Прочитано байт
+    std::size_t bytesOut = 0; ///< Записано байт
+};
+
+/**
+ * @brief Вывод справки по параметрам пакетного режима
+ * @param program Имя программы
+ */
+void printBatchUsage(const char* program) {
+    std::cerr << "Использование: " << program << " --key N --encrypt|--decrypt [--input FILE]\n"
+              << "  Без параметров программа запускается в интерактивном режиме.\n"
+              << "  --key N       количество столбцов таблицы (1 .. 1000)\n"
+              << "  --encrypt     зашифровать каждую строку входа\n"
+              << "  --decrypt     расшифровать каждую строку входа\n"
+              << "  --input FILE  читать строки из файла (по умолчанию - стандартный ввод)\n"
+              << "  Результаты пишутся в стандартный вывод по строке на запись (при ошибке - пустая строка),\n"
+              << "  ошибки и итоговая статистика - в стандартный поток ошибок.\n";
+}
+
+/**
+ * @brief Разбор параметров пакетного режима
+ * @param argc Количество аргументов
+ * @param argv Аргументы командной строки
+ * @param options Параметры пакетного режима
+ * @return true, если заданы ключ и ровно одна операция
+ */
+bool parseBatchOptions(int argc, char** argv, BatchOptions& options) {
+    for (int i = 1; i < argc; i++) {
+        const std::string arg = argv[i];
+        if (arg == "--encrypt" || arg == "--decrypt") {
+            if (options.operationSet) {
+                return false;
+            }
+            options.encrypting = (arg == "--encrypt");
+            options.operationSet = true;
+        } else if ((arg == "--key" || arg == "--input") && i + 1 < argc) {
+            const std::string value = argv[++i];
+            if (arg == "--input") {
+                options.input = value;
+                continue;
+            }
+            try {
+                std::size_t end = 0;
+                options.key = std::stoi(value, &end);
+                options.keySet = (end == value.size());
+            } catch (const std::exception&) {
+                return false;
+            }
+        } else {
+            return false;
+        }
+    }
+    return options.keySet && options.operationSet;
+}
+
+/**
+ * @brief Обработка полных строк входа
+ * @details Непустые строки без завершающих '\r' складываются подряд и
+ * шифруются одним вызовом encryptBatch()/decryptBatch() без перевода в широкие
+ * строки; результаты всех строк собираются в один буфер и записываются одним fwrite()
+ * @param cipher Шифр
+ * @param lines Строки, каждая завершена '\n' (кроме, возможно, последней)
+ * @param encrypting true - шифрование, false - расшифрование
+ * @param firstLine Номер первой строки во входе (для сообщений об ошибках)
+ * @param stats Статистика
+ * @param out Поток результата
+ */
+void processBatchLines(const TableCipher& cipher, std::string_view lines, bool encrypting,
+                       std::size_t firstLine, BatchStats& stats, std::FILE* out) {
+    std::string arena;
+    std::vector<std::size_t> offsets{0};
+    std::vector<long> slots; // Номер записи в пакете или -1 для пустой строки
+    arena.reserve(lines.size());
+    std::size_t start = 0;
+    while (start < lines.size()) {
+        std::size_t end = lines.find('\n', start);
+        const std::size_t next = (end == std::string_view::npos) ? lines.size() : end + 1;
+        end = (end == std::string_view::npos) ? lines.size() : end;
+        if (end > start && lines[end - 1] == '\r') {
+            end--;
+        }
+        if (end == start) {
+            slots.push_back(-1);
+        } else {
+            slots.push_back(static_cast<long>(offsets.size() - 1));
+            arena.append(lines.data() + start, end - start);
+            offsets.push_back(arena.size());
+        }
+        start = next;
+    }
+
+    BatchResult<char> result;
+    if (offsets.size() > 1) {
+        result = encrypting ? cipher.encryptBatch(arena, offsets) : cipher.decryptBatch(arena, offsets);
+    }
+
+    std::string output;
+    output.reserve(result.data.size() + slots.size());
+    for (std::size_t i = 0; i < slots.size(); i++) {
+        if (slots[i] < 0) {
+            stats.empty++;
+        } else {
+            const std::size_t record = static_cast<std::size_t>(slots[i]);
+            stats.records++;
+            if (result.ok(record)) {
+                output.append(result.message(record));
+            } else {
+                if (stats.failed < maxReportedErrors) {
+                    std::cerr << "Строка " << firstLine + i << ": "
+                              << TableCipher::errorMessage(result.errors[record].code, encrypting)
+                              << " (позиция " << result.errors[record].offset << ")\n";
+                }
+                stats.failed++;
+            }
+        }
+        output.push_back('\n');
+    }
+    std::fwrite(output.data(), 1, output.size(), out);
+    stats.bytesOut += output.size();
+}
+
+/**
+ * @brief Пакетный режим: шифрование входа построчно
+ * @details Вход читается блоками по batchReadSize байт; полные строки блока
+ * обрабатываются одним пакетом, незавершенная строка переносится в следующий блок
+ * @param options Параметры пакетного режима
+ * @return 0 - все записи обработаны, 1 - были ошибки в записях или при вводе-выводе,
+ * 2 - некорректный ключ
+ */
+int runBatchMode(const BatchOptions& options) {
+    CipherResult<TableCipher> cipher = TableCipher::create(options.key);
+    if (!cipher) {
+        std::cerr << TableCipher::errorMessage(cipher.error().code, options.encrypting) << "\n";
+        return 2;
+    }
+    std::FILE* in = stdin;
+    if (!options.input.empty()) {
+        in = std::fopen(options.input.c_str(), "rb");
+        if (!in) {
+            std::cerr << "Не удалось открыть файл " << options.input << ": " << std::strerror(errno) << "\n";
+            return 1;
+        }
+    }
+
+    const auto started = std::chrono::steady_clock::now();
+    BatchStats stats;
+    std::string buffer;
+    std::size_t line = 1;
+    bool finished = false;
+    while (!finished) {
+        const std::size_t kept = buffer.size();
+        buffer.resize(kept + batchReadSize);
+        const std::size_t received = std::fread(&buffer[kept], 1, batchReadSize, in);
+        buffer.resize(kept + received);
+        stats.bytesIn += received;
+        finished = (received < batchReadSize);
+
+        // В конце входа обрабатывается и строка без завершающего '\n'
+        const std::size_t last = buffer.rfind('\n');
+        const std::size_t complete = finished ? buffer.size() : (last == std::string::npos ? 0 : last + 1);
+        if (complete > 0) {
+            const std::string_view lines(buffer.data(), complete);
+            processBatchLines(*cipher, lines, options.encrypting, line, stats, stdout);
+            line += static_cast<std::size_t>(std::count(lines.begin(), lines.end(), '\n'));
+            buffer.erase(0, complete);
+        }
+    }
+
+    const bool readFailed = std::ferror(in) != 0;
+    if (in != stdin) {
+        std::fclose(in);
+    }
+    const bool writeFailed = std::fflush(stdout) != 0 || std::ferror(stdout) != 0;
+    const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - started).count();
+    std::cerr << "Записей: " << stats.records << ", с ошибками: " << stats.failed
+              << ", пустых строк: " << stats.empty << ", прочитано байт: " << stats.bytesIn
+              << ", записано байт: " << stats.bytesOut << ", время: " << seconds << " с, "
+              << (seconds > 0 ? stats.bytesIn / seconds / 1e6 : 0.0) << " МБ/с\n";
+    if (readFailed || writeFailed) {
+        std::cerr << (readFailed ? "Ошибка чтения входа" : "Ошибка записи результата") << "\n";
+        return 1;
+    }
+    return stats.failed > 0 ? 1 : 0;
 }
 
 /**
  * @brief Главная функция программы
+ * @param argc Количество аргументов
+ * @param argv Аргументы командной строки
  * @return Код завершения программы
- * @details Реализует основной цикл программы с меню и обработкой пользовательского ввода
+ * @details Без аргументов реализует основной цикл программы с меню и обработкой
+ * пользовательского ввода; с аргументами --key N --encrypt|--decrypt работает
+ * в пакетном режиме (см. runBatchMode())
  */
-int main() {
+int main(int argc, char** argv) {
+    if (argc > 1) {
+        // Классы символов нужны шифру; на машинах без русской локали годится любая локаль UTF-8
+        try {
+            std::locale::global(std::locale("ru_RU.UTF-8"));
+        } catch (const std::runtime_error&) {
+            try {
+                std::locale::global(std::locale("C.UTF-8"));
+            } catch (const std::runtime_error&) {
+                std::cerr << "Ошибка: не найдена локаль ru_RU.UTF-8 или C.UTF-8\n";
+                return 1;
+            }
+        }
+        BatchOptions options;
+        if (!parseBatchOptions(argc, argv, options)) {
+            printBatchUsage(argv[0]);
+            return 2;
+        }
+        return runBatchMode(options);
+    }
+
     // Установка локали для поддержки русского языка
     std::locale::global(std::locale("ru_RU.UTF-8"));
     std::wcout.imbue(std::locale("ru_RU.UTF-8"));
@@ -0,0 +1,192 @@
+/**
+ * @file routeEngine.cpp
+ * @brief Реализация маршрутов записи и чтения таблицы перестановки
+ */
+
+#include "routeEngine.h"
+#include <algorithm>
+#include <cwctype>
+#include <numeric>
+
+namespace {
+
+/**
+ * @brief Обход прямоугольной таблицы по маршруту
+ * @param route Маршрут
+ * @param rows Количество строк таблицы
+ * @param columns Количество столбцов таблицы
+ * @param visit Вызывается для каждой ячейки (row, col) таблицы rows × columns в порядке маршрута
+ */
+template <class Visit>
+void walkTable(const TableRoute& route, std::size_t rows, std::size_t columns, Visit&& visit) {
+    switch (route.shape) {
+        case RouteShape::rows:
+            for (std::size_t row = 0; row < rows; row++) {
+                for (std::size_t col = 0; col < columns; col++) {
+                    visit(row, col);
+                }
+            }
+            break;
+        case RouteShape::columns:
+            for (std::size_t col = 0; col < columns; col++) {
+                for (std::size_t row = 0; row < rows; row++) {
+                    visit(row, col);
+                }
+            }
+            break;
+        case RouteShape::snakeRows:
+            for (std::size_t row = 0; row < rows; row++) {
+                for (std::size_t i = 0; i < columns; i++) {
+                    visit(row, (row % 2 == 0) ? i : columns - 1 - i);
+                }
+            }
+            break;
+        case RouteShape::snakeColumns:
+            for (std::size_t col = 0; col < columns; col++) {
+                for (std::size_t i = 0; i < rows; i++) {
+                    visit((col % 2 == 0) ? i : rows - 1 - i, col);
+                }
+            }
+            break;
+        case RouteShape::spiral: {
+            // Границы еще не обойденной части таблицы: [top, bottom) × [left, right)
+            std::size_t top = 0, bottom = rows, left = 0, right = columns;
+            while (top < bottom && left < right) {
+                for (std::size_t col = left; col < right; col++) {
+                    visit(top, col);
+                }
+                for (std::size_t row = top + 1; row < bottom; row++) {
+                    visit(row, right - 1);
+                }
+                if (top + 1 < bottom && left + 1 < right) {
+                    for (std::size_t col = right - 1; col-- > left;) {
+                        visit(bottom - 1, col);
+                    }
+                    for (std::size_t row = bottom - 1; row-- > top + 1;) {
+                        visit(row, left);
+                    }
+                }
+                top++;
+                bottom--;
+                left++;
+                right--;
+            }
+            break;
+        }
+        case RouteShape::diagonal:
+            for (std::size_t sum = 0; sum + 1 < rows + columns; sum++) {
+                const std::size_t first = (sum + 1 > columns) ? sum + 1 - columns : 0;
+                for (std::size_t row = first; row <= std::min(sum, rows - 1); row++) {
+                    visit(row, sum - row);
+                }
+            }
+            break;
+        case RouteShape::keyColumns:
+            for (int col : route.columnOrder) {
+                for (std::size_t row = 0; row < rows; row++) {
+                    visit(row, static_cast<std::size_t>(col));
+                }
+            }
+            break;
+    }
+}
+
+} // namespace
+
+/**
+ * @brief Маршрут по столбцам в порядке букв ключевого слова
+ * @param word Ключевое слово
+ * @return Маршрут RouteShape::keyColumns
+ */
+TableRoute TableRoute::keyword(std::wstring_view word) {
+    TableRoute route;
+    route.shape = RouteShape::keyColumns;
+    route.columnOrder.resize(word.size());
+    std::iota(route.columnOrder.begin(), route.columnOrder.end(), 0);
+    std::stable_sort(route.columnOrder.begin(), route.columnOrder.end(), [&](int a, int b) {
+        return std::towlower(word[a]) < std::towlower(word[b]);
+    });
+    return route;
+}
+
+/**
+ * @brief Признак маршрутов по умолчанию
+ * @return true, если запись идет по строкам, а чтение - по столбцам справа налево
+ */
+bool TableRoutes::isDefault() const {
+    return write == TableRoute{} && read == TableRoute{RouteShape::columns, true, {}};
+}
+
+/**
+ * @brief Проверка маршрутов для таблицы
+ * @param routes Маршруты записи и чтения
+ * @param numColumns Количество столбцов таблицы
+ * @return Ошибка маршрута (код CipherErrc::ok, если маршруты корректны)
+ */
+CipherError checkRoutes(const TableRoutes& routes, int numColumns) {
+    for (const TableRoute* route : {&routes.write, &routes.read}) {
+        if (route->shape != RouteShape::keyColumns) {
+            continue;
+        }
+        std::vector<int> order = route->columnOrder;
+        std::sort(order.begin(), order.end());
+        for (std::size_t i = 0; i < order.size(); i++) {
+            if (order[i] != static_cast<int>(i)) {
+                return {CipherErrc::invalidRoute, 0};
+            }
+        }
+        if (order.size() != static_cast<std::size_t>(numColumns)) {
+            return {CipherErrc::invalidRoute, 0};
+        }
+    }
+    return {};
+}
+
+/**
+ * @brief Ячейки таблицы в порядке маршрута
+ * @param route Маршрут
+ * @param numColumns Количество столбцов таблицы
+ * @param length Длина текста в символах
+ * @return Номера существующих ячеек в порядке обхода
+ * @details Отражение применяется к номеру столбца после обхода, поэтому
+ * отраженный маршрут начинается от правого края таблицы
+ */
+std::vector<std::uint32_t> routeCells(const TableRoute& route, int numColumns, std::size_t length) {
+    const std::size_t columns = static_cast<std::size_t>(numColumns);
+    const std::size_t rows = (length + columns - 1) / columns;
+    std::vector<std::uint32_t> cells;
+    cells.reserve(length);
+    walkTable(route, rows, columns, [&](std::size_t row, std::size_t col) {
+        const std::size_t cell = row * columns + (route.mirrored ? columns - 1 - col : col);
+        if (cell < length) {
+            cells.push_back(static_cast<std::uint32_t>(cell));
+        }
+    });
+    return cells;
+}
+
+/**
+ * @brief Перевод пары маршрутов в массив номеров
+ * @param routes Маршруты записи и чтения
+ * @param numColumns Количество столбцов таблицы
+ * @param length Длина текста в символах
+ * @return Номер символа текста для каждой позиции шифротекста
+ * @details Маршрут записи дает номер символа текста для каждой ячейки (обратная
+ * перестановка к порядку обхода), маршрут чтения - порядок ячеек в шифротексте.
+ * Для записи по строкам номер символа совпадает с номером ячейки
+ */
+std::vector<std::uint32_t> compileRoutes(const TableRoutes& routes, int numColumns, std::size_t length) {
+    std::vector<std::uint32_t> index = routeCells(routes.read, numColumns, length);
+    if (routes.write == TableRoute{}) {
+        return index;
+    }
+    const std::vector<std::uint32_t> written = routeCells(routes.write, numColumns, length);
+    std::vector<std::uint32_t> textIndex(length);
+    for (std::size_t i = 0; i < length; i++) {
+        textIndex[written[i]] = static_cast<std::uint32_t>(i);
+    }
+    for (std::uint32_t& cell : index) {
+        cell = textIndex[cell];
+    }
+    return index;
+}
@@ -0,0 +1,106 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+#include <vector>
+#include "../common/cipherResult.h"
+
+/**
+ * @file
+ * @author Ганьшин В.А.
+ * @version 1.0
+ * @date 17.12.2025
+ * @brief Маршруты записи и чтения таблицы перестановки
+ * @details Таблица из numColumns столбцов заполняется построчно: ячейка (row, col)
+ * существует, если row * numColumns + col меньше длины текста, поэтому неполной
+ * может быть только последняя строка. Маршрут обходит всю прямоугольную таблицу
+ * и пропускает несуществующие ячейки. Пара маршрутов (запись, чтение) один раз
+ * переводится в массив номеров (см. compileRoutes()), и любая пара переставляется
+ * одним и тем же циклом TablePlan::apply().
+ */
+
+/// Наибольшая длина текста для маршрута, отличного от маршрута по умолчанию (номера ячеек хранятся в 32 битах)
+constexpr std::size_t maxRouteLength = UINT32_MAX;
+
+/**
+ * @brief Форма маршрута по таблице
+ */
+enum class RouteShape {
+    rows, ///< По строкам сверху вниз, каждая строка слева направо
+    columns, ///< По столбцам слева направо, каждый столбец сверху вниз
+    snakeRows, ///< По строкам сверху вниз, направление строки чередуется (первая - слева направо)
+    snakeColumns, ///< По столбцам слева направо, направление столбца чередуется (первый - сверху вниз)
+    spiral, ///< По спирали по часовой стрелке от левого верхнего угла к центру
+    diagonal, ///< По диагоналям от левого верхнего угла, каждая диагональ сверху вниз
+    keyColumns ///< По столбцам в порядке columnOrder, каждый столбец сверху вниз
+};
+
+/**
+ * @brief Маршрут по таблице
+ */
+struct TableRoute {
+    RouteShape shape = RouteShape::rows; ///< Форма маршрута
+    bool mirrored = false; ///< Таблица отражена слева направо: столбец col обходится как numColumns - 1 - col
+    std::vector<int> columnOrder; ///< Порядок столбцов для RouteShape::keyColumns (перестановка 0 .. numColumns - 1)
+
+    /**
+     * @brief Маршрут по столбцам в порядке букв ключевого слова
+     * @details Столбцы читаются в алфавитном порядке букв слова (по кодам символов
+     * без учета регистра); столбцы с одинаковыми буквами - слева направо
+     * @param word Ключевое слово, его длина равна количеству столбцов таблицы
+     * @return Маршрут RouteShape::keyColumns
+     */
+    static TableRoute keyword(std::wstring_view word);
+
+    /**
+     * @brief Сравнение маршрутов
+     * @param other Другой маршрут
+     * @return true, если маршруты совпадают
+     */
+    bool operator==(const TableRoute& other) const {
+        return shape == other.shape && mirrored == other.mirrored && columnOrder == other.columnOrder;
+    }
+};
+
+/**
+ * @brief Пара маршрутов шифрования
+ * @details По умолчанию - классическая перестановка TableCipher: запись по строкам
+ * слева направо, чтение по столбцам сверху вниз, справа налево
+ */
+struct TableRoutes {
+    TableRoute write; ///< Маршрут записи текста в таблицу
+    TableRoute read{RouteShape::columns, true, {}}; ///< Маршрут чтения шифротекста из таблицы
+
+    /**
+     * @brief Признак маршрутов по умолчанию
+     * @return true, если перестановку можно выполнить ядрами столбцового маршрута
+     */
+    bool isDefault() const;
+};
+
+/**
+ * @brief Проверка маршрутов для таблицы
+ * @param routes Маршруты записи и чтения
+ * @param numColumns Количество столбцов таблицы
+ * @return CipherErrc::invalidRoute, если порядок столбцов RouteShape::keyColumns
+ * не является перестановкой 0 .. numColumns - 1
+ */
+CipherError checkRoutes(const TableRoutes& routes, int numColumns);
+
+/**
+ * @brief Ячейки таблицы в порядке маршрута
+ * @param route Маршрут (проверенный checkRoutes())
+ * @param numColumns Количество столбцов таблицы
+ * @param length Длина текста в символах (не больше maxRouteLength)
+ * @return Номера row * numColumns + col существующих ячеек в порядке обхода
+ */
+std::vector<std::uint32_t> routeCells(const TableRoute& route, int numColumns, std::size_t length);
+
+/**
+ * @brief Перевод пары маршрутов в массив номеров
+ * @param routes Маршруты записи и чтения (проверенные checkRoutes())
+ * @param numColumns Количество столбцов таблицы
+ * @param length Длина текста в символах (не больше maxRouteLength)
+ * @return Номер символа текста для каждой позиции шифротекста (как TablePlan::indices())
+ */
+std::vector<std::uint32_t> compileRoutes(const TableRoutes& routes, int numColumns, std::size_t length);
@@ -0,0 +1,332 @@
+/**
+ * @file routeKernel.cpp
+ * @brief Реализация блочного ядра столбцовых маршрутов перестановки
+ */
+
+#include "routeKernel.h"
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <cstring>
+#include <utility>
+
+namespace {
+
+/**
+ * @brief Перестановка ячеек фиксированной длины
+ * @tparam Bytes Длина ячейки в байтах
+ * @tparam ToRoute true - из таблицы в порядок маршрута, false - обратно
+ * @param in Исходные ячейки
+ * @param out Буфер результата
+ * @param route Маршрут
+ * @param rowBegin Первая обрабатываемая строка таблицы
+ * @param rowEnd Строка таблицы за последней обрабатываемой
+ * @details Внутри блока столбцы перебираются во внешнем цикле: отрезок столбца
+ * в порядке маршрута непрерывен, а строки блока после первого столбца уже в кэше
+ */
+template <std::size_t Bytes, bool ToRoute>
+void transposeCells(const unsigned char* in, unsigned char* out, const ColumnRoute& route,
+                    std::size_t rowBegin, std::size_t rowEnd) {
+    const std::size_t rowStride = route.columns * Bytes;
+    const std::size_t inStride = ToRoute ? rowStride : Bytes;
+    const std::size_t outStride = ToRoute ? Bytes : rowStride;
+    for (std::size_t row0 = rowBegin; row0 < rowEnd; row0 += routeTile) {
+        const std::size_t row1 = std::min(row0 + routeTile, rowEnd);
+        for (std::size_t col0 = 0; col0 < route.columns; col0 += routeTile) {
+            const std::size_t col1 = std::min(col0 + routeTile, route.columns);
+            for (std::size_t col = col0; col < col1; col++) {
+                const std::size_t colRowEnd = std::min(row1, route.height(col));
+                const std::size_t routeCell = (route.start(col) + row0) * Bytes;
+                const std::size_t tableCell = row0 * rowStride + col * Bytes;
+                const unsigned char* from = in + (ToRoute ? tableCell : routeCell);
+                unsigned char* to = out + (ToRoute ? routeCell : tableCell);
+                for (std::size_t row = row0; row < colRowEnd; row++) {
+                    std::memcpy(to, from, Bytes);
+                    from += inStride;
+                    to += outStride;
+                }
+            }
+        }
+    }
+}
+
+/**
+ * @brief Перестановка ячеек фиксированной длины в заданном направлении
+ * @tparam Bytes Длина ячейки в байтах
+ * @param in Исходные ячейки
+ * @param out Буфер результата
+ * @param route Маршрут
+ * @param toRoute true - из таблицы в порядок маршрута, false - обратно
+ * @param rowBegin Первая обрабатываемая строка таблицы
+ * @param rowEnd Строка таблицы за последней обрабатываемой
+ */
+template <std::size_t Bytes>
+void transposeCells(const unsigned char* in, unsigned char* out, const ColumnRoute& route, bool toRoute,
+                    std::size_t rowBegin, std::size_t rowEnd) {
+    if (toRoute) {
+        transposeCells<Bytes, true>(in, out, route, rowBegin, rowEnd);
+    } else {
+        transposeCells<Bytes, false>(in, out, route, rowBegin, rowEnd);
+    }
+}
+
+/**
+ * @brief Ядро перестановки для таблицы с известным при компиляции количеством столбцов
+ * @tparam N Количество столбцов таблицы
+ * @tparam Bytes Длина ячейки в байтах
+ * @details Строка таблицы переставляется развернутой последовательностью из N копирований
+ * фиксированной длины без цикла по столбцам и без проверки длины строки на каждой ячейке:
+ * неполная последняя строка обрабатывается отдельно. Начала столбцов в порядке маршрута
+ * вычисляются один раз на вызов. Для малого N вся таблица, прочитанная по строкам,
+ * укладывается в кэш, и блочный обход не нужен
+ */
+template <std::size_t N, std::size_t Bytes>
+struct TableKernel {
+    /// Количество строк в отрезке столбца длиной в строку кэша
+    static constexpr std::size_t blockRows = 64 / Bytes;
+
+    /// Наименьшая ожидаемая ассоциативность кэша данных первого уровня
+    static constexpr std::size_t cacheWays = 8;
+
+    /**
+     * @brief Перестановка блока полных строк из таблицы в порядок маршрута
+     * @param block Начало первой строки блока в таблице
+     * @param columns Начала столбцов в порядке маршрута
+     * @param offset Смещение первой строки блока внутри столбца в байтах
+     * @details Каждый столбец получает отрезок длиной в строку кэша, поэтому запись
+     * не зависит от того, попадают ли начала столбцов в одни наборы кэша
+     */
+    template <std::size_t... C>
+    static void toRouteBlock(const unsigned char* block, unsigned char* const* columns, std::size_t offset,
+                             std::index_sequence<C...>) {
+        (toRouteColumn<C>(block, columns[C] + offset), ...);
+    }
+
+    /**
+     * @brief Перестановка отрезка одного столбца блока в порядок маршрута
+     * @tparam Col Номер столбца
+     * @param block Начало первой строки блока в таблице
+     * @param to Начало отрезка столбца в результате
+     */
+    template <std::size_t Col>
+    static void toRouteColumn(const unsigned char* block, unsigned char* to) {
+        for (std::size_t row = 0; row < blockRows; row++) {
+            std::memcpy(to + row * Bytes, block + (row * N + Col) * Bytes, Bytes);
+        }
+    }
+
+    /**
+     * @brief Перестановка одной полной строки из таблицы в порядок маршрута
+     * @param row Начало строки в таблице
+     * @param columns Начала столбцов в порядке маршрута
+     * @param offset Смещение строки внутри столбца в байтах
+     */
+    template <std::size_t... C>
+    static void toRouteRow(const unsigned char* row, unsigned char* const* columns, std::size_t offset,
+                           std::index_sequence<C...>) {
+        (std::memcpy(columns[C] + offset, row + C * Bytes, Bytes), ...);
+    }
+
+    /**
+     * @brief Перестановка одной полной строки из порядка маршрута в таблицу
+     * @param row Начало строки в таблице
+     * @param columns Начала столбцов в порядке маршрута
+     * @param offset Смещение строки внутри столбца в байтах
+     */
+    template <std::size_t... C>
+    static void fromRouteRow(unsigned char* row, const unsigned char* const* columns, std::size_t offset,
+                             std::index_sequence<C...>) {
+        (std::memcpy(row + C * Bytes, columns[C] + offset, Bytes), ...);
+    }
+
+    /**
+     * @brief Проверка совпадения наборов кэша у начал столбцов
+     * @param columns Начала столбцов в результате
+     * @return true, если в один набор кэша первого уровня попадает больше
+     * cacheWays столбцов: тогда запись по строке вытесняет строки кэша других
+     * столбцов (например, при расстоянии между столбцами, кратном 4 КБ)
+     */
+    static bool setConflict(unsigned char* const* columns) {
+        std::size_t sets[N];
+        for (std::size_t col = 0; col < N; col++) {
+            sets[col] = (reinterpret_cast<std::uintptr_t>(columns[col]) / 64) % 64;
+        }
+        for (std::size_t col = 0; col < N; col++) {
+            if (static_cast<std::size_t>(std::count(sets, sets + N, sets[col])) > cacheWays) {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    /**
+     * @brief Количество полных строк таблицы
+     * @param route Маршрут
+     * @return Количество строк без неполной последней строки
+     */
+    static std::size_t fullRows(const ColumnRoute& route) {
+        return (route.lastRowLength == N) ? route.rows : route.rows - 1;
+    }
+
+    /**
+     * @brief Перестановка полосы строк из таблицы в порядок маршрута
+     * @param in Ячейки таблицы по строкам
+     * @param out Буфер результата в порядке маршрута
+     * @param route Маршрут (route.columns == N)
+     * @param rowBegin Первая строка полосы
+     * @param rowEnd Строка за последней строкой полосы
+     */
+    static void toRoute(const unsigned char* in, unsigned char* out, const ColumnRoute& route,
+                        std::size_t rowBegin, std::size_t rowEnd) {
+        unsigned char* columns[N];
+        for (std::size_t col = 0; col < N; col++) {
+            columns[col] = out + route.start(col) * Bytes;
+        }
+        const std::size_t full = fullRows(route);
+        const std::size_t end = std::min(rowEnd, full);
+        std::size_t row = rowBegin;
+        if (end >= row + blockRows && setConflict(columns)) {
+            for (; row + blockRows <= end; row += blockRows) {
+                toRouteBlock(in + row * N * Bytes, columns, row * Bytes, std::make_index_sequence<N>{});
+            }
+        }
+        for (; row < end; row++) {
+            toRouteRow(in + row * N * Bytes, columns, row * Bytes, std::make_index_sequence<N>{});
+        }
+        if (full < route.rows && rowBegin <= full && full < rowEnd) {
+            for (std::size_t col = 0; col < route.lastRowLength; col++) {
+                std::memcpy(columns[col] + full * Bytes, in + (full * N + col) * Bytes, Bytes);
+            }
+        }
+    }
+
+    /**
+     * @brief Перестановка полосы строк из порядка маршрута в таблицу
+     * @param in Ячейки в порядке маршрута
+     * @param out Буфер результата (таблица по строкам)
+     * @param route Маршрут (route.columns == N)
+     * @param rowBegin Первая строка полосы
+     * @param rowEnd Строка за последней строкой полосы
+     */
+    static void fromRoute(const unsigned char* in, unsigned char* out, const ColumnRoute& route,
+                          std::size_t rowBegin, std::size_t rowEnd) {
+        const unsigned char* columns[N];
+        for (std::size_t col = 0; col < N; col++) {
+            columns[col] = in + route.start(col) * Bytes;
+        }
+        const std::size_t full = fullRows(route);
+        for (std::size_t row = rowBegin; row < std::min(rowEnd, full); row++) {
+            fromRouteRow(out + row * N * Bytes, columns, row * Bytes, std::make_index_sequence<N>{});
+        }
+        if (full < route.rows && rowBegin <= full && full < rowEnd) {
+            for (std::size_t col = 0; col < route.lastRowLength; col++) {
+                std::memcpy(out + (full * N + col) * Bytes, columns[col] + full * Bytes, Bytes);
+            }
+        }
+    }
+
+    /**
+     * @brief Перестановка полосы строк
+     * @param in Исходные ячейки
+     * @param out Буфер результата
+     * @param route Маршрут (route.columns == N)
+     * @param toRoute true - из таблицы в порядок маршрута, false - обратно
+     * @param rowBegin Первая строка полосы
+     * @param rowEnd Строка за последней строкой полосы
+     */
+    static void apply(const unsigned char* in, unsigned char* out, const ColumnRoute& route, bool toRoute,
+                      std::size_t rowBegin, std::size_t rowEnd) {
+        if (toRoute) {
+            TableKernel::toRoute(in, out, route, rowBegin, rowEnd);
+        } else {
+            fromRoute(in, out, route, rowBegin, rowEnd);
+        }
+    }
+};
+
+/// Ядро перестановки полосы строк
+using RouteKernel = void (*)(const unsigned char*, unsigned char*, const ColumnRoute&, bool, std::size_t, std::size_t);
+
+/**
+ * @brief Строка таблицы выбора ядер для N столбцов
+ * @tparam N Количество столбцов
+ * @return Ядра для ячеек длиной 1 .. 4 байта
+ */
+template <std::size_t N>
+constexpr std::array<RouteKernel, 4> smallKernelRow() {
+    return {&TableKernel<N, 1>::apply, &TableKernel<N, 2>::apply, &TableKernel<N, 3>::apply, &TableKernel<N, 4>::apply};
+}
+
+/**
+ * @brief Таблица выбора ядер для 1 .. smallKernelColumns столбцов
+ * @return Ядро для N столбцов и ячеек длиной B байт в элементе [N - 1][B - 1]
+ */
+template <std::size_t... I>
+constexpr std::array<std::array<RouteKernel, 4>, sizeof...(I)> makeSmallKernels(std::index_sequence<I...>) {
+    return {smallKernelRow<I + 1>()...};
+}
+
+/// Специализированные ядра для малого количества столбцов
+constexpr auto smallKernels = makeSmallKernels(std::make_index_sequence<smallKernelColumns>{});
+
+} // namespace
+
+/**
+ * @brief Маршрут табличной перестановки по умолчанию
+ * @param columns Количество столбцов таблицы
+ * @param length Длина текста в символах
+ * @return Маршрут: запись по строкам, чтение по столбцам справа налево
+ */
+ColumnRoute tableRoute(std::size_t columns, std::size_t length) {
+    ColumnRoute route;
+    route.columns = columns;
+    route.rows = (length + columns - 1) / columns;
+    route.lastRowLength = length - (route.rows - 1) * columns;
+    return route;
+}
+
+/**
+ * @brief Перестановка ячеек по столбцовому маршруту
+ * @param in Исходные ячейки
+ * @param out Буфер результата, не пересекающийся с in
+ * @param cellSize Длина ячейки в байтах (1 .. 4)
+ * @param route Маршрут
+ * @param toRoute true - из таблицы в порядок маршрута, false - обратно
+ */
+void transposeRoute(const void* in, void* out, std::size_t cellSize, const ColumnRoute& route, bool toRoute) {
+    transposeRouteRows(in, out, cellSize, route, toRoute, 0, route.rows);
+}
+
+/**
+ * @brief Перестановка ячеек полосы строк таблицы по столбцовому маршруту
+ * @param in Исходные ячейки
+ * @param out Буфер результата, не пересекающийся с in
+ * @param cellSize Длина ячейки в байтах (1 .. 4)
+ * @param route Маршрут
+ * @param toRoute true - из таблицы в порядок маршрута, false - обратно
+ * @param rowBegin Первая строка полосы
+ * @param rowEnd Строка за последней строкой полосы
+ */
+void transposeRouteRows(const void* in, void* out, std::size_t cellSize, const ColumnRoute& route, bool toRoute,
+                        std::size_t rowBegin, std::size_t rowEnd) {
+    const unsigned char* from = static_cast<const unsigned char*>(in);
+    unsigned char* to = static_cast<unsigned char*>(out);
+    if (route.columns >= 1 && route.columns <= smallKernelColumns) {
+        smallKernels[route.columns - 1][cellSize - 1](from, to, route, toRoute, rowBegin, rowEnd);
+        return;
+    }
+    switch (cellSize) {
+        case 1:
+            transposeCells<1>(from, to, route, toRoute, rowBegin, rowEnd);
+            break;
+        case 2:
+            transposeCells<2>(from, to, route, toRoute, rowBegin, rowEnd);
+            break;
+        case 3:
+            transposeCells<3>(from, to, route, toRoute, rowBegin, rowEnd);
+            break;
+        default:
+            transposeCells<4>(from, to, route, toRoute, rowBegin, rowEnd);
+            break;
+    }
+}
@@ -0,0 +1,103 @@
+#pragma once
+#include <cstddef>
+
+/**
+ * @file
+ * @author Ганьшин В.А.
+ * @version 1.0
+ * @date 17.12.2025
+ * @brief Блочное ядро столбцовых маршрутов перестановки
+ * @details Текст записывается в таблицу по строкам слева направо, сверху вниз
+ * (последняя строка может быть неполной) и читается по столбцам сверху вниз
+ * в порядке, заданном маршрутом. При большом количестве столбцов соседние
+ * символы столбца лежат в тексте на расстоянии целой строки, и посимвольное
+ * чтение промахивается мимо кэша и TLB на каждом символе. Ядро обходит таблицу
+ * квадратными блоками routeTile × routeTile: строки блока остаются в кэше,
+ * пока из них читаются все столбцы блока, а в результат пишутся непрерывные отрезки.
+ * Для таблиц не шире smallKernelColumns столбцов ядро выбирается по количеству
+ * столбцов из таблицы специализаций, развернутых при компиляции.
+ */
+
+/// Сторона блока таблицы (строк и столбцов), обрабатываемого за один проход
+constexpr std::size_t routeTile = 64;
+
+/// Наибольшее количество столбцов, для которого выбирается специализированное ядро TableKernel<N>
+constexpr std::size_t smallKernelColumns = 16;
+
+/**
+ * @brief Столбцовый маршрут по таблице
+ * @details Описывает, где в результате начинается каждый столбец таблицы.
+ * Столбец высотой h занимает в результате h ячеек подряд начиная с позиции начала столбца
+ */
+struct ColumnRoute {
+    std::size_t rows = 0; ///< Количество строк таблицы (последняя может быть неполной)
+    std::size_t columns = 0; ///< Количество столбцов таблицы
+    std::size_t lastRowLength = 0; ///< Количество ячеек последней строки (1 .. columns)
+    const std::size_t* starts = nullptr; ///< Начало каждого столбца в результате (ячеек); nullptr - столбцы читаются справа налево
+
+    /**
+     * @brief Начало столбца в результате
+     * @param col Номер столбца
+     * @return Позиция первой ячейки столбца в результате
+     * @details Для чтения справа налево правее столбца col стоят (columns - 1 - col)
+     * столбцов высотой rows - 1 и еще max(0, lastRowLength - col - 1) ячеек последней строки
+     */
+    std::size_t start(std::size_t col) const {
+        if (starts) {
+            return starts[col];
+        }
+        std::size_t index = (columns - 1 - col) * (rows - 1);
+        if (lastRowLength > col + 1) {
+            index += lastRowLength - col - 1;
+        }
+        return index;
+    }
+
+    /**
+     * @brief Высота столбца
+     * @param col Номер столбца
+     * @return Количество ячеек столбца
+     */
+    std::size_t height(std::size_t col) const {
+        return (col < lastRowLength) ? rows : rows - 1;
+    }
+};
+
+/**
+ * @brief Маршрут табличной перестановки по умолчанию
+ * @param columns Количество столбцов таблицы (не меньше 1)
+ * @param length Длина текста в символах (не меньше columns)
+ * @return Маршрут: запись по строкам, чтение по столбцам справа налево
+ */
+ColumnRoute tableRoute(std::size_t columns, std::size_t length);
+
+/**
+ * @brief Перестановка ячеек по столбцовому маршруту
+ * @details Ячейка - символ фиксированной длины: wchar_t или символ UTF-8
+ * одинаковой для всего текста длины. Не выделяет память в куче
+ * @param in Исходные ячейки
+ * @param out Буфер результата на rows * columns - (columns - lastRowLength) ячеек,
+ * не пересекающийся с in
+ * @param cellSize Длина ячейки в байтах (1 .. 4)
+ * @param route Маршрут
+ * @param toRoute true - из таблицы (по строкам) в порядок маршрута (шифрование),
+ * false - из порядка маршрута в таблицу (расшифрование)
+ */
+void transposeRoute(const void* in, void* out, std::size_t cellSize, const ColumnRoute& route, bool toRoute);
+
+/**
+ * @brief Перестановка ячеек полосы строк таблицы по столбцовому маршруту
+ * @details Полоса читает и пишет только ячейки своих строк: в таблице это строки
+ * rowBegin .. rowEnd - 1, в порядке маршрута - отрезки [start(col) + rowBegin,
+ * start(col) + rowEnd) каждого столбца. Поэтому полосы, не пересекающиеся по строкам,
+ * можно переставлять одновременно в один буфер результата
+ * @param in Исходные ячейки
+ * @param out Буфер результата, не пересекающийся с in
+ * @param cellSize Длина ячейки в байтах (1 .. 4)
+ * @param route Маршрут
+ * @param toRoute true - из таблицы в порядок маршрута, false - обратно
+ * @param rowBegin Первая строка полосы
+ * @param rowEnd Строка за последней строкой полосы (не больше route.rows)
+ */
+void transposeRouteRows(const void* in, void* out, std::size_t cellSize, const ColumnRoute& route, bool toRoute,
+                        std::size_t rowBegin, std::size_t rowEnd);
@@ -17,7 +17,450 @@
 #include <algorithm>
 #include <iostream>
 #include <cwctype>
+#include <cstdint>
+#include <cstring>
+#include <type_traits>
 #include <stdexcept>
+#include "../common/utf8.h"
+#include "../common/threadPool.h"
+#include "routeKernel.h"
+
+namespace {
+
+/**
+ * @brief Параллельная обработка одного вызова
+ */
+struct Parallel {
+    ThreadPool* pool = nullptr; ///< Пул потоков (nullptr - последовательная обработка)
+    std::size_t parts = 1; ///< Количество частей; 1 - последовательная обработка
+};
+
+/**
+ * @brief Первая строка полосы таблицы при делении на части
+ * @param rows Количество строк таблицы
+ * @param part Номер полосы (part == parts дает конец последней полосы)
+ * @param parts Количество полос
+ * @return Номер строки, кратный routeTile (кроме конца последней полосы)
+ */
+std::size_t bandStart(std::size_t rows, std::size_t part, std::size_t parts) {
+    if (part == parts) {
+        return rows;
+    }
+    return rows * part / parts / routeTile * routeTile;
+}
+
+/**
+ * @brief Выполнение задачи по частям
+ * @param parallel Параллельная обработка
+ * @param job Задача для части с номером 0 .. parallel.parts - 1
+ * @details При последовательной обработке задача выполняется один раз в вызывающем потоке
+ */
+template <class Job>
+void runParts(const Parallel& parallel, Job&& job) {
+    if (parallel.parts > 1) {
+        parallel.pool->run(parallel.parts, job);
+    } else {
+        job(0);
+    }
+}
+
+/**
+ * @brief Перестановка символов фиксированной длины
+ * @param in Исходные символы
+ * @param out Буфер результата, не пересекающийся с in
+ * @param cellSize Длина символа в байтах (1 .. 4)
+ * @param numColumns Количество столбцов таблицы
+ * @param length Длина текста в символах
+ * @param encrypting true - шифрование, false - расшифрование
+ * @param plans Кэш планов перестановки
+ * @param parallel Параллельная обработка
+ * @details Для маршрутов, отличных от маршрутов по умолчанию, перестановка всегда
+ * выполняется по плану: из кэша или построенному для одного вызова, если текст
+ * длиннее предела кэша; при параллельной обработке потоки переставляют диапазоны
+ * позиций шифротекста. Для маршрутов по умолчанию при параллельной обработке каждый
+ * поток переставляет свою полосу строк таблицы блочным ядром; иначе перестановка
+ * берется из плана или выполняется блочным ядром целиком
+ */
+void permuteCells(const void* in, void* out, std::size_t cellSize, int numColumns, std::size_t length,
+                  bool encrypting, TablePlanCache& plans, const Parallel& parallel) {
+    if (!plans.routes().isDefault()) {
+        std::shared_ptr<const TablePlan> plan = plans.find(numColumns, length);
+        if (!plan) {
+            plan = std::make_shared<const TablePlan>(numColumns, length, plans.routes());
+        }
+        runParts(parallel, [&](std::size_t i) {
+            plan->apply(in, out, cellSize, encrypting,
+                        length * i / parallel.parts, length * (i + 1) / parallel.parts);
+        });
+    } else if (parallel.parts > 1) {
+        const ColumnRoute route = tableRoute(numColumns, length);
+        parallel.pool->run(parallel.parts, [&](std::size_t i) {
+            transposeRouteRows(in, out, cellSize, route, encrypting,
+                               bandStart(route.rows, i, parallel.parts), bandStart(route.rows, i + 1, parallel.parts));
+        });
+    } else if (auto plan = plans.find(numColumns, length)) {
+        plan->apply(in, out, cellSize, encrypting);
+    } else {
+        transposeRoute(in, out, cellSize, tableRoute(numColumns, length), encrypting);
+    }
+}
+
+/**
+ * @brief Номер первого символа, отличного от букв и пробелов
+ * @param text Текст
+ * @param begin Начало проверяемого участка
+ * @param end Конец проверяемого участка
+ * @return Номер недопустимого символа или end, если таких нет
+ */
+std::size_t findInvalid(const wchar_t* text, std::size_t begin, std::size_t end) {
+    for (std::size_t i = begin; i < end; i++) {
+        if (!std::iswalpha(text[i]) && text[i] != L' ') {
+            return i;
+        }
+    }
+    return end;
+}
+
+/**
+ * @brief Разметка строки UTF-8 на символы
+ * @details Если все символы имеют одинаковую длину (например, только кириллица),
+ * начало символа вычисляется умножением и массив смещений не строится
+ */
+struct Utf8Layout {
+    std::size_t length = 0; ///< Количество символов
+    std::size_t width = 0; ///< Длина всех символов в байтах или 0, если длины различаются
+    std::vector<std::uint32_t> starts; ///< Начала символов и конец строки (только при различных длинах, строка не длиннее UINT32_MAX байт)
+    
+    /**
+     * @brief Смещение символа в байтах
+     * @param i Номер символа (допускается i == length)
+     * @return Смещение начала символа от начала строки
+     */
+    std::size_t offset(std::size_t i) const {
+        return width ? i * width : starts[i];
+    }
+};
+
+/**
+ * @brief Проверка строки UTF-8 и разметка ее на символы
+ * @param text Строка в кодировке UTF-8
+ * @param layout Разметка строки (память массива смещений используется повторно)
+ * @return Ошибка CipherErrc::invalidSymbol с позицией в байтах, если строка содержит
+ * символы, отличные от букв и пробелов, или некорректные последовательности UTF-8;
+ * CipherErrc::tableTooLarge, если символы различной длины, а смещения не помещаются в 32 бита
+ */
+CipherError scanUtf8(std::string_view text, Utf8Layout& layout)
+{
+    layout.length = 0;
+    layout.width = 0;
+    layout.starts.clear();
+    const char* begin = text.data();
+    const char* end = begin + text.size();
+    const char* p = begin;
+    std::size_t width = 0;
+    bool uniform = true;
+    
+    while (p < end) {
+        const std::size_t start = static_cast<std::size_t>(p - begin);
+        char32_t c = utf8Decode(p, end);
+        if (c != U' ' && !std::iswalpha(static_cast<wint_t>(c))) {
+            return {CipherErrc::invalidSymbol, start};
+        }
+        
+        const std::size_t charWidth = static_cast<std::size_t>(p - begin) - start;
+        if (layout.length == 0) {
+            width = charWidth;
+        } else if (uniform && charWidth != width) {
+            // Длины символов различаются: переходим к явному массиву смещений
+            if (text.size() > UINT32_MAX) {
+                return {CipherErrc::tableTooLarge, 0};
+            }
+            uniform = false;
+            layout.starts.reserve(text.size() / width + 1);
+            for (std::size_t i = 0; i < layout.length; i++) {
+                layout.starts.push_back(static_cast<std::uint32_t>(i * width));
+            }
+        }
+        if (!uniform) {
+            layout.starts.push_back(static_cast<std::uint32_t>(start));
+        }
+        layout.length++;
+    }
+    
+    if (uniform) {
+        layout.width = width;
+    } else {
+        layout.starts.push_back(static_cast<std::uint32_t>(text.size()));
+    }
+    return {};
+}
+
+/**
+ * @brief Параллельная проверка строки UTF-8 и разметка ее на символы
+ * @param text Строка в кодировке UTF-8
+ * @param layout Разметка строки
+ * @param parallel Параллельная обработка
+ * @return Первая по тексту ошибка, как у scanUtf8()
+ * @details Границы частей сдвигаются на начало ближайшего символа UTF-8, поэтому
+ * каждая часть разбирается так же, как при последовательной проверке. Разметки
+ * частей объединяются: текст однороден, если однородны все части с одной длиной символа,
+ * иначе массив смещений собирается из частей параллельно
+ */
+CipherError scanUtf8Parallel(std::string_view text, Utf8Layout& layout, const Parallel& parallel)
+{
+    const std::size_t parts = parallel.parts;
+    std::vector<std::size_t> bounds(parts + 1, text.size());
+    bounds[0] = 0;
+    for (std::size_t i = 1; i < parts; i++) {
+        std::size_t bound = std::max(text.size() * i / parts, bounds[i - 1]);
+        while (bound < text.size() && (static_cast<unsigned char>(text[bound]) & 0xC0) == 0x80) {
+            ++bound;
+        }
+        bounds[i] = bound;
+    }
+    
+    std::vector<Utf8Layout> local(parts);
+    std::vector<CipherError> errors(parts);
+    parallel.pool->run(parts, [&](std::size_t i) {
+        errors[i] = scanUtf8(text.substr(bounds[i], bounds[i + 1] - bounds[i]), local[i]);
+    });
+    
+    std::vector<std::size_t> first(parts + 1, 0);
+    std::size_t width = 0;
+    bool uniform = true;
+    for (std::size_t i = 0; i < parts; i++) {
+        if (errors[i]) {
+            if (errors[i].code == CipherErrc::invalidSymbol) {
+                errors[i].offset += bounds[i];
+            }
+            return errors[i];
+        }
+        first[i + 1] = first[i] + local[i].length;
+        if (local[i].length == 0) {
+            continue;
+        }
+        if (local[i].width == 0 || (width != 0 && local[i].width != width)) {
+            uniform = false;
+        }
+        width = local[i].width;
+    }
+    
+    layout.length = first[parts];
+    layout.width = uniform ? width : 0;
+    layout.starts.clear();
+    if (uniform) {
+        return {};
+    }
+    if (text.size() > UINT32_MAX) {
+        return {CipherErrc::tableTooLarge, 0};
+    }
+    layout.starts.resize(layout.length + 1);
+    parallel.pool->run(parts, [&](std::size_t i) {
+        for (std::size_t j = 0; j < local[i].length; j++) {
+            layout.starts[first[i] + j] = static_cast<std::uint32_t>(bounds[i] + local[i].offset(j));
+        }
+    });
+    layout.starts[layout.length] = static_cast<std::uint32_t>(text.size());
+    return {};
+}
+
+/**
+ * @brief Перестановка текста UTF-8 с символами различной длины
+ * @param text Проверенный текст в кодировке UTF-8
+ * @param layout Разметка текста
+ * @param out Буфер результата не меньше text.size() байт
+ * @param numColumns Количество столбцов таблицы
+ * @param encrypting true - шифрование, false - расшифрование
+ * @param plans Кэш планов перестановки
+ * @param parallel Параллельная обработка
+ * @return Количество записанных байт
+ * @details Массив смещений символов переставляется функцией permuteCells()
+ * как массив ячеек по 4 байта: получается смещение в тексте символа для каждой
+ * позиции результата. Затем части результата подсчитывают свою длину в байтах
+ * и копируют символы каждая со своей позиции
+ */
+std::size_t permuteMixed(std::string_view text, const Utf8Layout& layout, char* out, int numColumns,
+                         bool encrypting, TablePlanCache& plans, const Parallel& parallel)
+{
+    const std::size_t parts = parallel.parts;
+    const std::size_t length = layout.length;
+    std::vector<std::uint32_t> order(length);
+    permuteCells(layout.starts.data(), order.data(), sizeof(std::uint32_t), numColumns, length, encrypting,
+                 plans, parallel);
+    
+    auto width = [&](std::size_t j) {
+        return utf8SequenceLength(static_cast<unsigned char>(text[order[j]]));
+    };
+    std::vector<std::size_t> offsets(parts + 1, 0);
+    runParts(parallel, [&](std::size_t i) {
+        std::size_t bytes = 0;
+        for (std::size_t j = length * i / parts; j < length * (i + 1) / parts; j++) {
+            bytes += width(j);
+        }
+        offsets[i + 1] = bytes;
+    });
+    for (std::size_t i = 0; i < parts; i++) {
+        offsets[i + 1] += offsets[i];
+    }
+    runParts(parallel, [&](std::size_t i) {
+        char* p = out + offsets[i];
+        for (std::size_t j = length * i / parts; j < length * (i + 1) / parts; j++) {
+            const std::size_t size = width(j);
+            std::memcpy(p, text.data() + order[j], size);
+            p += size;
+        }
+    });
+    return offsets[parts];
+}
+
+/**
+ * @brief Шифрование или расшифрование текста UTF-8 в буфер
+ * @param numColumns Количество столбцов таблицы
+ * @param text Исходный текст в кодировке UTF-8
+ * @param out Буфер результата не меньше text.size() байт
+ * @param encrypting true - шифрование, false - расшифрование
+ * @param layout Разметка текста (память используется повторно между вызовами)
+ * @param plans Кэш планов перестановки
+ * @param parallel Параллельная обработка
+ * @return Количество записанных байт или ошибка входных данных
+ * @details Маршрут тот же, что и для широких строк, но таблица не строится:
+ * символ в строке row и столбце col таблицы имеет номер row * numColumns + col,
+ * а при расшифровании номер символа зашифрованного текста для ячейки (row, col)
+ * вычисляется так же, как в TableCipher::decryptInto().
+ * Символы (в том числе пробелы) копируются как последовательности байт
+ * без перекодирования, поэтому длина результата равна длине текста.
+ * Если все символы имеют одинаковую длину, перестановка выполняется по плану
+ * из кэша или блочным ядром transposeRoute() (см. permuteCells()). Для маршрутов,
+ * отличных от маршрутов по умолчанию, и в параллельном режиме символы различной
+ * длины переставляются по массиву смещений (см. permuteMixed()).
+ */
+CipherResult<std::size_t> routeUtf8(int numColumns, std::string_view text, char* out, bool encrypting,
+                                    Utf8Layout& layout, TablePlanCache& plans, const Parallel& parallel)
+{
+    if (text.empty()) {
+        return CipherErrc::emptyText;
+    }
+    
+    CipherError error = (parallel.parts > 1) ? scanUtf8Parallel(text, layout, parallel) : scanUtf8(text, layout);
+    if (error) {
+        return error;
+    }
+    
+    const std::size_t length = layout.length;
+    if (static_cast<std::size_t>(numColumns) > length) {
+        return CipherErrc::keyLongerThanText;
+    }
+    const std::size_t numRows = (length + numColumns - 1) / numColumns;
+    if ((encrypting && numRows > 10000) || (length > maxRouteLength && !plans.routes().isDefault())) {
+        return CipherErrc::tableTooLarge;
+    }
+    
+    if (layout.width != 0) {
+        permuteCells(text.data(), out, layout.width, numColumns, length, encrypting, plans, parallel);
+        return text.size();
+    }
+    if (parallel.parts > 1 || !plans.routes().isDefault()) {
+        return permuteMixed(text, layout, out, numColumns, encrypting, plans, parallel);
+    }
+    
+    // Копирование символа с номером index
+    char* end = out;
+    auto copyChar = [&](std::size_t index) {
+        const std::size_t begin = layout.offset(index);
+        const std::size_t size = layout.offset(index + 1) - begin;
+        std::memcpy(end, text.data() + begin, size);
+        end += size;
+    };
+    
+    if (encrypting) {
+        // ЧТЕНИЕ: сверху вниз, справа налево
+        for (int col = numColumns - 1; col >= 0; col--) {
+            for (std::size_t index = col; index < length; index += numColumns) {
+                copyChar(index);
+            }
+        }
+    } else {
+        // ЧТЕНИЕ: по строкам слева направо, сверху вниз
+        const ColumnRoute route = tableRoute(numColumns, length);
+        for (std::size_t row = 0; row < numRows; row++) {
+            const std::size_t rowLength = (row == numRows - 1) ? route.lastRowLength : route.columns;
+            for (std::size_t col = 0; col < rowLength; col++) {
+                copyChar(route.start(col) + row);
+            }
+        }
+    }
+    
+    return static_cast<std::size_t>(end - out);
+}
+
+/**
+ * @brief Значение результата или исключение с его ошибкой
+ * @param result Результат операции
+ * @param encrypting true - шифрование, false - дешифрование
+ * @return Значение результата
+ * @throw table_cipher_error Если результат содержит ошибку
+ */
+template <class T>
+T valueOrThrow(CipherResult<T>&& result, bool encrypting)
+{
+    if (!result) {
+        throw TableCipher::makeError(result.error(), encrypting);
+    }
+    return std::move(*result);
+}
+
+} // namespace
+
+/**
+ * @brief Текст сообщения об ошибке
+ * @param code Код ошибки
+ * @param encrypting true - шифрование, false - дешифрование
+ * @return Сообщение об ошибке
+ */
+const char* TableCipher::errorMessage(CipherErrc code, bool encrypting) {
+    switch (code) {
+        case CipherErrc::ok:
+            return "";
+        case CipherErrc::keyNotPositive:
+            return "Ключ должен быть положительным числом";
+        case CipherErrc::keyTooLarge:
+            return "Ключ слишком большой. Максимальное значение: 1000";
+        case CipherErrc::emptyText:
+            return encrypting ? "Пустой текст для шифрования!"
+                              : "Пустой текст для расшифровки!";
+        case CipherErrc::invalidSymbol:
+            return encrypting ? "Текст содержит недопустимые символы! Разрешены только буквы и пробелы."
+                              : "Зашифрованный текст содержит недопустимые символы!";
+        case CipherErrc::keyLongerThanText:
+            return encrypting ? "Ключ не может быть больше длины текста"
+                              : "Ключ не может быть больше длины зашифрованного текста";
+        case CipherErrc::tableTooLarge:
+            return encrypting ? "Слишком большая таблица для шифрования"
+                              : "Слишком длинный текст для расшифровки по заданному маршруту";
+        case CipherErrc::bufferTooSmall:
+            return "Недостаточный размер буфера для результата";
+        case CipherErrc::invalidBatchOffsets:
+            return "Некорректные смещения сообщений пакета";
+        case CipherErrc::inPlaceUnsupported:
+            return "Входной и выходной файлы совпадают";
+        case CipherErrc::ioError:
+            return "Ошибка чтения или записи файла";
+        case CipherErrc::invalidRoute:
+            return "Некорректный маршрут таблицы или маршрут не поддерживается для файлов";
+        default:
+            return "Неизвестная ошибка шифрования";
+    }
+}
+
+/**
+ * @brief Исключение для ошибки
+ * @param error Описание ошибки
+ * @param encrypting true - шифрование, false - дешифрование
+ * @return Исключение с сообщением и кодом ошибки
+ */
+table_cipher_error TableCipher::makeError(CipherError error, bool encrypting) {
+    return table_cipher_error(errorMessage(error.code, encrypting), error);
+}
 
 /**
  * @brief Конструктор класса TableCipher
@@ -34,6 +477,35 @@
 TableCipher::TableCipher(int key) {
     validateKey(key); // Проверка корректности ключа
     numColumns = key; // Установка количества столбцов
+    plans = std::make_shared<TablePlanCache>();
+}
+
+/**
+ * @brief Создание шифра без исключений
+ * @param key Количество столбцов таблицы
+ * @return Шифр или ошибка ключа
+ */
+CipherResult<TableCipher> TableCipher::create(int key) {
+    CipherError error = checkKey(key);
+    if (error) {
+        return error;
+    }
+    return TableCipher(key);
+}
+
+/**
+ * @brief Проверка ключа без исключений
+ * @param key Ключ для проверки
+ * @return Ошибка ключа (код CipherErrc::ok, если ключ корректен)
+ */
+CipherError TableCipher::checkKey(int key) {
+    if (key <= 0) {
+        return {CipherErrc::keyNotPositive, 0};
+    }
+    if (key > 1000) {
+        return {CipherErrc::keyTooLarge, 0};
+    }
+    return {};
 }
 
 /**
@@ -51,12 +523,114 @@ TableCipher::TableCipher(int key) {
  * @endcode
  */
 void TableCipher::validateKey(int key) {
-    if (key <= 0) {
-        throw table_cipher_error("Ключ должен быть положительным числом");
+    CipherError error = checkKey(key);
+    if (error) {
+        throw makeError(error, true);
     }
-    if (key > 1000) {
-        throw table_cipher_error("Ключ слишком большой. Максимальное значение: 1000");
+}
+
+/**
+ * @brief Количество частей для параллельной обработки текста
+ * @param length Длина текста (символов или байт UTF-8)
+ * @return Количество частей; 1 означает последовательную обработку
+ */
+std::size_t TableCipher::parallelParts(std::size_t length) const {
+    if (!pool) {
+        return 1;
+    }
+    std::size_t parts = length / parallelMinChunk;
+    if (parts > pool->size()) {
+        parts = pool->size();
+    }
+    return parts > 1 ? parts : 1;
+}
+
+/**
+ * @brief Включение параллельного режима
+ * @param workers Количество потоков; 0 или 1 - последовательный режим
+ * @param minChunkSize Наименьший фрагмент текста (символов или байт UTF-8) на один поток
+ */
+void TableCipher::setParallelism(std::size_t workers, std::size_t minChunkSize) {
+    pool = (workers > 1) ? std::make_shared<ThreadPool>(workers) : nullptr;
+    parallelMinChunk = (minChunkSize > 0) ? minChunkSize : 1;
+}
+
+/**
+ * @brief Настройка кэша планов перестановки
+ * @param capacity Наибольшее количество планов; 0 - кэш отключен
+ * @param maxLength Наибольшая длина текста для плана, символов
+ */
+void TableCipher::setPlanCache(std::size_t capacity, std::size_t maxLength) {
+    plans = std::make_shared<TablePlanCache>(capacity, maxLength, plans->routes());
+}
+
+/**
+ * @brief Установка маршрутов записи и чтения таблицы
+ * @param routes Маршруты записи и чтения
+ * @throw table_cipher_error Если маршрут RouteShape::keyColumns не подходит к ключу
+ */
+void TableCipher::setRoutes(const TableRoutes& routes) {
+    CipherError error = checkRoutes(routes, numColumns);
+    if (error) {
+        throw makeError(error, true);
     }
+    plans = std::make_shared<TablePlanCache>(plans->stats().capacity, plans->lengthLimit(), routes);
+}
+
+/**
+ * @brief Статистика кэша планов
+ * @return Количество попаданий, промахов и планов в кэше
+ */
+TablePlanStats TableCipher::planStats() const {
+    return plans->stats();
+}
+
+/**
+ * @brief Шифрование файла в файл
+ * @param input Путь к входному файлу
+ * @param output Путь к выходному файлу
+ * @return Количество записанных байт
+ * @throw table_cipher_error При некорректном содержимом файла или ошибке ввода-вывода
+ */
+std::size_t TableCipher::encryptFile(const std::string& input, const std::string& output) const {
+    return valueOrThrow(tryEncryptFile(input, output), true);
+}
+
+/**
+ * @brief Дешифрование файла в файл
+ * @param input Путь к зашифрованному файлу
+ * @param output Путь к выходному файлу
+ * @return Количество записанных байт
+ * @throw table_cipher_error При некорректном содержимом файла или ошибке ввода-вывода
+ */
+std::size_t TableCipher::decryptFile(const std::string& input, const std::string& output) const {
+    return valueOrThrow(tryDecryptFile(input, output), false);
+}
+
+/**
+ * @brief Шифрование файла в файл без исключений
+ * @param input Путь к входному файлу
+ * @param output Путь к выходному файлу
+ * @return Количество записанных байт или ошибка
+ */
+CipherResult<std::size_t> TableCipher::tryEncryptFile(const std::string& input, const std::string& output) const {
+    if (!routes().isDefault()) {
+        return CipherErrc::invalidRoute;
+    }
+    return routeFile(numColumns, input, output, true, fileBudget);
+}
+
+/**
+ * @brief Дешифрование файла в файл без исключений
+ * @param input Путь к зашифрованному файлу
+ * @param output Путь к выходному файлу
+ * @return Количество записанных байт или ошибка
+ */
+CipherResult<std::size_t> TableCipher::tryDecryptFile(const std::string& input, const std::string& output) const {
+    if (!routes().isDefault()) {
+        return CipherErrc::invalidRoute;
+    }
+    return routeFile(numColumns, input, output, false, fileBudget);
 }
 
 /**
@@ -66,10 +640,14 @@ void TableCipher::validateKey(int key) {
  * @throw table_cipher_error При некорректных входных данных
  * @details Алгоритм шифрования:
  * 1. **Проверка входных данных**: текст не должен быть пустым и содержать только буквы и пробелы
- * 2. **Создание таблицы**: вычисление количества строк и создание таблицы numRows × numColumns
- * 3. **Запись в таблицу**: заполнение таблицы по горизонтали слева направо, сверху вниз
+ * 2. **Размеры таблицы**: вычисление количества строк numRows при numColumns столбцах
+ * 3. **Запись в таблицу**: текст записывается по горизонтали слева направо, сверху вниз
  * 4. **Чтение из таблицы**: чтение данных сверху вниз, справа налево
  * 
+ * Таблица в памяти не строится: символ в строке row и столбце col имеет в тексте
+ * номер row * numColumns + col, поэтому результат сразу пишется в строку длины текста
+ * (см. tryEncryptInto()). Пробелы переставляются наравне с буквами.
+ * 
  * Пример работы:
  * @code
  * Текст: "ПРИВЕТМИР", Ключ: 3
@@ -81,58 +659,7 @@ void TableCipher::validateKey(int key) {
  * @endcode
  */
 std::wstring TableCipher::encrypt(const std::wstring& text) {
-    // Проверка входного текста на пустоту
-    if (text.empty()) {
-        throw table_cipher_error("Пустой текст для шифрования!");
-    }
-    
-    // Проверка символов текста на допустимость
-    for (wchar_t c : text) {
-        if (!std::iswalpha(c) && c != L' ') {
-            throw table_cipher_error("Текст содержит недопустимые символы! Разрешены только буквы и пробелы.");
-        }
-    }
-    
-    // Проверка, что ключ не больше длины текста
-    if (numColumns > static_cast<int>(text.length())) {
-        throw table_cipher_error("Ключ не может быть больше длины текста");
-    }
-    
-    // Вычисление количества строк таблицы
-    int textLength = static_cast<int>(text.length());
-    int numRows = (textLength + numColumns - 1) / numColumns;
-    
-    // Проверка на слишком большую таблицу (защита от переполнения)
-    if (numRows > 10000 || numColumns > 10000) {
-        throw table_cipher_error("Слишком большая таблица для шифрования");
-    }
-    
-    // Создание таблицы для заполнения
-    // Инициализация таблицы пробелами размером numRows × numColumns
-    std::vector<std::vector<wchar_t>> table(numRows, std::vector<wchar_t>(numColumns, L' '));
-    
-    // ЗАПИСЬ: по горизонтали слева направо, сверху вниз
-    int index = 0;
-    for (int row = 0; row < numRows; row++) {
-        for (int col = 0; col < numColumns; col++) {
-            if (index < textLength) {
-                table[row][col] = text[index++];
-            }
-        }
-    }
-    
-    // ЧТЕНИЕ: сверху вниз, справа налево
-    std::wstring result;
-    for (int col = numColumns - 1; col >= 0; col--) {
-        for (int row = 0; row < numRows; row++) {
-            // Добавляем только непустые ячейки
-            if (table[row][col] != L' ') {
-                result += table[row][col];
-            }
-        }
-    }
-    
-    return result;
+    return valueOrThrow(tryEncrypt(text), true);
 }
 
 /**
@@ -142,13 +669,15 @@ std::wstring TableCipher::encrypt(const std::wstring& text) {
  * @throw table_cipher_error При некорректных входных данных
  * @details Алгоритм расшифрования (обратный шифрованию):
  * 1. **Проверка входных данных**: текст не должен быть пустым и содержать только буквы и пробелы
- * 2. **Создание таблицы**: вычисление количества строк и создание таблицы numRows × numColumns
- * 3. **Запись в таблицу**: заполнение таблицы по столбцам справа налево, сверху вниз
+ * 2. **Размеры таблицы**: вычисление количества строк и длины последней строки
+ * 3. **Запись в таблицу**: текст записывается по столбцам справа налево, сверху вниз
  * 4. **Чтение из таблицы**: чтение данных по строкам слева направо, сверху вниз
  * 
  * Особенности алгоритма:
  * - Учитывается неполнота последней строки таблицы
- * - Пустые ячейки заполняются пробелами и игнорируются при чтении
+ * - Таблица в памяти не строится: номер символа зашифрованного текста для каждой
+ *   ячейки вычисляется по строке, столбцу и длине последней строки (см. tryDecryptInto())
+ * - Пробелы переставляются наравне с буквами, поэтому decrypt(encrypt(text)) == text
  * 
  * Пример работы:
  * @code
@@ -161,66 +690,306 @@ std::wstring TableCipher::encrypt(const std::wstring& text) {
  * @endcode
  */
 std::wstring TableCipher::decrypt(const std::wstring& cipher_text) {
-    // Проверка зашифрованного текста на пустоту
-    if (cipher_text.empty()) {
-        throw table_cipher_error("Пустой текст для расшифровки!");
+    return valueOrThrow(tryDecrypt(cipher_text), false);
+}
+
+/**
+ * @brief Шифрование текста в кодировке UTF-8
+ * @param text Исходный текст в кодировке UTF-8
+ * @return Зашифрованная строка в кодировке UTF-8
+ * @throw table_cipher_error При некорректных входных данных
+ */
+std::string TableCipher::encrypt(std::string_view text) {
+    return valueOrThrow(tryEncrypt(text), true);
+}
+
+/**
+ * @brief Расшифрование текста в кодировке UTF-8
+ * @param cipher_text Зашифрованный текст в кодировке UTF-8
+ * @return Расшифрованная строка в кодировке UTF-8
+ * @throw table_cipher_error При некорректных входных данных
+ */
+std::string TableCipher::decrypt(std::string_view cipher_text) {
+    return valueOrThrow(tryDecrypt(cipher_text), false);
+}
+
+/**
+ * @brief Шифрование текста без исключений
+ * @param text Исходный текст
+ * @return Зашифрованная строка или ошибка с позицией недопустимого символа
+ */
+CipherResult<std::wstring> TableCipher::tryEncrypt(const std::wstring& text) const {
+    std::wstring result(requiredOutputSize(text.size()), L'\0');
+    CipherResult<std::size_t> written = tryEncryptInto(text.data(), text.size(), &result[0], result.size());
+    if (!written) {
+        return written.error();
     }
-    
-    // Проверка символов зашифрованного текста на допустимость
-    for (wchar_t c : cipher_text) {
-        if (!std::iswalpha(c) && c != L' ') {
-            throw table_cipher_error("Зашифрованный текст содержит недопустимые символы!");
+    result.resize(*written);
+    return result;
+}
+
+/**
+ * @brief Дешифрование текста без исключений
+ * @param cipher_text Зашифрованный текст
+ * @return Расшифрованная строка или ошибка с позицией недопустимого символа
+ */
+CipherResult<std::wstring> TableCipher::tryDecrypt(const std::wstring& cipher_text) const {
+    std::wstring result(requiredOutputSize(cipher_text.size()), L'\0');
+    CipherResult<std::size_t> written = tryDecryptInto(cipher_text.data(), cipher_text.size(), &result[0], result.size());
+    if (!written) {
+        return written.error();
+    }
+    result.resize(*written);
+    return result;
+}
+
+/**
+ * @brief Шифрование текста UTF-8 без исключений
+ * @param text Исходный текст в кодировке UTF-8
+ * @return Зашифрованная строка или ошибка с позицией недопустимого символа в байтах
+ */
+CipherResult<std::string> TableCipher::tryEncrypt(std::string_view text) const {
+    Utf8Layout layout;
+    std::string result(text.size(), '\0');
+    CipherResult<std::size_t> written = routeUtf8(numColumns, text, &result[0], true, layout, *plans,
+                                                   Parallel{pool.get(), parallelParts(text.size())});
+    if (!written) {
+        return written.error();
+    }
+    result.resize(*written);
+    return result;
+}
+
+/**
+ * @brief Дешифрование текста UTF-8 без исключений
+ * @param cipher_text Зашифрованный текст в кодировке UTF-8
+ * @return Расшифрованная строка или ошибка с позицией недопустимого символа в байтах
+ */
+CipherResult<std::string> TableCipher::tryDecrypt(std::string_view cipher_text) const {
+    Utf8Layout layout;
+    std::string result(cipher_text.size(), '\0');
+    CipherResult<std::size_t> written = routeUtf8(numColumns, cipher_text, &result[0], false, layout, *plans,
+                                                   Parallel{pool.get(), parallelParts(cipher_text.size())});
+    if (!written) {
+        return written.error();
+    }
+    result.resize(*written);
+    return result;
+}
+
+/**
+ * @brief Проверка текста перед шифрованием или расшифрованием
+ * @param text Текст
+ * @param length Длина текста в символах
+ * @param encrypting true - шифрование, false - расшифрование
+ * @return Ошибка, если текст пустой, содержит недопустимые символы,
+ * короче ключа или не помещается в таблицу
+ */
+CipherError TableCipher::checkText(const wchar_t* text, std::size_t length, bool encrypting) const {
+    if (length == 0) {
+        return {CipherErrc::emptyText, 0};
+    }
+    const std::size_t parts = parallelParts(length);
+    std::size_t invalid = length;
+    if (parts > 1) {
+        std::vector<std::size_t> found(parts);
+        pool->run(parts, [&](std::size_t i) {
+            found[i] = findInvalid(text, length * i / parts, length * (i + 1) / parts);
+        });
+        for (std::size_t i = 0; i < parts && invalid == length; i++) {
+            if (found[i] != length * (i + 1) / parts) {
+                invalid = found[i];
+            }
         }
+    } else {
+        invalid = findInvalid(text, 0, length);
     }
-    
-    // Проверка, что ключ не больше длины зашифрованного текста
-    if (numColumns > static_cast<int>(cipher_text.length())) {
-        throw table_cipher_error("Ключ не может быть больше длины зашифрованного текста");
+    if (invalid != length) {
+        return {CipherErrc::invalidSymbol, invalid};
     }
-    
-    // Вычисление количества строк таблицы
-    int cipherLength = static_cast<int>(cipher_text.length());
-    int numRows = (cipherLength + numColumns - 1) / numColumns;
-    
-    // Вычисление количества символов в последней строке
-    // Это необходимо для корректного заполнения таблицы при расшифровании
-    int lastRowLength = cipherLength % numColumns;
-    if (lastRowLength == 0) {
-        lastRowLength = numColumns; // Если текст полностью заполняет таблицу
+    if (static_cast<std::size_t>(numColumns) > length) {
+        return {CipherErrc::keyLongerThanText, 0};
+    }
+    if ((encrypting && (length + numColumns - 1) / numColumns > 10000) ||
+        (length > maxRouteLength && !plans->routes().isDefault())) {
+        return {CipherErrc::tableTooLarge, 0};
+    }
+    return {};
+}
+
+/**
+ * @brief Шифрование в буфер вызывающей стороны
+ * @param text Исходный текст
+ * @param length Длина текста в символах
+ * @param out Буфер результата
+ * @param capacity Размер буфера
+ * @return Количество записанных символов
+ * @throw table_cipher_error При некорректных входных данных или слишком малом буфере
+ */
+std::size_t TableCipher::encryptInto(const wchar_t* text, std::size_t length, wchar_t* out, std::size_t capacity) const {
+    return valueOrThrow(tryEncryptInto(text, length, out, capacity), true);
+}
+
+/**
+ * @brief Шифрование в буфер вызывающей стороны без исключений
+ * @param text Исходный текст
+ * @param length Длина текста в символах
+ * @param out Буфер результата
+ * @param capacity Размер буфера
+ * @return Количество записанных символов или ошибка
+ * @details Символ в строке row и столбце col таблицы имеет номер row * numColumns + col,
+ * поэтому столбец col читается с шагом numColumns. Каждый символ текста,
+ * включая пробелы, попадает в результат ровно один раз.
+ * Для коротких текстов номера берутся из плана перестановки (кэш планов),
+ * длинные тексты обходятся блоками ядром transposeRoute(), потому что при большом
+ * количестве столбцов чтение с шагом numColumns промахивается мимо кэша процессора.
+ * В параллельном режиме полосы строк таблицы переставляются разными потоками.
+ */
+CipherResult<std::size_t> TableCipher::tryEncryptInto(const wchar_t* text, std::size_t length, wchar_t* out, std::size_t capacity) const {
+    CipherError error = checkText(text, length, true);
+    if (error) {
+        return error;
+    }
+    if (capacity < requiredOutputSize(length)) {
+        return CipherErrc::bufferTooSmall;
     }
     
-    // Создание пустой таблицы
-    std::vector<std::vector<wchar_t>> table(numRows, std::vector<wchar_t>(numColumns, L' '));
+    permuteCells(text, out, sizeof(wchar_t), numColumns, length, true, *plans, Parallel{pool.get(), parallelParts(length)});
+    return length;
+}
+
+/**
+ * @brief Дешифрование в буфер вызывающей стороны
+ * @param cipher_text Зашифрованный текст
+ * @param length Длина текста в символах
+ * @param out Буфер результата
+ * @param capacity Размер буфера
+ * @return Количество записанных символов
+ * @throw table_cipher_error При некорректных входных данных или слишком малом буфере
+ */
+std::size_t TableCipher::decryptInto(const wchar_t* cipher_text, std::size_t length, wchar_t* out, std::size_t capacity) const {
+    return valueOrThrow(tryDecryptInto(cipher_text, length, out, capacity), false);
+}
+
+/**
+ * @brief Дешифрование в буфер вызывающей стороны без исключений
+ * @param cipher_text Зашифрованный текст
+ * @param length Длина текста в символах
+ * @param out Буфер результата
+ * @param capacity Размер буфера
+ * @return Количество записанных символов или ошибка
+ * @details Номер символа зашифрованного текста для ячейки (row, col) вычисляется напрямую:
+ * правее столбца col стоят (numColumns - 1 - col) столбцов высотой numRows - 1
+ * и еще max(0, lastRowLength - col - 1) ячеек последней строки (см. ColumnRoute::start()).
+ * Для коротких текстов номера берутся из плана перестановки (кэш планов),
+ * длинные тексты обходятся блоками ядром transposeRoute(), в параллельном режиме -
+ * полосами строк таблицы в разных потоках.
+ */
+CipherResult<std::size_t> TableCipher::tryDecryptInto(const wchar_t* cipher_text, std::size_t length, wchar_t* out, std::size_t capacity) const {
+    CipherError error = checkText(cipher_text, length, false);
+    if (error) {
+        return error;
+    }
+    if (capacity < requiredOutputSize(length)) {
+        return CipherErrc::bufferTooSmall;
+    }
     
-    // ЗАПИСЬ: заполняем таблицу по столбцам справа налево, сверху вниз
-    int index = 0;
-    for (int col = numColumns - 1; col >= 0; col--) {
-        for (int row = 0; row < numRows; row++) {
-            // Пропускаем ячейки в неполных столбцах последней строки
-            // Это обеспечивает корректное восстановление исходного текста
-            if (row == numRows - 1 && col >= lastRowLength) {
-                continue; // Пропускаем пустые ячейки в последней строке
-            }
-            if (index < cipherLength) {
-                table[row][col] = cipher_text[index++];
-            }
-        }
+    permuteCells(cipher_text, out, sizeof(wchar_t), numColumns, length, false, *plans, Parallel{pool.get(), parallelParts(length)});
+    return length;
+}
+
+/**
+ * @brief Пакетное шифрование или дешифрование
+ * @param messages Арена сообщений
+ * @param offsets Смещения сообщений в арене
+ * @param encrypting true - шифрование, false - дешифрование
+ * @return Результаты и ошибки по сообщениям
+ * @throw table_cipher_error Если смещения некорректны
+ * @details Перестановка не меняет длину текста,
+ * поэтому арена результатов выделяется один раз длиной во всю арену сообщений
+ */
+template <class Char>
+BatchResult<Char> TableCipher::transformBatch(std::basic_string_view<Char> messages, const std::vector<std::size_t>& offsets, bool encrypting) const {
+    if (!batchOffsetsValid(offsets, messages.size())) {
+        throw makeError({CipherErrc::invalidBatchOffsets, 0}, encrypting);
     }
     
-    // ЧТЕНИЕ: по строкам слева направо, сверху вниз
-    std::wstring result;
-    for (int row = 0; row < numRows; row++) {
-        for (int col = 0; col < numColumns; col++) {
-            // Добавляем только непустые ячейки
-            if (table[row][col] != L' ') {
-                result += table[row][col];
+    const std::size_t count = offsets.size() - 1;
+    BatchResult<Char> result;
+    result.offsets.resize(count + 1);
+    result.errors.resize(count);
+    result.data.resize(messages.size());
+    
+    Char* out = &result.data[0];
+    std::size_t written = 0;
+    Utf8Layout layout; // Общий для всех сообщений пакета
+    for (std::size_t i = 0; i < count; i++) {
+        result.offsets[i] = written;
+        std::basic_string_view<Char> text = messages.substr(offsets[i], offsets[i + 1] - offsets[i]);
+        CipherResult<std::size_t> produced = [&] {
+            if constexpr (std::is_same_v<Char, wchar_t>) {
+                return encrypting ? tryEncryptInto(text.data(), text.size(), out + written, result.data.size() - written)
+                                  : tryDecryptInto(text.data(), text.size(), out + written, result.data.size() - written);
+            } else {
+                return routeUtf8(numColumns, text, out + written, encrypting, layout, *plans, Parallel{});
             }
+        }();
+        if (produced) {
+            written += *produced;
+        } else {
+            result.errors[i] = produced.error();
+            result.failed++;
         }
     }
-    
+    result.offsets[count] = written;
+    result.data.resize(written);
     return result;
 }
 
+/**
+ * @brief Пакетное шифрование сообщений
+ * @param messages Сообщения, записанные подряд
+ * @param offsets Смещения сообщений
+ * @return Результаты и ошибки по сообщениям
+ * @throw table_cipher_error Если смещения некорректны
+ */
+BatchResult<wchar_t> TableCipher::encryptBatch(std::wstring_view messages, const std::vector<std::size_t>& offsets) const {
+    return transformBatch(messages, offsets, true);
+}
+
+/**
+ * @brief Пакетное дешифрование сообщений
+ * @param messages Сообщения, записанные подряд
+ * @param offsets Смещения сообщений
+ * @return Результаты и ошибки по сообщениям
+ * @throw table_cipher_error Если смещения некорректны
+ */
+BatchResult<wchar_t> TableCipher::decryptBatch(std::wstring_view messages, const std::vector<std::size_t>& offsets) const {
+    return transformBatch(messages, offsets, false);
+}
+
+/**
+ * @brief Пакетное шифрование сообщений в кодировке UTF-8
+ * @param messages Сообщения в кодировке UTF-8, записанные подряд
+ * @param offsets Смещения сообщений в байтах
+ * @return Результаты и ошибки по сообщениям
+ * @throw table_cipher_error Если смещения некорректны
+ */
+BatchResult<char> TableCipher::encryptBatch(std::string_view messages, const std::vector<std::size_t>& offsets) const {
+    return transformBatch(messages, offsets, true);
+}
+
+/**
+ * @brief Пакетное дешифрование сообщений в кодировке UTF-8
+ * @param messages Сообщения в кодировке UTF-8, записанные подряд
+ * @param offsets Смещения сообщений в байтах
+ * @return Результаты и ошибки по сообщениям
+ * @throw table_cipher_error Если смещения некорректны
+ */
+BatchResult<char> TableCipher::decryptBatch(std::string_view messages, const std::vector<std::size_t>& offsets) const {
+    return transformBatch(messages, offsets, false);
+}
+
 /**
  * @brief Вспомогательная функция для отладки - вывод таблицы в консоль
  * @param table Таблица для вывода
@@ -1,9 +1,16 @@
 #pragma once
 #include <string>
+#include <string_view>
 #include <vector>
+#include <memory>
 #include <stdexcept>
 #include <locale>
-#include <codecvt>
+#include "../common/cipherBatch.h"
+#include "../common/cipherResult.h"
+#include "tablePlan.h"
+#include "tableFile.h"
+
+class ThreadPool;
 
 /**
  * @file
@@ -21,12 +28,30 @@
 class table_cipher_error : public std::exception {
 private:
     std::string message; ///< Сообщение об ошибке
+    CipherError err; ///< Код ошибки и позиция ошибочного символа
 public:
     /**
      * @brief Конструктор исключения
      * @param msg Сообщение об ошибке
+     * @param error Код ошибки и позиция ошибочного символа
+     */
+    explicit table_cipher_error(const std::string& msg, CipherError error = {}) : message(msg), err(error) {}
+    
+    /**
+     * @brief Код ошибки
+     * @return Код ошибки (CipherErrc::ok, если код не задан)
      */
-    explicit table_cipher_error(const std::string& msg) : message(msg) {}
+    CipherErrc code() const noexcept {
+        return err.code;
+    }
+    
+    /**
+     * @brief Описание ошибки
+     * @return Код ошибки и позиция ошибочного символа
+     */
+    const CipherError& error() const noexcept {
+        return err;
+    }
     
     /**
      * @brief Получить сообщение об ошибке
@@ -42,13 +67,50 @@ public:
  * @details Реализует шифрование методом табличной перестановки с заданным количеством столбцов.
  * Запись: по горизонтали слева направо, сверху вниз.
  * Чтение: сверху вниз, справа налево.
+ * Другие маршруты записи и чтения задаются методом setRoutes().
  * @warning Поддерживает только буквы и пробелы
  */
 class TableCipher {
 private:
     int numColumns; ///< Количество столбцов таблицы (ключ шифрования)
+    std::shared_ptr<TablePlanCache> plans; ///< Кэш планов перестановки (общий для копий объекта)
+    std::size_t fileBudget = defaultTableFileBudget; ///< Бюджет памяти для шифрования файлов, байт
+    std::shared_ptr<ThreadPool> pool; ///< Пул потоков параллельного режима (пустой - последовательный режим)
+    std::size_t parallelMinChunk = defaultParallelChunk; ///< Наименьший фрагмент текста на один поток
+    
+    /**
+     * @brief Проверка текста перед шифрованием или расшифрованием
+     * @param text Текст
+     * @param length Длина текста в символах
+     * @param encrypting true - шифрование, false - расшифрование
+     * @return Ошибка, если текст пустой, содержит недопустимые символы,
+     * короче ключа или не помещается в таблицу
+     */
+    CipherError checkText(const wchar_t* text, std::size_t length, bool encrypting) const;
+    
+    /**
+     * @brief Количество частей для параллельной обработки текста
+     * @param length Длина текста (символов или байт UTF-8)
+     * @return Количество частей; 1 означает последовательную обработку
+     */
+    std::size_t parallelParts(std::size_t length) const;
+    
+    /**
+     * @brief Пакетное шифрование или дешифрование
+     * @tparam Char wchar_t или char (UTF-8)
+     * @param messages Арена сообщений
+     * @param offsets Смещения сообщений в арене
+     * @param encrypting true - шифрование, false - дешифрование
+     * @return Результаты и ошибки по сообщениям
+     * @throw table_cipher_error Если смещения некорректны
+     */
+    template <class Char>
+    BatchResult<Char> transformBatch(std::basic_string_view<Char> messages, const std::vector<std::size_t>& offsets, bool encrypting) const;
 
 public:
+    /// Наименьший фрагмент текста на один поток по умолчанию (символов или байт UTF-8)
+    static constexpr std::size_t defaultParallelChunk = 1 << 20;
+    
     /**
      * @brief Конструктор с установкой ключа
      * @param key Количество столбцов таблицы
@@ -56,8 +118,40 @@ public:
      */
     TableCipher(int key);
     
+    /**
+     * @brief Создание шифра без исключений
+     * @param key Количество столбцов таблицы
+     * @return Шифр или ошибка ключа
+     */
+    static CipherResult<TableCipher> create(int key);
+    
+    /**
+     * @brief Проверка ключа без исключений
+     * @param key Ключ для проверки
+     * @return Ошибка ключа (код CipherErrc::ok, если ключ корректен)
+     */
+    static CipherError checkKey(int key);
+    
+    /**
+     * @brief Текст сообщения об ошибке
+     * @param code Код ошибки
+     * @param encrypting true - шифрование, false - дешифрование
+     * @return Сообщение об ошибке, совпадающее с текстом исключения table_cipher_error
+     */
+    static const char* errorMessage(CipherErrc code, bool encrypting);
+    
+    /**
+     * @brief Исключение для ошибки
+     * @param error Описание ошибки
+     * @param encrypting true - шифрование, false - дешифрование
+     * @return Исключение с сообщением и кодом ошибки
+     */
+    static table_cipher_error makeError(CipherError error, bool encrypting);
+    
     /**
      * @brief Метод шифрования текста
+     * @details Результат пишется в строку длины текста по вычисленным номерам символов,
+     * таблица в памяти не строится. Пробелы переставляются наравне с буквами
      * @param text Исходный текст для шифрования
      * @return Зашифрованная строка
      * @throw table_cipher_error Если текст пустой или содержит недопустимые символы
@@ -66,12 +160,264 @@ public:
     
     /**
      * @brief Метод дешифрования текста
+     * @details Обратная перестановка: decrypt(encrypt(text)) == text, включая пробелы
      * @param cipher_text Зашифрованный текст
      * @return Расшифрованная строка
      * @throw table_cipher_error Если текст пустой или содержит недопустимые символы
      */
     std::wstring decrypt(const std::wstring& cipher_text);
     
+    /**
+     * @brief Метод шифрования текста в кодировке UTF-8
+     * @details Текст переставляется без преобразования в широкую строку.
+     * Результат совпадает с шифрованием той же строки, переведенной в std::wstring
+     * @param text Исходный текст в кодировке UTF-8
+     * @return Зашифрованная строка в кодировке UTF-8
+     * @throw table_cipher_error Если текст пустой, содержит недопустимые символы
+     * или некорректные последовательности UTF-8
+     */
+    std::string encrypt(std::string_view text);
+    
+    /**
+     * @brief Метод дешифрования текста в кодировке UTF-8
+     * @param cipher_text Зашифрованный текст в кодировке UTF-8
+     * @return Расшифрованная строка в кодировке UTF-8
+     * @throw table_cipher_error Если текст пустой, содержит недопустимые символы
+     * или некорректные последовательности UTF-8
+     */
+    std::string decrypt(std::string_view cipher_text);
+    
+    /**
+     * @brief Шифрование текста без исключений
+     * @details Ошибки входных данных возвращаются кодом вместо исключения,
+     * что дешевле при частых некорректных записях
+     * @param text Исходный текст
+     * @return Зашифрованная строка или ошибка с позицией недопустимого символа
+     */
+    CipherResult<std::wstring> tryEncrypt(const std::wstring& text) const;
+    
+    /**
+     * @brief Дешифрование текста без исключений
+     * @param cipher_text Зашифрованный текст
+     * @return Расшифрованная строка или ошибка с позицией недопустимого символа
+     */
+    CipherResult<std::wstring> tryDecrypt(const std::wstring& cipher_text) const;
+    
+    /**
+     * @brief Шифрование текста UTF-8 без исключений
+     * @param text Исходный текст в кодировке UTF-8
+     * @return Зашифрованная строка или ошибка с позицией недопустимого символа в байтах
+     */
+    CipherResult<std::string> tryEncrypt(std::string_view text) const;
+    
+    /**
+     * @brief Дешифрование текста UTF-8 без исключений
+     * @param cipher_text Зашифрованный текст в кодировке UTF-8
+     * @return Расшифрованная строка или ошибка с позицией недопустимого символа в байтах;
+     * CipherErrc::tableTooLarge для текста длиннее UINT32_MAX байт с символами различной длины
+     */
+    CipherResult<std::string> tryDecrypt(std::string_view cipher_text) const;
+    
+    /**
+     * @brief Необходимый размер буфера результата
+     * @param length Длина текста в символах
+     * @return Количество символов, которого заведомо достаточно для результата
+     */
+    std::size_t requiredOutputSize(std::size_t length) const {
+        return length;
+    }
+    
+    /**
+     * @brief Настройка кэша планов перестановки
+     * @details Для текста не длиннее maxLength символов перестановка берется из кэша
+     * планов (см. TablePlan), построенных для пары (ключ, длина текста); при промахе
+     * план строится и вытесняет давно не использованный. Длинные тексты переставляются
+     * блочным ядром transposeRoute(). Копии объекта используют общий кэш.
+     * Новый кэш создается пустым, со сброшенной статистикой
+     * @param capacity Наибольшее количество планов; 0 - кэш отключен
+     * @param maxLength Наибольшая длина текста для плана, символов
+     */
+    void setPlanCache(std::size_t capacity, std::size_t maxLength = TablePlanCache::defaultMaxLength);
+    
+    /**
+     * @brief Статистика кэша планов
+     * @return Количество попаданий, промахов и планов в кэше
+     */
+    TablePlanStats planStats() const;
+    
+    /**
+     * @brief Установка маршрутов записи и чтения таблицы
+     * @details Пара маршрутов переводится в план перестановки (см. compileRoutes())
+     * один раз для каждой длины текста, и все маршруты переставляются одним циклом
+     * TablePlan::apply(): короткие тексты - планом из кэша, длинные - планом,
+     * построенным для одного вызова. Кэш планов создается заново с прежними
+     * настройками. Шифрование файлов поддерживает только маршруты по умолчанию;
+     * тексты длиннее maxRouteLength символов отвергаются с кодом CipherErrc::tableTooLarge
+     * @param routes Маршруты записи и чтения
+     * @throw table_cipher_error Если порядок столбцов маршрута RouteShape::keyColumns
+     * не является перестановкой столбцов таблицы
+     */
+    void setRoutes(const TableRoutes& routes);
+    
+    /**
+     * @brief Маршруты записи и чтения таблицы
+     * @return Текущие маршруты
+     */
+    const TableRoutes& routes() const {
+        return plans->routes();
+    }
+    
+    /**
+     * @brief Включение параллельного режима
+     * @details Тексты длиннее 2 * minChunkSize делятся на части: проверка символов
+     * выполняется по частям текста, перестановка - полосами строк таблицы. Полоса строк
+     * пишет в результат только свои отрезки столбцов, поэтому потоки пишут
+     * в общий буфер без синхронизации. Результат совпадает с последовательной
+     * обработкой. Копии объекта используют общий пул
+     * @param workers Количество потоков; 0 или 1 - последовательный режим
+     * @param minChunkSize Наименьший фрагмент текста (символов или байт UTF-8) на один поток
+     */
+    void setParallelism(std::size_t workers, std::size_t minChunkSize = defaultParallelChunk);
+    
+    /**
+     * @brief Установка бюджета памяти для шифрования файлов
+     * @param bytes Бюджет памяти в байтах (значения меньше minTableFileBudget увеличиваются до него)
+     */
+    void setMemoryBudget(std::size_t bytes) {
+        fileBudget = bytes;
+    }
+    
+    /**
+     * @brief Бюджет памяти для шифрования файлов
+     * @return Бюджет памяти в байтах
+     */
+    std::size_t memoryBudget() const {
+        return fileBudget;
+    }
+    
+    /**
+     * @brief Шифрование файла в файл
+     * @details Файл в кодировке UTF-8 обрабатывается полосами строк таблицы
+     * в пределах бюджета памяти (см. routeFile()), поэтому ограничение в 10000 строк
+     * не действует. Результат совпадает с encrypt() для содержимого файла
+     * @param input Путь к входному файлу
+     * @param output Путь к выходному файлу
+     * @return Количество записанных байт
+     * @throw table_cipher_error При некорректном содержимом файла, ошибке ввода-вывода
+     * или маршрутах, отличных от маршрутов по умолчанию
+     */
+    std::size_t encryptFile(const std::string& input, const std::string& output) const;
+    
+    /**
+     * @brief Дешифрование файла в файл
+     * @param input Путь к зашифрованному файлу
+     * @param output Путь к выходному файлу
+     * @return Количество записанных байт
+     * @throw table_cipher_error При некорректном содержимом файла или ошибке ввода-вывода
+     */
+    std::size_t decryptFile(const std::string& input, const std::string& output) const;
+    
+    /**
+     * @brief Шифрование файла в файл без исключений
+     * @param input Путь к входному файлу
+     * @param output Путь к выходному файлу
+     * @return Количество записанных байт или ошибка (для CipherErrc::ioError в offset - errno)
+     */
+    CipherResult<std::size_t> tryEncryptFile(const std::string& input, const std::string& output) const;
+    
+    /**
+     * @brief Дешифрование файла в файл без исключений
+     * @param input Путь к зашифрованному файлу
+     * @param output Путь к выходному файлу
+     * @return Количество записанных байт или ошибка (для CipherErrc::ioError в offset - errno)
+     */
+    CipherResult<std::size_t> tryDecryptFile(const std::string& input, const std::string& output) const;
+    
+    /**
+     * @brief Шифрование в буфер вызывающей стороны
+     * @details Сама таблица не строится: номер каждого символа берется из плана
+     * перестановки или вычисляется по строке и столбцу таблицы. Память в куче
+     * выделяется только при построении плана для новой длины текста
+     * @param text Исходный текст
+     * @param length Длина текста в символах
+     * @param out Буфер результата (не должен пересекаться с text)
+     * @param capacity Размер буфера, не меньше requiredOutputSize(length)
+     * @return Количество записанных символов
+     * @throw table_cipher_error При некорректных входных данных или слишком малом буфере
+     */
+    std::size_t encryptInto(const wchar_t* text, std::size_t length, wchar_t* out, std::size_t capacity) const;
+    
+    /**
+     * @brief Дешифрование в буфер вызывающей стороны
+     * @param cipher_text Зашифрованный текст
+     * @param length Длина текста в символах
+     * @param out Буфер результата (не должен пересекаться с cipher_text)
+     * @param capacity Размер буфера, не меньше requiredOutputSize(length)
+     * @return Количество записанных символов
+     * @throw table_cipher_error При некорректных входных данных или слишком малом буфере
+     */
+    std::size_t decryptInto(const wchar_t* cipher_text, std::size_t length, wchar_t* out, std::size_t capacity) const;
+    
+    /**
+     * @brief Шифрование в буфер вызывающей стороны без исключений
+     * @param text Исходный текст
+     * @param length Длина текста в символах
+     * @param out Буфер результата (не должен пересекаться с text)
+     * @param capacity Размер буфера, не меньше requiredOutputSize(length)
+     * @return Количество записанных символов или ошибка
+     */
+    CipherResult<std::size_t> tryEncryptInto(const wchar_t* text, std::size_t length, wchar_t* out, std::size_t capacity) const;
+    
+    /**
+     * @brief Дешифрование в буфер вызывающей стороны без исключений
+     * @param cipher_text Зашифрованный текст
+     * @param length Длина текста в символах
+     * @param out Буфер результата (не должен пересекаться с cipher_text)
+     * @param capacity Размер буфера, не меньше requiredOutputSize(length)
+     * @return Количество записанных символов или ошибка
+     */
+    CipherResult<std::size_t> tryDecryptInto(const wchar_t* cipher_text, std::size_t length, wchar_t* out, std::size_t capacity) const;
+    
+    /**
+     * @brief Пакетное шифрование сообщений
+     * @details Все сообщения шифруются одним ключом, результаты пишутся
+     * в одну заранее выделенную арену без выделения памяти на каждое сообщение.
+     * Ошибка в сообщении не прерывает пакет, ее код записывается в BatchResult::errors
+     * @param messages Сообщения, записанные подряд
+     * @param offsets Смещения сообщений: сообщение i занимает [offsets[i], offsets[i + 1])
+     * @return Результаты и ошибки по сообщениям
+     * @throw table_cipher_error Если смещения некорректны
+     */
+    BatchResult<wchar_t> encryptBatch(std::wstring_view messages, const std::vector<std::size_t>& offsets) const;
+    
+    /**
+     * @brief Пакетное дешифрование сообщений
+     * @param messages Сообщения, записанные подряд
+     * @param offsets Смещения сообщений: сообщение i занимает [offsets[i], offsets[i + 1])
+     * @return Результаты и ошибки по сообщениям
+     * @throw table_cipher_error Если смещения некорректны
+     */
+    BatchResult<wchar_t> decryptBatch(std::wstring_view messages, const std::vector<std::size_t>& offsets) const;
+    
+    /**
+     * @brief Пакетное шифрование сообщений в кодировке UTF-8
+     * @details Разметка сообщений на символы использует общий буфер для всего пакета
+     * @param messages Сообщения в кодировке UTF-8, записанные подряд
+     * @param offsets Смещения сообщений в байтах
+     * @return Результаты и ошибки по сообщениям
+     * @throw table_cipher_error Если смещения некорректны
+     */
+    BatchResult<char> encryptBatch(std::string_view messages, const std::vector<std::size_t>& offsets) const;
+    
+    /**
+     * @brief Пакетное дешифрование сообщений в кодировке UTF-8
+     * @param messages Сообщения в кодировке UTF-8, записанные подряд
+     * @param offsets Смещения сообщений в байтах
+     * @return Результаты и ошибки по сообщениям
+     * @throw table_cipher_error Если смещения некорректны
+     */
+    BatchResult<char> decryptBatch(std::string_view messages, const std::vector<std::size_t>& offsets) const;
+    
     /**
      * @brief Проверка корректности ключа
      * @param key Ключ для проверки
@@ -0,0 +1,506 @@
+/**
+ * @file tableFile.cpp
+ * @brief Реализация табличной перестановки файлов, не помещающихся в память
+ */
+
+#include "tableFile.h"
+#include <algorithm>
+#include <cerrno>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <cwctype>
+#include <string>
+#include <vector>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include "../common/mappedFile.h"
+#include "../common/utf8.h"
+#include "routeKernel.h"
+
+namespace {
+
+/// Шаг контрольных точек разметки входного файла (символов)
+constexpr std::size_t checkpointStep = 4096;
+
+/**
+ * @brief Временный файл результата
+ * @details Создается в каталоге выходного файла и заменяет его только после
+ * полной записи. Деструктор закрывает файл и удаляет его, если он не переименован,
+ * поэтому файл, уже существовавший по выходному пути, при ошибке не затрагивается
+ */
+struct OutputFile {
+    int fd = -1; ///< Дескриптор файла
+    std::string path; ///< Путь к временному файлу (пустой, если файл не создан)
+    bool complete = false; ///< Признак переименования в выходной файл
+
+    /**
+     * @brief Создание временного файла рядом с выходным
+     * @param target Путь к выходному файлу
+     * @return true при успехе
+     */
+    bool create(const std::string& target) {
+        std::string name = target + ".XXXXXX";
+        fd = mkstemp(name.data());
+        if (fd < 0) {
+            return false;
+        }
+        path = std::move(name);
+        // mkstemp создает файл с правами 0600; права обычного файла - 0644 с учетом umask
+        const mode_t mask = umask(0);
+        umask(mask);
+        return fchmod(fd, 0644 & ~mask) == 0;
+    }
+
+    /**
+     * @brief Закрытие и замена выходного файла временным
+     * @param target Путь к выходному файлу
+     * @return true при успехе; при ошибке errno содержит ее код
+     */
+    bool commit(const std::string& target) {
+        const int result = close(fd);
+        fd = -1;
+        if (result != 0 || rename(path.c_str(), target.c_str()) != 0) {
+            return false;
+        }
+        complete = true;
+        return true;
+    }
+
+    /**
+     * @brief Деструктор: закрытие и удаление незавершенного файла
+     */
+    ~OutputFile() {
+        const int savedErrno = errno;
+        if (fd >= 0) {
+            close(fd);
+        }
+        if (!path.empty() && !complete) {
+            unlink(path.c_str());
+        }
+        errno = savedErrno;
+    }
+};
+
+/**
+ * @brief Разметка входного файла, собранная при проверке
+ */
+struct FileLayout {
+    std::size_t length = 0; ///< Количество символов
+    std::size_t width = 0; ///< Длина всех символов в байтах или 0, если длины различаются
+    std::vector<std::size_t> columnBytes; ///< Размер каждого столбца таблицы в байтах
+    std::vector<std::size_t> checkpoints; ///< Смещение символа с номером i * checkpointStep
+};
+
+/**
+ * @brief Ошибка ввода-вывода с текущим значением errno
+ * @return Ошибка CipherErrc::ioError
+ */
+CipherError ioFailure() {
+    return {CipherErrc::ioError, static_cast<std::size_t>(errno)};
+}
+
+/**
+ * @brief Освобождение прочитанных страниц отображения
+ * @param data Начало отображения (выровнено на страницу)
+ * @param from Начало прочитанного участка в байтах
+ * @param to Конец прочитанного участка в байтах
+ * @details Освобождаются только страницы, целиком лежащие внутри участка
+ */
+void dropPages(const char* data, std::size_t from, std::size_t to) {
+    static const std::size_t page = static_cast<std::size_t>(sysconf(_SC_PAGESIZE));
+    from = (from + page - 1) / page * page;
+    to = to / page * page;
+    if (from < to) {
+        madvise(const_cast<char*>(data + from), to - from, MADV_DONTNEED);
+    }
+}
+
+/**
+ * @brief Запись участка буфера в файл по смещению
+ * @param fd Дескриптор файла
+ * @param data Данные
+ * @param length Длина данных в байтах
+ * @param offset Смещение в файле
+ * @return true при успехе
+ */
+bool writeAt(int fd, const char* data, std::size_t length, std::size_t offset) {
+    while (length > 0) {
+        const ssize_t written = pwrite(fd, data, length, static_cast<off_t>(offset));
+        if (written < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            return false;
+        }
+        data += written;
+        offset += static_cast<std::size_t>(written);
+        length -= static_cast<std::size_t>(written);
+    }
+    return true;
+}
+
+/**
+ * @brief Чтение участка файла по смещению
+ * @param fd Дескриптор файла
+ * @param data Буфер
+ * @param length Длина участка в байтах (участок лежит внутри файла)
+ * @param offset Смещение в файле
+ * @return true при успехе
+ */
+bool readAt(int fd, char* data, std::size_t length, std::size_t offset) {
+    while (length > 0) {
+        const ssize_t count = pread(fd, data, length, static_cast<off_t>(offset));
+        if (count < 0 && errno == EINTR) {
+            continue;
+        }
+        if (count <= 0) {
+            if (count == 0) {
+                errno = EIO;
+            }
+            return false;
+        }
+        data += count;
+        offset += static_cast<std::size_t>(count);
+        length -= static_cast<std::size_t>(count);
+    }
+    return true;
+}
+
+/**
+ * @brief Проверка входного файла и его разметка
+ * @param data Содержимое файла
+ * @param size Размер файла в байтах
+ * @param columns Количество столбцов таблицы
+ * @param window Объем прочитанных данных, после которого страницы освобождаются
+ * @param layout Разметка файла
+ * @return Ошибка CipherErrc::invalidSymbol с позицией в байтах, если файл содержит
+ * символы, отличные от букв и пробелов, или некорректные последовательности UTF-8
+ */
+CipherError scanFile(const char* data, std::size_t size, std::size_t columns, std::size_t window, FileLayout& layout) {
+    layout.columnBytes.assign(columns, 0);
+    const char* p = data;
+    const char* end = data + size;
+    std::size_t col = 0;
+    std::size_t width = 0;
+    bool uniform = true;
+    std::size_t dropped = 0;
+
+    while (p < end) {
+        const std::size_t start = static_cast<std::size_t>(p - data);
+        if (layout.length % checkpointStep == 0) {
+            layout.checkpoints.push_back(start);
+        }
+        char32_t c = utf8Decode(p, end);
+        if (c != U' ' && !std::iswalpha(static_cast<wint_t>(c))) {
+            return {CipherErrc::invalidSymbol, start};
+        }
+
+        const std::size_t charWidth = static_cast<std::size_t>(p - data) - start;
+        if (layout.length == 0) {
+            width = charWidth;
+        } else if (charWidth != width) {
+            uniform = false;
+        }
+        layout.columnBytes[col] += charWidth;
+        if (++col == columns) {
+            col = 0;
+        }
+        layout.length++;
+
+        if (start - dropped >= window) {
+            dropPages(data, dropped, start);
+            dropped = start;
+        }
+    }
+    layout.width = uniform ? width : 0;
+    return {};
+}
+
+/**
+ * @brief Длина символа UTF-8 в проверенном тексте
+ * @tparam Width Длина всех символов текста или 0, если длины различаются
+ * @param p Начало символа
+ * @return Длина символа в байтах
+ */
+template <std::size_t Width>
+std::size_t cellWidth(const char* p) {
+    return Width != 0 ? Width : utf8SequenceLength(static_cast<unsigned char>(*p));
+}
+
+/**
+ * @brief Шифрование проверенного файла полосами строк
+ * @tparam Width Длина всех символов текста или 0, если длины различаются
+ * @param route Маршрут по таблице
+ * @param layout Разметка входного файла
+ * @param inputFd Дескриптор входного файла
+ * @param inputSize Размер входного файла в байтах
+ * @param staging Буфер полосы: половина - строки текста, половина - отрезки столбцов
+ * @param stagingSize Размер половины буфера, не меньше восьми строк таблицы по 4 байта на символ
+ * @param fd Дескриптор выходного файла
+ * @return Ошибка чтения или записи
+ * @details Столбец col занимает в результате непрерывную область, начало которой
+ * известно по размерам столбцов правее него. Полоса целых строк читается в буфер,
+ * раскладывается по столбцам (справа налево), и отрезок каждого столбца
+ * дописывается в его область
+ */
+template <std::size_t Width>
+CipherError encryptBands(const ColumnRoute& route, const FileLayout& layout, int inputFd, std::size_t inputSize,
+                         char* staging, std::size_t stagingSize, int fd) {
+    const std::size_t columns = route.columns;
+    const std::size_t rowMax = columns * (Width != 0 ? Width : 4);
+    const char* band = staging;
+    char* segments = staging + stagingSize;
+    std::vector<std::size_t> filePos(columns);
+    std::vector<std::size_t> bandBytes(columns);
+    std::vector<std::size_t> cursor(columns);
+
+    std::size_t offset = 0;
+    for (std::size_t col = columns; col-- > 0;) {
+        filePos[col] = offset;
+        offset += layout.columnBytes[col];
+    }
+
+    std::size_t pos = 0;
+    for (std::size_t row0 = 0; row0 < route.rows;) {
+        if (!readAt(inputFd, staging, std::min(stagingSize, inputSize - pos), pos)) {
+            return ioFailure();
+        }
+
+        // Границы полосы и размеры отрезков столбцов в ней
+        std::fill(bandBytes.begin(), bandBytes.end(), 0);
+        std::size_t end = 0;
+        std::size_t row1 = row0;
+        while (row1 < route.rows && end + rowMax <= stagingSize) {
+            const std::size_t rowLength = (row1 == route.rows - 1) ? route.lastRowLength : columns;
+            for (std::size_t col = 0; col < rowLength; col++) {
+                const std::size_t width = cellWidth<Width>(band + end);
+                bandBytes[col] += width;
+                end += width;
+            }
+            row1++;
+        }
+
+        // Раскладка полосы по столбцам
+        offset = 0;
+        for (std::size_t col = columns; col-- > 0;) {
+            cursor[col] = offset;
+            offset += bandBytes[col];
+        }
+        const char* p = band;
+        for (std::size_t row = row0; row < row1; row++) {
+            const std::size_t rowLength = (row == route.rows - 1) ? route.lastRowLength : columns;
+            for (std::size_t col = 0; col < rowLength; col++) {
+                const std::size_t width = cellWidth<Width>(p);
+                std::memcpy(segments + cursor[col], p, width);
+                cursor[col] += width;
+                p += width;
+            }
+        }
+
+        for (std::size_t col = columns; col-- > 0;) {
+            if (bandBytes[col] == 0) {
+                continue;
+            }
+            if (!writeAt(fd, segments + cursor[col] - bandBytes[col], bandBytes[col], filePos[col])) {
+                return ioFailure();
+            }
+            filePos[col] += bandBytes[col];
+        }
+
+        pos += end;
+        row0 = row1;
+    }
+    return {};
+}
+
+/**
+ * @brief Расшифрование проверенного файла полосами строк
+ * @tparam Width Длина всех символов текста или 0, если длины различаются
+ * @param route Маршрут по таблице
+ * @param layout Разметка входного файла
+ * @param inputFd Дескриптор входного файла
+ * @param inputSize Размер входного файла в байтах
+ * @param staging Буфер полосы: половина - отрезки столбцов, половина - строки результата
+ * @param stagingSize Размер половины буфера, не меньше восьми строк таблицы по 4 байта на символ
+ * @param fd Дескриптор выходного файла
+ * @return Ошибка чтения или записи
+ * @details Начало каждого столбца в зашифрованном тексте находится по ближайшей
+ * контрольной точке разметки. Для полосы из bandRows строк отрезок каждого столбца
+ * читается в буфер (не больше bandRows символов наибольшей длины), строки собираются
+ * из отрезков и пишутся в результат подряд. Столбцы читаются через pread(), а не через
+ * отображение: обращение к отображению в тысяче мест сразу подгружает страницы
+ * кэша целыми блоками вокруг каждого места, и занятая память выходит за бюджет
+ */
+template <std::size_t Width>
+CipherError decryptBands(const ColumnRoute& route, const FileLayout& layout, int inputFd, std::size_t inputSize,
+                         char* staging, std::size_t stagingSize, int fd) {
+    const std::size_t columns = route.columns;
+    const std::size_t maxWidth = Width != 0 ? Width : 4;
+    const std::size_t bandRows = stagingSize / (columns * maxWidth);
+    char* segments = staging;
+    char* rows = staging + stagingSize;
+    std::vector<std::size_t> cursor(columns);
+    std::vector<const char*> next(columns);
+
+    for (std::size_t col = 0; col < columns; col++) {
+        const std::size_t index = route.start(col);
+        if (Width != 0) {
+            cursor[col] = index * Width;
+            continue;
+        }
+        // Переход от контрольной точки к началу столбца
+        std::size_t p = layout.checkpoints[index / checkpointStep];
+        const std::size_t skip = index % checkpointStep;
+        const std::size_t length = std::min(skip * maxWidth, inputSize - p);
+        if (!readAt(inputFd, segments, length, p)) {
+            return ioFailure();
+        }
+        const char* q = segments;
+        for (std::size_t i = 0; i < skip; i++) {
+            q += cellWidth<Width>(q);
+        }
+        cursor[col] = p + static_cast<std::size_t>(q - segments);
+    }
+
+    std::size_t filePos = 0;
+    for (std::size_t row0 = 0; row0 < route.rows; row0 += bandRows) {
+        const std::size_t row1 = std::min(row0 + bandRows, route.rows);
+        for (std::size_t col = 0; col < columns; col++) {
+            const std::size_t height = std::min(row1, route.height(col)) - row0;
+            const std::size_t length = std::min(height * maxWidth, inputSize - cursor[col]);
+            char* segment = segments + col * bandRows * maxWidth;
+            if (!readAt(inputFd, segment, length, cursor[col])) {
+                return ioFailure();
+            }
+            next[col] = segment;
+        }
+
+        std::size_t size = 0;
+        for (std::size_t row = row0; row < row1; row++) {
+            const std::size_t rowLength = (row == route.rows - 1) ? route.lastRowLength : columns;
+            for (std::size_t col = 0; col < rowLength; col++) {
+                const std::size_t width = cellWidth<Width>(next[col]);
+                std::memcpy(rows + size, next[col], width);
+                next[col] += width;
+                size += width;
+            }
+        }
+
+        for (std::size_t col = 0; col < columns; col++) {
+            cursor[col] += static_cast<std::size_t>(next[col] - (segments + col * bandRows * maxWidth));
+        }
+        if (!writeAt(fd, rows, size, filePos)) {
+            return ioFailure();
+        }
+        filePos += size;
+    }
+    return {};
+}
+
+/**
+ * @brief Перестановка проверенного файла полосами строк
+ * @tparam Width Длина всех символов текста или 0, если длины различаются
+ * @param in Входной файл
+ * @param route Маршрут по таблице
+ * @param layout Разметка входного файла
+ * @param staging Буфер полосы из двух половин
+ * @param stagingSize Размер половины буфера
+ * @param fd Дескриптор выходного файла
+ * @param encrypting true - шифрование, false - расшифрование
+ * @return Ошибка чтения или записи
+ */
+template <std::size_t Width>
+CipherError transposeBands(const MappedFile& in, const ColumnRoute& route, const FileLayout& layout,
+                           char* staging, std::size_t stagingSize, int fd, bool encrypting) {
+    return encrypting ? encryptBands<Width>(route, layout, in.fd, in.size, staging, stagingSize, fd)
+                      : decryptBands<Width>(route, layout, in.fd, in.size, staging, stagingSize, fd);
+}
+
+} // namespace
+
+/**
+ * @brief Шифрование или расшифрование файла табличной перестановкой
+ * @param numColumns Количество столбцов таблицы
+ * @param input Путь к входному файлу
+ * @param output Путь к выходному файлу
+ * @param encrypting true - шифрование, false - расшифрование
+ * @param memoryBudget Бюджет памяти в байтах
+ * @return Количество записанных байт или ошибка
+ * @details Выходной путь сравнивается с входным файлом по устройству и номеру
+ * узла, чтобы не испортить отображенный входной файл. Результат пишется
+ * во временный файл рядом с выходным и переименовывается в выходной только
+ * после полной записи.
+ * Символы копируются без перекодирования; если все символы одной длины,
+ * длина символа не определяется по его первому байту
+ */
+CipherResult<std::size_t> routeFile(int numColumns, const std::string& input, const std::string& output,
+                                    bool encrypting, std::size_t memoryBudget) {
+    if (numColumns <= 0) {
+        return CipherErrc::keyNotPositive;
+    }
+    const std::size_t columns = static_cast<std::size_t>(numColumns);
+    const std::size_t budget = std::max({memoryBudget, minTableFileBudget, 16 * columns * 4});
+    const std::size_t stagingSize = budget / 2;
+
+    MappedFile in;
+    struct stat inputInfo;
+    if (!in.openForReading(input.c_str(), inputInfo)) {
+        return ioFailure();
+    }
+    if (in.size == 0) {
+        return CipherErrc::emptyText;
+    }
+
+    FileLayout layout;
+    CipherError error = scanFile(in.data, in.size, columns, stagingSize, layout);
+    if (error) {
+        return error;
+    }
+    if (columns > layout.length) {
+        return CipherErrc::keyLongerThanText;
+    }
+
+    struct stat outputInfo;
+    if (stat(output.c_str(), &outputInfo) == 0 &&
+        outputInfo.st_dev == inputInfo.st_dev && outputInfo.st_ino == inputInfo.st_ino) {
+        return CipherErrc::inPlaceUnsupported;
+    }
+    OutputFile out;
+    if (!out.create(output) || ftruncate(out.fd, static_cast<off_t>(in.size)) != 0) {
+        return ioFailure();
+    }
+
+    // Полосы читаются через pread(), отображение больше не нужно
+    dropPages(in.data, 0, in.size);
+
+    const ColumnRoute route = tableRoute(columns, layout.length);
+
+    std::vector<char> staging(2 * stagingSize);
+    switch (layout.width) {
+        case 1:
+            error = transposeBands<1>(in, route, layout, staging.data(), stagingSize, out.fd, encrypting);
+            break;
+        case 2:
+            error = transposeBands<2>(in, route, layout, staging.data(), stagingSize, out.fd, encrypting);
+            break;
+        case 3:
+            error = transposeBands<3>(in, route, layout, staging.data(), stagingSize, out.fd, encrypting);
+            break;
+        case 4:
+            error = transposeBands<4>(in, route, layout, staging.data(), stagingSize, out.fd, encrypting);
+            break;
+        default:
+            error = transposeBands<0>(in, route, layout, staging.data(), stagingSize, out.fd, encrypting);
+            break;
+    }
+    if (error) {
+        return error;
+    }
+    if (!out.commit(output)) {
+        return ioFailure();
+    }
+    return in.size;
+}
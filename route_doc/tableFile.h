@@ -0,0 +1,43 @@
+#pragma once
+#include <cstddef>
+#include <string>
+#include "../common/cipherResult.h"
+
+/**
+ * @file
+ * @author Ганьшин В.А.
+ * @version 1.0
+ * @date 17.12.2025
+ * @brief Табличная перестановка файлов, не помещающихся в память
+ * @details Входной файл в кодировке UTF-8 отображается в память и проверяется
+ * одним последовательным проходом. Затем таблица обрабатывается полосами строк:
+ * при шифровании полоса текста раскладывается в буфере по столбцам и каждый
+ * столбец дописывается в свою область выходного файла, при расшифровании
+ * отрезки всех столбцов полосы читаются из зашифрованного файла, каждый со своей
+ * позиции, и из них собираются строки. Полосы читаются в буфер, размер которого
+ * определяется бюджетом памяти; страницы отображения освобождаются по мере проверки.
+ * Количество строк таблицы не ограничено, результат совпадает с TableCipher::encrypt()
+ * и TableCipher::decrypt() для той же строки.
+ */
+
+/// Бюджет памяти по умолчанию (байт): половина - прочитанная полоса входного файла, половина - результат полосы
+constexpr std::size_t defaultTableFileBudget = std::size_t(64) << 20;
+
+/// Наименьший бюджет памяти (байт); меньшие значения увеличиваются до него
+constexpr std::size_t minTableFileBudget = std::size_t(1) << 20;
+
+/**
+ * @brief Шифрование или расшифрование файла табличной перестановкой
+ * @param numColumns Количество столбцов таблицы (1 .. 1000)
+ * @param input Путь к входному файлу (UTF-8, только буквы и пробелы)
+ * @param output Путь к выходному файлу; заменяется результатом только после его полной
+ * записи (через временный файл в том же каталоге), при ошибке остается нетронутым
+ * @param encrypting true - шифрование, false - расшифрование
+ * @param memoryBudget Бюджет памяти в байтах (не меньше minTableFileBudget
+ * и восьми строк таблицы по 4 байта на символ)
+ * @return Количество записанных байт (равно размеру входного файла) или ошибка:
+ * CipherErrc::invalidSymbol с позицией в байтах, CipherErrc::ioError с errno в offset,
+ * CipherErrc::inPlaceUnsupported, если входной и выходной файлы совпадают
+ */
+CipherResult<std::size_t> routeFile(int numColumns, const std::string& input, const std::string& output,
+                                    bool encrypting, std::size_t memoryBudget);
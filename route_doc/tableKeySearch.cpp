@@ -0,0 +1,330 @@
+/**
+ * @file tableKeySearch.cpp
+ * @brief Реализация подбора ключа табличной перестановки
+ */
+
+#include "tableKeySearch.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cwctype>
+#include <utility>
+#include "tableCipher.h"
+#include "routeKernel.h"
+#include "../common/utf8.h"
+#include "../common/threadPool.h"
+
+namespace {
+
+/**
+ * @brief Допустимый символ шифротекста TableCipher
+ * @param c Код символа
+ * @return true для букв и пробела
+ */
+bool isTableSymbol(char32_t c) {
+    return c == U' ' || std::iswalpha(static_cast<wint_t>(c));
+}
+
+/**
+ * @brief Средняя оценка биграмм выборки из расшифровки
+ * @details Символ открытого текста с номером row * columns + col стоит
+ * в шифротексте на позиции route.start(col) + row. Половина выборки - пары
+ * начала текста, половина - пары на переносах строк таблицы (последний символ
+ * строки и первый символ следующей). Переносы нужны для таблиц из нескольких
+ * строк: у соседних ключей с тем же количеством строк столбцы шифротекста
+ * лишь сдвинуты, и внутри строки расшифровка остается связным текстом
+ * @param text Классы символов шифротекста
+ * @param route Маршрут ключа
+ * @param sample Количество оцениваемых пар
+ * @param model Модель языка
+ * @return Средняя оценка пар выборки
+ */
+double sampleScore(const unsigned char* text, const ColumnRoute& route, std::size_t sample, const BigramModel& model) {
+    const std::size_t length = (route.rows - 1) * route.columns + route.lastRowLength;
+    auto at = [&](std::size_t i) {
+        return text[route.start(i % route.columns) + i / route.columns];
+    };
+    double sum = 0;
+    std::size_t pairs = 0;
+    for (std::size_t i = 1; i <= sample / 2 && i < length; i++, pairs++) {
+        sum += model.score(at(i - 1), at(i));
+    }
+    for (std::size_t i = route.columns; i < length && pairs < sample; i += route.columns, pairs++) {
+        sum += model.score(at(i - 1), at(i));
+    }
+    return pairs > 0 ? sum / static_cast<double>(pairs) : 0;
+}
+
+/**
+ * @brief Средняя оценка биграмм текста
+ * @param text Классы символов
+ * @param length Длина текста
+ * @param model Модель языка
+ * @return Средняя оценка пар соседних символов
+ */
+double textScore(const unsigned char* text, std::size_t length, const BigramModel& model) {
+    double sum = 0;
+    for (std::size_t i = 1; i < length; i++) {
+        sum += model.score(text[i - 1], text[i]);
+    }
+    return length > 1 ? sum / static_cast<double>(length - 1) : 0;
+}
+
+/**
+ * @brief Выполнение заданий в пуле или последовательно
+ * @param pool Пул потоков или nullptr
+ * @param count Количество заданий
+ * @param job Задание с номером 0 .. count - 1
+ */
+template <class Job>
+void runJobs(ThreadPool* pool, std::size_t count, Job&& job) {
+    if (pool && count > 1) {
+        pool->run(count, job);
+    } else {
+        for (std::size_t i = 0; i < count; i++) {
+            job(i);
+        }
+    }
+}
+
+/**
+ * @brief Значение результата или исключение с его ошибкой
+ * @param result Результат операции
+ * @return Значение результата
+ * @throw table_cipher_error Если результат содержит ошибку
+ */
+std::vector<KeyCandidate> valueOrThrow(CipherResult<std::vector<KeyCandidate>>&& result) {
+    if (!result) {
+        throw TableCipher::makeError(result.error(), false);
+    }
+    return std::move(*result);
+}
+
+} // namespace
+
+/**
+ * @brief Обучение модели
+ * @param corpus Обучающий текст на языке открытого текста
+ * @return Модель с биграммами обучающего текста
+ * @details Классы выдаются буквам в порядке первого появления; когда классы
+ * заканчиваются, новые буквы попадают в класс неизвестных
+ */
+BigramModel BigramModel::train(std::wstring_view corpus) {
+    BigramModel model;
+    model.classes.resize(classCodeRange);
+    for (std::size_t c = 0; c < classCodeRange; c++) {
+        model.classes[c] = std::iswalpha(static_cast<wint_t>(c)) ? unknownClass : spaceClass;
+    }
+
+    std::vector<std::uint64_t> pairs(maxClasses * maxClasses, 0);
+    unsigned char previous = spaceClass;
+    bool started = false;
+    for (wchar_t ch : corpus) {
+        unsigned char current = model.classOf(static_cast<char32_t>(ch));
+        if (current == unknownClass && model.count < maxClasses && static_cast<std::size_t>(ch) < classCodeRange) {
+            current = static_cast<unsigned char>(model.count++);
+            const wint_t lower = std::towlower(static_cast<wint_t>(ch));
+            const wint_t upper = std::towupper(static_cast<wint_t>(ch));
+            model.classes[static_cast<std::size_t>(ch)] = current;
+            if (lower < classCodeRange) {
+                model.classes[lower] = current;
+            }
+            if (upper < classCodeRange) {
+                model.classes[upper] = current;
+            }
+        }
+        if (started) {
+            pairs[previous * maxClasses + current]++;
+        }
+        previous = current;
+        started = true;
+    }
+
+    const std::size_t n = model.count;
+    model.logProb.resize(n * n);
+    for (std::size_t a = 0; a < n; a++) {
+        std::uint64_t total = 0;
+        for (std::size_t b = 0; b < n; b++) {
+            total += pairs[a * maxClasses + b];
+        }
+        for (std::size_t b = 0; b < n; b++) {
+            const double p = (static_cast<double>(pairs[a * maxClasses + b]) + 1) / (static_cast<double>(total) + n);
+            model.logProb[a * n + b] = static_cast<float>(std::log(p));
+        }
+    }
+    return model;
+}
+
+/**
+ * @brief Обучение модели по тексту в кодировке UTF-8
+ * @param corpus Обучающий текст в кодировке UTF-8
+ * @return Модель с биграммами обучающего текста
+ */
+BigramModel BigramModel::train(std::string_view corpus) {
+    std::wstring text;
+    text.reserve(corpus.size());
+    const char* p = corpus.data();
+    const char* end = p + corpus.size();
+    while (p < end) {
+        const char32_t c = utf8Decode(p, end);
+        if (c == utf8Invalid) {
+            ++p;
+            continue;
+        }
+        text.push_back(static_cast<wchar_t>(c));
+    }
+    return train(std::wstring_view(text));
+}
+
+/**
+ * @brief Класс символа
+ * @param c Код символа
+ * @return Номер класса
+ */
+unsigned char BigramModel::classOf(char32_t c) const {
+    if (c < classes.size()) {
+        return classes[c];
+    }
+    return std::iswalpha(static_cast<wint_t>(c)) ? unknownClass : spaceClass;
+}
+
+/**
+ * @brief Конструктор
+ * @param languageModel Модель языка открытого текста
+ */
+TableKeySearch::TableKeySearch(BigramModel languageModel) : model(std::move(languageModel)) {}
+
+/**
+ * @brief Включение параллельного режима
+ * @param workers Количество потоков; 0 или 1 - последовательный режим
+ */
+void TableKeySearch::setParallelism(std::size_t workers) {
+    pool = (workers > 1) ? std::make_shared<ThreadPool>(workers) : nullptr;
+}
+
+/**
+ * @brief Подбор ключа по классам символов шифротекста
+ * @param text Классы символов шифротекста
+ * @param top Количество возвращаемых кандидатов
+ * @return Кандидаты по убыванию оценки
+ * @details Первый этап делит диапазон ключей на равные отрезки по потокам
+ * (стоимость оценки выборки почти не зависит от ключа), второй - раздает потокам
+ * полные расшифровки отобранных кандидатов
+ */
+std::vector<KeyCandidate> TableKeySearch::rank(const std::vector<unsigned char>& text, std::size_t top) const {
+    const std::size_t length = text.size();
+    int maxKey = 0;
+    while (!TableCipher::checkKey(maxKey + 1) && static_cast<std::size_t>(maxKey + 1) <= length) {
+        maxKey++;
+    }
+    if (top == 0 || maxKey == 0) {
+        return {};
+    }
+
+    // Этап 1: оценка выборки из расшифровки для всех ключей
+    std::vector<KeyCandidate> candidates(static_cast<std::size_t>(maxKey));
+    const std::size_t parts = pool ? std::min(pool->size(), candidates.size()) : 1;
+    runJobs(pool.get(), parts, [&](std::size_t part) {
+        const std::size_t begin = candidates.size() * part / parts;
+        const std::size_t end = candidates.size() * (part + 1) / parts;
+        for (std::size_t i = begin; i < end; i++) {
+            const int key = static_cast<int>(i) + 1;
+            candidates[i].key = key;
+            candidates[i].sampleScore = sampleScore(text.data(), tableRoute(key, length), sampleChars, model);
+        }
+    });
+
+    // Этап 2: полная расшифровка лучших кандидатов
+    // (короткий текст расшифровывается полностью для всех ключей)
+    std::size_t shortlist = std::min(candidates.size(), std::max(shortlistSize, top * 4));
+    if (length * candidates.size() <= exhaustiveCells) {
+        shortlist = candidates.size();
+    }
+    std::partial_sort(candidates.begin(), candidates.begin() + shortlist, candidates.end(),
+                      [](const KeyCandidate& a, const KeyCandidate& b) {
+                          return a.sampleScore > b.sampleScore || (a.sampleScore == b.sampleScore && a.key < b.key);
+                      });
+    candidates.resize(shortlist);
+    runJobs(pool.get(), shortlist, [&](std::size_t i) {
+        std::vector<unsigned char> plain(length);
+        transposeRoute(text.data(), plain.data(), 1, tableRoute(candidates[i].key, length), false);
+        candidates[i].score = textScore(plain.data(), length, model);
+    });
+
+    std::sort(candidates.begin(), candidates.end(), [](const KeyCandidate& a, const KeyCandidate& b) {
+        return a.score > b.score || (a.score == b.score && a.key < b.key);
+    });
+    if (candidates.size() > top) {
+        candidates.resize(top);
+    }
+    return candidates;
+}
+
+/**
+ * @brief Подбор ключа
+ * @param cipher_text Шифротекст
+ * @param top Количество возвращаемых кандидатов
+ * @return Не более top кандидатов по убыванию оценки
+ * @throw table_cipher_error Если текст пустой или содержит недопустимые символы
+ */
+std::vector<KeyCandidate> TableKeySearch::search(const std::wstring& cipher_text, std::size_t top) const {
+    return valueOrThrow(trySearch(cipher_text, top));
+}
+
+/**
+ * @brief Подбор ключа по шифротексту в кодировке UTF-8
+ * @param cipher_text Шифротекст в кодировке UTF-8
+ * @param top Количество возвращаемых кандидатов
+ * @return Не более top кандидатов по убыванию оценки
+ * @throw table_cipher_error Если текст пустой или содержит недопустимые символы
+ */
+std::vector<KeyCandidate> TableKeySearch::search(std::string_view cipher_text, std::size_t top) const {
+    return valueOrThrow(trySearch(cipher_text, top));
+}
+
+/**
+ * @brief Подбор ключа без исключений
+ * @param cipher_text Шифротекст
+ * @param top Количество возвращаемых кандидатов
+ * @return Кандидаты или ошибка с позицией недопустимого символа
+ */
+CipherResult<std::vector<KeyCandidate>> TableKeySearch::trySearch(const std::wstring& cipher_text, std::size_t top) const {
+    if (cipher_text.empty()) {
+        return CipherErrc::emptyText;
+    }
+    std::vector<unsigned char> text(cipher_text.size());
+    for (std::size_t i = 0; i < cipher_text.size(); i++) {
+        const char32_t c = static_cast<char32_t>(cipher_text[i]);
+        if (!isTableSymbol(c)) {
+            return CipherResult<std::vector<KeyCandidate>>(CipherErrc::invalidSymbol, i);
+        }
+        text[i] = model.classOf(c);
+    }
+    return rank(text, top);
+}
+
+/**
+ * @brief Подбор ключа по шифротексту UTF-8 без исключений
+ * @param cipher_text Шифротекст в кодировке UTF-8
+ * @param top Количество возвращаемых кандидатов
+ * @return Кандидаты или ошибка с позицией недопустимого символа в байтах
+ */
+CipherResult<std::vector<KeyCandidate>> TableKeySearch::trySearch(std::string_view cipher_text, std::size_t top) const {
+    if (cipher_text.empty()) {
+        return CipherErrc::emptyText;
+    }
+    std::vector<unsigned char> text;
+    text.reserve(cipher_text.size());
+    const char* begin = cipher_text.data();
+    const char* end = begin + cipher_text.size();
+    const char* p = begin;
+    while (p < end) {
+        const char* at = p;
+        const char32_t c = utf8Decode(p, end);
+        if (c == utf8Invalid || !isTableSymbol(c)) {
+            return CipherResult<std::vector<KeyCandidate>>(CipherErrc::invalidSymbol, static_cast<std::size_t>(at - begin));
+        }
+        text.push_back(model.classOf(c));
+    }
+    return rank(text, top);
+}
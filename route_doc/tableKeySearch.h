@@ -0,0 +1,207 @@
+#pragma once
+#include <cstddef>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+#include "../common/cipherResult.h"
+
+class ThreadPool;
+
+/**
+ * @file
+ * @author Ганьшин В.А.
+ * @version 1.0
+ * @date 17.12.2025
+ * @brief Подбор ключа табличной перестановки по шифротексту
+ * @details Перестановка не меняет частоты символов, поэтому кандидаты различаются
+ * только порядком символов и оцениваются биграммной моделью языка. Для каждого
+ * количества столбцов оценивается лишь выборка пар символов расшифровки (начало
+ * текста и переносы строк таблицы): символ открытого текста i берется прямо
+ * из шифротекста по формуле маршрута, без построения таблицы.
+ * Полностью (блочным ядром transposeRoute()) расшифровываются лишь лучшие кандидаты.
+ * Символы заранее переводятся в однобайтовые классы модели, так что оба прохода
+ * работают с массивом байтов вместо широкой строки.
+ */
+
+/**
+ * @brief Биграммная модель языка
+ * @details Символ переводится в класс: буквы (без учета регистра), встретившиеся
+ * в обучающем тексте, получают собственные классы, пробел и все символы, не
+ * являющиеся буквами, - класс пробела, остальные буквы - общий класс неизвестных.
+ * Оценка пары классов - логарифм условной вероятности второго символа после
+ * первого со сглаживанием Лапласа
+ */
+class BigramModel {
+private:
+    std::vector<unsigned char> classes; ///< Класс символа по коду (для кодов до classCodeRange)
+    std::size_t count = 2; ///< Количество классов
+    std::vector<float> logProb; ///< Оценки пар классов, count × count
+
+    BigramModel() = default;
+
+public:
+    /// Класс пробела и символов, не являющихся буквами
+    static constexpr unsigned char spaceClass = 0;
+
+    /// Класс букв, не встретившихся в обучающем тексте
+    static constexpr unsigned char unknownClass = 1;
+
+    /// Граница кодов символов, различаемых моделью (латиница, кириллица, греческий алфавит)
+    static constexpr std::size_t classCodeRange = 0x800;
+
+    /// Наибольшее количество классов
+    static constexpr std::size_t maxClasses = 256;
+
+    /**
+     * @brief Обучение модели
+     * @param corpus Обучающий текст на языке открытого текста
+     * @return Модель с биграммами обучающего текста
+     */
+    static BigramModel train(std::wstring_view corpus);
+
+    /**
+     * @brief Обучение модели по тексту в кодировке UTF-8
+     * @param corpus Обучающий текст в кодировке UTF-8 (некорректные последовательности пропускаются)
+     * @return Модель с биграммами обучающего текста
+     */
+    static BigramModel train(std::string_view corpus);
+
+    /**
+     * @brief Класс символа
+     * @param c Код символа
+     * @return Номер класса (меньше classCount())
+     */
+    unsigned char classOf(char32_t c) const;
+
+    /**
+     * @brief Количество классов
+     * @return Количество классов модели
+     */
+    std::size_t classCount() const {
+        return count;
+    }
+
+    /**
+     * @brief Оценка пары символов
+     * @param first Класс первого символа
+     * @param second Класс второго символа
+     * @return Логарифм вероятности second после first
+     */
+    float score(unsigned char first, unsigned char second) const {
+        return logProb[first * count + second];
+    }
+};
+
+/**
+ * @brief Кандидат в ключи
+ */
+struct KeyCandidate {
+    int key = 0; ///< Количество столбцов таблицы
+    double sampleScore = 0; ///< Средняя оценка биграмм выборки из расшифровки
+    double score = 0; ///< Средняя оценка биграмм всей расшифровки (больше - правдоподобнее)
+};
+
+/**
+ * @brief Подбор ключа табличной перестановки
+ * @details Перебираются все ключи TableCipher (1 .. 1000, но не длиннее текста),
+ * маршрут - маршрут TableCipher по умолчанию. Поиск выполняется в два этапа:
+ * 1. Для каждого ключа оцениваются sampleLength пар символов расшифровки:
+ *    половина - из начала текста, половина - на переносах строк таблицы.
+ * 2. Лучшие по первому этапу кандидаты (не меньше shortlistSize и в четыре раза
+ *    больше запрошенного количества) расшифровываются полностью и ранжируются
+ *    по оценке всего текста.
+ *
+ * Если ключи дают таблицы из нескольких строк, у соседних ключей с тем же
+ * количеством строк расшифровки совпадают везде, кроме переносов строк, и выборка
+ * их почти не различает. Поэтому текст, для которого полная расшифровка всех
+ * ключей не превышает exhaustiveCells символов, сразу оценивается целиком.
+ *
+ * Оба этапа в параллельном режиме распределяются между потоками пула.
+ *
+ * Пример использования:
+ * @code
+ * TableKeySearch search(BigramModel::train(corpus));
+ * search.setParallelism(8);
+ * std::vector<KeyCandidate> best = search.search(cipher_text, 5);
+ * TableCipher cipher(best.front().key);
+ * @endcode
+ */
+class TableKeySearch {
+private:
+    BigramModel model; ///< Модель языка открытого текста
+    std::size_t sampleChars = defaultSampleLength; ///< Количество оцениваемых пар символов на первом этапе
+    std::shared_ptr<ThreadPool> pool; ///< Пул потоков параллельного режима (пустой - последовательный режим)
+
+    /**
+     * @brief Подбор ключа по классам символов шифротекста
+     * @param text Классы символов шифротекста
+     * @param top Количество возвращаемых кандидатов
+     * @return Кандидаты по убыванию оценки
+     */
+    std::vector<KeyCandidate> rank(const std::vector<unsigned char>& text, std::size_t top) const;
+
+public:
+    /// Количество оцениваемых пар символов на первом этапе по умолчанию
+    static constexpr std::size_t defaultSampleLength = 512;
+
+    /// Наименьшее количество кандидатов, расшифровываемых полностью
+    static constexpr std::size_t shortlistSize = 16;
+
+    /// Наибольший суммарный объем расшифровок (символов), при котором все ключи оцениваются полным текстом
+    static constexpr std::size_t exhaustiveCells = std::size_t(1) << 24;
+
+    /**
+     * @brief Конструктор
+     * @param languageModel Модель языка открытого текста
+     */
+    explicit TableKeySearch(BigramModel languageModel);
+
+    /**
+     * @brief Включение параллельного режима
+     * @param workers Количество потоков; 0 или 1 - последовательный режим
+     */
+    void setParallelism(std::size_t workers);
+
+    /**
+     * @brief Установка размера выборки первого этапа
+     * @param pairs Количество оцениваемых пар символов (не меньше 2)
+     */
+    void setSampleLength(std::size_t pairs) {
+        sampleChars = (pairs > 2) ? pairs : 2;
+    }
+
+    /**
+     * @brief Подбор ключа
+     * @param cipher_text Шифротекст
+     * @param top Количество возвращаемых кандидатов
+     * @return Не более top кандидатов по убыванию оценки
+     * @throw table_cipher_error Если текст пустой или содержит недопустимые символы
+     */
+    std::vector<KeyCandidate> search(const std::wstring& cipher_text, std::size_t top = 1) const;
+
+    /**
+     * @brief Подбор ключа по шифротексту в кодировке UTF-8
+     * @param cipher_text Шифротекст в кодировке UTF-8
+     * @param top Количество возвращаемых кандидатов
+     * @return Не более top кандидатов по убыванию оценки
+     * @throw table_cipher_error Если текст пустой или содержит недопустимые символы
+     */
+    std::vector<KeyCandidate> search(std::string_view cipher_text, std::size_t top = 1) const;
+
+    /**
+     * @brief Подбор ключа без исключений
+     * @param cipher_text Шифротекст
+     * @param top Количество возвращаемых кандидатов
+     * @return Кандидаты или ошибка с позицией недопустимого символа
+     */
+    CipherResult<std::vector<KeyCandidate>> trySearch(const std::wstring& cipher_text, std::size_t top = 1) const;
+
+    /**
+     * @brief Подбор ключа по шифротексту UTF-8 без исключений
+     * @param cipher_text Шифротекст в кодировке UTF-8
+     * @param top Количество возвращаемых кандидатов
+     * @return Кандидаты или ошибка с позицией недопустимого символа в байтах
+     */
+    CipherResult<std::vector<KeyCandidate>> trySearch(std::string_view cipher_text, std::size_t top = 1) const;
+};
@@ -0,0 +1,155 @@
+/**
+ * @file tablePlan.cpp
+ * @brief Реализация планов табличной перестановки и их кэша
+ */
+
+#include "tablePlan.h"
+#include <algorithm>
+#include <cstring>
+#include <utility>
+
+namespace {
+
+/**
+ * @brief Перестановка символов фиксированной длины по массиву номеров
+ * @tparam Bytes Длина символа в байтах
+ * @param in Исходные символы
+ * @param out Буфер результата
+ * @param index Номер символа текста для каждой позиции шифротекста
+ * @param begin Первая обрабатываемая позиция шифротекста
+ * @param end Позиция шифротекста за последней обрабатываемой
+ * @param encrypting true - сбор по номерам, false - раскладка по номерам
+ */
+template <std::size_t Bytes>
+void permute(const unsigned char* in, unsigned char* out, const std::uint32_t* index, std::size_t begin,
+             std::size_t end, bool encrypting) {
+    if (encrypting) {
+        for (std::size_t i = begin; i < end; i++) {
+            std::memcpy(out + i * Bytes, in + static_cast<std::size_t>(index[i]) * Bytes, Bytes);
+        }
+    } else {
+        for (std::size_t i = begin; i < end; i++) {
+            std::memcpy(out + static_cast<std::size_t>(index[i]) * Bytes, in + i * Bytes, Bytes);
+        }
+    }
+}
+
+} // namespace
+
+/**
+ * @brief Построение плана
+ * @param numColumns Количество столбцов таблицы
+ * @param length Длина текста в символах
+ * @details Столбцы перебираются справа налево, в каждом столбце - строки сверху вниз,
+ * так же, как при шифровании
+ */
+TablePlan::TablePlan(int numColumns, std::size_t length) : numColumns(numColumns), index(length) {
+    const std::size_t columns = static_cast<std::size_t>(numColumns);
+    std::size_t pos = 0;
+    for (std::size_t col = columns; col-- > 0;) {
+        for (std::size_t cell = col; cell < length; cell += columns) {
+            index[pos++] = static_cast<std::uint32_t>(cell);
+        }
+    }
+}
+
+/**
+ * @brief Построение плана для пары маршрутов
+ * @param numColumns Количество столбцов таблицы
+ * @param length Длина текста в символах
+ * @param routes Маршруты записи и чтения
+ */
+TablePlan::TablePlan(int numColumns, std::size_t length, const TableRoutes& routes)
+    : numColumns(numColumns), index(compileRoutes(routes, numColumns, length)) {
+}
+
+/**
+ * @brief Перестановка символов фиксированной длины по плану
+ * @param in Исходные символы
+ * @param out Буфер результата, не пересекающийся с in
+ * @param cellSize Длина символа в байтах (1 .. 4)
+ * @param encrypting true - шифрование, false - расшифрование
+ * @param begin Первая обрабатываемая позиция шифротекста
+ * @param end Позиция шифротекста за последней обрабатываемой
+ */
+void TablePlan::apply(const void* in, void* out, std::size_t cellSize, bool encrypting,
+                      std::size_t begin, std::size_t end) const {
+    const unsigned char* from = static_cast<const unsigned char*>(in);
+    unsigned char* to = static_cast<unsigned char*>(out);
+    end = std::min(end, index.size());
+    switch (cellSize) {
+        case 1:
+            permute<1>(from, to, index.data(), begin, end, encrypting);
+            break;
+        case 2:
+            permute<2>(from, to, index.data(), begin, end, encrypting);
+            break;
+        case 3:
+            permute<3>(from, to, index.data(), begin, end, encrypting);
+            break;
+        default:
+            permute<4>(from, to, index.data(), begin, end, encrypting);
+            break;
+    }
+}
+
+/**
+ * @brief Конструктор кэша
+ * @param capacity Наибольшее количество планов
+ * @param maxLength Наибольшая длина текста, для которой строится план
+ * @param routes Маршруты записи и чтения
+ */
+TablePlanCache::TablePlanCache(std::size_t capacity, std::size_t maxLength, TableRoutes routes)
+    : capacity(capacity), maxLength(std::min(maxLength, maxRouteLength)), tableRoutes(std::move(routes)) {
+}
+
+/**
+ * @brief Поиск или построение плана
+ * @param numColumns Количество столбцов таблицы
+ * @param length Длина текста в символах
+ * @return План или пустой указатель, если текст длиннее maxLength или кэш отключен
+ * @details План строится вне блокировки, поэтому долгое построение
+ * не задерживает потоки, обращающиеся к другим планам
+ */
+std::shared_ptr<const TablePlan> TablePlanCache::find(int numColumns, std::size_t length) {
+    if (capacity == 0 || length > maxLength) {
+        return nullptr;
+    }
+    const std::uint64_t key = (static_cast<std::uint64_t>(numColumns) << 32) | length;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        auto found = lookup.find(key);
+        if (found != lookup.end()) {
+            hits++;
+            entries.splice(entries.begin(), entries, found->second);
+            return found->second->plan;
+        }
+        misses++;
+    }
+
+    auto plan = std::make_shared<const TablePlan>(numColumns, length, tableRoutes);
+    std::lock_guard<std::mutex> lock(mutex);
+    if (lookup.count(key) == 0) {
+        entries.push_front(Entry{key, plan});
+        lookup[key] = entries.begin();
+        if (entries.size() > capacity) {
+            lookup.erase(entries.back().key);
+            entries.pop_back();
+        }
+    }
+    return plan;
+}
+
+/**
+ * @brief Статистика кэша
+ * @return Количество попаданий, промахов и планов
+ */
+TablePlanStats TablePlanCache::stats() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    TablePlanStats result;
+    result.hits = hits;
+    result.misses = misses;
+    result.plans = entries.size();
+    result.capacity = capacity;
+    return result;
+}
@@ -0,0 +1,168 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+#include "routeEngine.h"
+
+/**
+ * @file
+ * @author Ганьшин В.А.
+ * @version 1.0
+ * @date 17.12.2025
+ * @brief Заранее вычисленные планы табличной перестановки и их кэш
+ * @details Перестановка зависит только от количества столбцов и длины текста.
+ * Для потоков сообщений одинаковой длины (записи фиксированного размера)
+ * геометрия таблицы вычисляется один раз, а каждое сообщение переставляется
+ * одним циклом по массиву номеров. Тот же цикл применяется к любой паре
+ * маршрутов записи и чтения (см. compileRoutes()).
+ */
+
+/**
+ * @brief План перестановки для заданных количества столбцов и длины текста
+ * @details Хранит номер символа текста для каждой позиции шифротекста:
+ * при шифровании out[i] = in[index[i]], при расшифровании out[index[i]] = in[i]
+ */
+class TablePlan {
+private:
+    int numColumns; ///< Количество столбцов таблицы
+    std::vector<std::uint32_t> index; ///< Номер символа текста для каждой позиции шифротекста
+
+public:
+    /**
+     * @brief Построение плана
+     * @param numColumns Количество столбцов таблицы (1 .. length)
+     * @param length Длина текста в символах (не больше maxRouteLength)
+     */
+    TablePlan(int numColumns, std::size_t length);
+
+    /**
+     * @brief Построение плана для пары маршрутов
+     * @param numColumns Количество столбцов таблицы (1 .. length)
+     * @param length Длина текста в символах (не больше maxRouteLength)
+     * @param routes Маршруты записи и чтения (проверенные checkRoutes())
+     */
+    TablePlan(int numColumns, std::size_t length, const TableRoutes& routes);
+
+    /**
+     * @brief Количество столбцов таблицы
+     * @return Количество столбцов
+     */
+    int columns() const {
+        return numColumns;
+    }
+
+    /**
+     * @brief Длина текста, для которой построен план
+     * @return Длина текста в символах
+     */
+    std::size_t length() const {
+        return index.size();
+    }
+
+    /**
+     * @brief Номера символов текста по порядку шифротекста
+     * @return Указатель на length() номеров
+     */
+    const std::uint32_t* indices() const {
+        return index.data();
+    }
+
+    /**
+     * @brief Перестановка символов фиксированной длины по плану
+     * @param in Исходные символы (length() штук)
+     * @param out Буфер результата на length() символов, не пересекающийся с in
+     * @param cellSize Длина символа в байтах (1 .. 4)
+     * @param encrypting true - шифрование, false - расшифрование
+     * @param begin Первая обрабатываемая позиция шифротекста
+     * @param end Позиция шифротекста за последней обрабатываемой (не больше length())
+     * @details Разные диапазоны позиций пишут в разные ячейки результата, поэтому
+     * их можно переставлять в разных потоках в общий буфер
+     */
+    void apply(const void* in, void* out, std::size_t cellSize, bool encrypting,
+               std::size_t begin = 0, std::size_t end = SIZE_MAX) const;
+};
+
+/**
+ * @brief Статистика кэша планов
+ */
+struct TablePlanStats {
+    std::size_t hits = 0; ///< Количество обращений, обслуженных готовым планом
+    std::size_t misses = 0; ///< Количество построенных планов
+    std::size_t plans = 0; ///< Количество планов в кэше
+    std::size_t capacity = 0; ///< Наибольшее количество планов в кэше
+};
+
+/**
+ * @brief Ограниченный кэш планов с вытеснением давно не использованных (LRU)
+ * @details Потокобезопасен. Планы выдаются через std::shared_ptr, поэтому
+ * вытеснение плана из кэша не мешает потоку, который его еще применяет
+ */
+class TablePlanCache {
+private:
+    /**
+     * @brief Элемент списка планов
+     */
+    struct Entry {
+        std::uint64_t key; ///< Ключ поиска (количество столбцов и длина текста)
+        std::shared_ptr<const TablePlan> plan; ///< План
+    };
+
+    std::size_t capacity; ///< Наибольшее количество планов
+    std::size_t maxLength; ///< Наибольшая длина текста, для которой строится план
+    TableRoutes tableRoutes; ///< Маршруты записи и чтения, для которых строятся планы
+    std::list<Entry> entries; ///< Планы от недавно использованных к давно использованным
+    std::unordered_map<std::uint64_t, std::list<Entry>::iterator> lookup; ///< Поиск плана по ключу
+    std::size_t hits = 0; ///< Количество попаданий
+    std::size_t misses = 0; ///< Количество промахов
+    mutable std::mutex mutex; ///< Защита кэша
+
+public:
+    /// Количество планов в кэше по умолчанию
+    static constexpr std::size_t defaultCapacity = 32;
+
+    /// Наибольшая длина текста для плана по умолчанию (символов); длинные тексты выгоднее переставлять блочным ядром
+    static constexpr std::size_t defaultMaxLength = 1 << 16;
+
+    /**
+     * @brief Конструктор кэша
+     * @param capacity Наибольшее количество планов
+     * @param maxLength Наибольшая длина текста, для которой строится план (не больше maxRouteLength)
+     * @param routes Маршруты записи и чтения (проверенные checkRoutes())
+     */
+    explicit TablePlanCache(std::size_t capacity = defaultCapacity, std::size_t maxLength = defaultMaxLength,
+                            TableRoutes routes = {});
+
+    /**
+     * @brief Поиск или построение плана
+     * @param numColumns Количество столбцов таблицы
+     * @param length Длина текста в символах (не меньше numColumns)
+     * @return План или пустой указатель, если текст длиннее maxLength или кэш отключен
+     */
+    std::shared_ptr<const TablePlan> find(int numColumns, std::size_t length);
+
+    /**
+     * @brief Маршруты, для которых строятся планы
+     * @return Маршруты записи и чтения
+     */
+    const TableRoutes& routes() const {
+        return tableRoutes;
+    }
+
+    /**
+     * @brief Наибольшая длина текста, для которой строится план
+     * @return Длина текста в символах
+     */
+    std::size_t lengthLimit() const {
+        return maxLength;
+    }
+
+    /**
+     * @brief Статистика кэша
+     * @return Количество попаданий, промахов и планов
+     */
+    TablePlanStats stats() const;
+};